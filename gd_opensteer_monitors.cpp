@@ -0,0 +1,113 @@
+#include "gd_opensteer_monitors.h"
+
+#include "core/os/os.h"
+
+#include "OpenSteer/App.h"
+#include "OpenSteer/Profiler.h"
+#include "OpenSteer/WorkerPool.h"
+
+static const char *monitor_names[OpenSteerMonitors::MONITOR_MAX] = {
+	"OpenSteer/agents",
+	"OpenSteer/neighbor_queries",
+	"OpenSteer/neighbors_per_query",
+	"OpenSteer/proximity_update_ms",
+	"OpenSteer/neighbor_query_ms",
+	"OpenSteer/update_phase_ms",
+	"OpenSteer/draw_phase_ms",
+	"OpenSteer/annotation_commands",
+	"OpenSteer/worker_utilization_percent",
+};
+
+String OpenSteerMonitors::get_monitor_name(Monitor p_monitor) const {
+	ERR_FAIL_INDEX_V(p_monitor, MONITOR_MAX, String());
+	return monitor_names[p_monitor];
+}
+
+Dictionary OpenSteerMonitors::get_monitors() {
+	Dictionary monitors;
+	for (int i = 0; i < MONITOR_MAX; i++) {
+		monitors[monitor_names[i]] = get_monitor((Monitor)i);
+	}
+	return monitors;
+}
+
+void OpenSteerMonitors::set_profiling(bool p_enabled) {
+	OpenSteer::Profiler::setEnabled(p_enabled);
+}
+
+bool OpenSteerMonitors::is_profiling() const {
+	return OpenSteer::Profiler::isEnabled();
+}
+
+// share of the worker threads' time spent running jobs since the last call
+// (meant to be polled about once a second, e.g. with get_monitors)
+float OpenSteerMonitors::_worker_utilization() {
+	OpenSteer::WorkerPool *pool = OpenSteer::WorkerPool::sharedIfStarted();
+	const int workers = pool ? pool->getThreadCount() - 1 : 0;
+	if (workers == 0) {
+		return 0;
+	}
+	const uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+	const double busy_seconds = pool->getWorkerBusySeconds();
+	if (last_ticks != 0 && ticks > last_ticks) {
+		const double wall_seconds = (ticks - last_ticks) * 1e-6;
+		utilization = 100.0 * (busy_seconds - last_busy_seconds) / (wall_seconds * workers);
+	}
+	last_ticks = ticks;
+	last_busy_seconds = busy_seconds;
+	return utilization;
+}
+
+Variant OpenSteerMonitors::get_monitor(Monitor p_monitor) {
+	using OpenSteer::Profiler;
+
+	const Profiler::ZoneTotals *queries = Profiler::findFrameTotals("neighbor query");
+	OpenSteer::App *app = OpenSteer::App::get_singleton();
+
+	switch (p_monitor) {
+		case MONITOR_AGENTS:
+			return app ? (int)app->allVehiclesOfSelectedPlugIn().size() : 0;
+		case MONITOR_NEIGHBOR_QUERIES:
+			return queries ? queries->calls : 0;
+		case MONITOR_NEIGHBORS_PER_QUERY:
+			return queries ? (double)Profiler::getFrameCount("neighbors found") / queries->calls : 0.0;
+		case MONITOR_PROXIMITY_UPDATE_TIME: {
+			const Profiler::ZoneTotals *updates = Profiler::findFrameTotals("proximity update");
+			return updates ? updates->seconds * 1000 : 0.0;
+		}
+		case MONITOR_NEIGHBOR_QUERY_TIME:
+			return queries ? queries->seconds * 1000 : 0.0;
+		case MONITOR_UPDATE_PHASE_TIME:
+			return app ? app->phaseTimerUpdate() * 1000 : 0.0;
+		case MONITOR_DRAW_PHASE_TIME:
+			return app ? app->phaseTimerDraw() * 1000 : 0.0;
+		case MONITOR_ANNOTATION_COMMANDS:
+			return (int64_t)Profiler::getFrameCount("annotation commands");
+		case MONITOR_WORKER_UTILIZATION:
+			return _worker_utilization();
+		case MONITOR_MAX:
+			break;
+	}
+	return 0;
+}
+
+void OpenSteerMonitors::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &OpenSteerMonitors::get_monitor);
+	ClassDB::bind_method(D_METHOD("get_monitor_name", "monitor"), &OpenSteerMonitors::get_monitor_name);
+	ClassDB::bind_method(D_METHOD("get_monitors"), &OpenSteerMonitors::get_monitors);
+	ClassDB::bind_method(D_METHOD("set_profiling", "enabled"), &OpenSteerMonitors::set_profiling);
+	ClassDB::bind_method(D_METHOD("is_profiling"), &OpenSteerMonitors::is_profiling);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "profiling"), "set_profiling", "is_profiling");
+
+	BIND_ENUM_CONSTANT(MONITOR_AGENTS);
+	BIND_ENUM_CONSTANT(MONITOR_NEIGHBOR_QUERIES);
+	BIND_ENUM_CONSTANT(MONITOR_NEIGHBORS_PER_QUERY);
+	BIND_ENUM_CONSTANT(MONITOR_PROXIMITY_UPDATE_TIME);
+	BIND_ENUM_CONSTANT(MONITOR_NEIGHBOR_QUERY_TIME);
+	BIND_ENUM_CONSTANT(MONITOR_UPDATE_PHASE_TIME);
+	BIND_ENUM_CONSTANT(MONITOR_DRAW_PHASE_TIME);
+	BIND_ENUM_CONSTANT(MONITOR_ANNOTATION_COMMANDS);
+	BIND_ENUM_CONSTANT(MONITOR_WORKER_UTILIZATION);
+	BIND_ENUM_CONSTANT(MONITOR_MAX);
+}
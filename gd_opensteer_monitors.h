@@ -0,0 +1,51 @@
+#ifndef GD_OPENSTEER_MONITORS_H
+#define GD_OPENSTEER_MONITORS_H
+
+#include "core/object.h"
+
+// Steering statistics for scripts and debugging tools, as the engine
+// singleton "OpenSteerMonitors" (Godot 3's Performance has no custom
+// monitors).  Values are those of the last OpenSteer frame: from the
+// profiler's frame totals and counts (zero until profiling is turned on
+// with set_profiling), the App phase timers and the shared WorkerPool.
+class OpenSteerMonitors : public Object {
+	GDCLASS(OpenSteerMonitors, Object);
+
+public:
+	enum Monitor {
+		MONITOR_AGENTS,
+		MONITOR_NEIGHBOR_QUERIES,
+		MONITOR_NEIGHBORS_PER_QUERY,
+		MONITOR_PROXIMITY_UPDATE_TIME,
+		MONITOR_NEIGHBOR_QUERY_TIME,
+		MONITOR_UPDATE_PHASE_TIME,
+		MONITOR_DRAW_PHASE_TIME,
+		MONITOR_ANNOTATION_COMMANDS,
+		MONITOR_WORKER_UTILIZATION,
+		MONITOR_MAX
+	};
+
+	Variant get_monitor(Monitor p_monitor);
+	String get_monitor_name(Monitor p_monitor) const;
+
+	// every monitor, by name ("OpenSteer/agents" and so on)
+	Dictionary get_monitors();
+
+	// the profiler feeds the query, proximity and annotation monitors
+	void set_profiling(bool p_enabled);
+	bool is_profiling() const;
+
+protected:
+	static void _bind_methods();
+
+private:
+	float _worker_utilization();
+
+	uint64_t last_ticks = 0;
+	double last_busy_seconds = 0;
+	float utilization = 0;
+};
+
+VARIANT_ENUM_CAST(OpenSteerMonitors::Monitor);
+
+#endif // GD_OPENSTEER_MONITORS_H
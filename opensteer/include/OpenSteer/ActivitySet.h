@@ -0,0 +1,222 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// ActivitySet: puts idle agents to sleep.  An agent whose speed and
+// steering have both stayed under thresholds for a while (it reached its
+// goal, or is parked) falls asleep: it leaves the list of agents updated
+// each frame, but keeps its proximity token, so others still see and avoid
+// it.  It wakes when a moving agent comes within wakeRadius of it, or when
+// the application wakes it (an explicit event).  Large idle populations
+// then cost next to nothing.
+//
+// Vehicle is the agent class.  It must have a public ActivityState member
+// named "activity", and be what the proximity database holds (as
+// AbstractVehicle*) for wakeNeighbors.  In a PlugIn::update loop:
+//
+//     const ActivitySet<Foo>::groupType& awake = activity.getAwake ();
+//     for (iterator i = awake.begin(); i != awake.end(); i++)
+//     {
+//         (**i).update (currentTime, elapsedTime);
+//         activity.noteUpdate (**i, steeringMagnitude, elapsedTime);
+//         activity.wakeNeighbors (**i, *(**i).proximityToken, neighbors);
+//     }
+//     activity.endFrame ();
+//
+// Agents fall asleep and wake up at endFrame.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_ACTIVITYSET_H
+#define OPENSTEER_ACTIVITYSET_H
+
+
+#include <algorithm>
+#include <vector>
+#include "AbstractVehicle.h"
+#include "Proximity.h"
+
+
+namespace OpenSteer {
+
+
+    // an agent's activity, kept with the agent
+
+    class ActivityState
+    {
+    public:
+        ActivityState (void) : asleep (false), quietTime (0) {}
+
+        bool asleep;
+
+        // how long speed and steering have been under the thresholds
+        float quietTime;
+    };
+
+
+    template <class Vehicle>
+    class ActivitySet
+    {
+    public:
+
+        typedef std::vector<Vehicle*> groupType;
+
+        // constructor: default thresholds
+        ActivitySet (void)
+            : sleepSpeed (0.05f),
+              sleepSteering (0.1f),
+              sleepDelay (1),
+              wakeRadius (2),
+              wokenCount (0)
+        {}
+
+        // an agent falls asleep once its speed is under sleepSpeed and its
+        // steering force under sleepSteering for sleepDelay seconds
+        float sleepSpeed;
+        float sleepSteering;
+        float sleepDelay;
+
+        // sleeping agents this close to a moving agent wake up
+        float wakeRadius;
+
+        // add an agent (awake), or remove it
+        void add (Vehicle* v)
+        {
+            v->activity = ActivityState ();
+            awake.push_back (v);
+        }
+        void remove (Vehicle* v)
+        {
+            // (one which fell asleep this frame is still on the awake list)
+            removeFrom (awake, v);
+            removeFrom (sleeping, v);
+        }
+
+        // agents to update this frame, and those asleep
+        const groupType& getAwake (void) const {return awake;}
+        const groupType& getSleeping (void) const {return sleeping;}
+
+        // after an awake agent's update: note its speed and steering
+        void noteUpdate (Vehicle& v,
+                         const float steeringMagnitude,
+                         const float elapsedTime)
+        {
+            ActivityState& a = v.activity;
+            if ((v.speed () < sleepSpeed) &&
+                (steeringMagnitude < sleepSteering))
+            {
+                a.quietTime += elapsedTime;
+                if (a.quietTime >= sleepDelay) a.asleep = true;
+            }
+            else
+            {
+                a.quietTime = 0;
+            }
+        }
+
+        // wake an agent (from sleep, or from falling asleep this frame)
+        void wake (Vehicle& v)
+        {
+            ActivityState& a = v.activity;
+            if (! a.asleep) return;
+            a.asleep = false;
+            a.quietTime = 0;
+            wokenCount++;
+        }
+
+        // wake everyone, for example when the simulation changes
+        void wakeAll (void)
+        {
+            for (size_t i = 0; i < sleeping.size (); i++) wake (*sleeping[i]);
+            for (size_t i = 0; i < awake.size (); i++) wake (*awake[i]);
+        }
+
+        // wake the sleeping agents near a moving agent (uses the agent's
+        // proximity token, "neighbors" is scratch space)
+        void wakeNeighbors (Vehicle& v,
+                            AbstractTokenForProximityDatabase<AbstractVehicle*>&
+                            proximityToken,
+                            AVGroup& neighbors)
+        {
+            if (v.speed () < sleepSpeed) return;
+            neighbors.clear ();
+            proximityToken.findNeighbors (v.position (), wakeRadius, neighbors);
+            for (AVIterator i = neighbors.begin(); i != neighbors.end(); i++)
+            {
+                Vehicle& other = *static_cast<Vehicle*> (*i);
+                if (other.activity.asleep) wake (other);
+            }
+        }
+
+        // end of frame: agents which fell asleep leave the awake list,
+        // those woken join it
+        void endFrame (void)
+        {
+            // (only look through the sleeping agents when any were woken)
+            if (wokenCount > 0)
+            {
+                moveAgents (sleeping, awake, false);
+                wokenCount = 0;
+            }
+            moveAgents (awake, sleeping, true);
+        }
+
+    private:
+
+        // move the agents of "from" whose asleep flag is "asleep" to "to"
+        void moveAgents (groupType& from, groupType& to, const bool asleep)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < from.size (); i++)
+            {
+                if (from[i]->activity.asleep == asleep)
+                    to.push_back (from[i]);
+                else
+                    from[kept++] = from[i];
+            }
+            from.resize (kept);
+        }
+
+        void removeFrom (groupType& g, Vehicle* v)
+        {
+            typename groupType::iterator i = std::find (g.begin(), g.end(), v);
+            if (i != g.end()) g.erase (i);
+        }
+
+        groupType awake;
+        groupType sleeping;
+        int wokenCount;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_ACTIVITYSET_H
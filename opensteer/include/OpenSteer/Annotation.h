@@ -47,6 +47,7 @@
 
 
 #include "App.h"
+#include "Profiler.h"
 
 
 // ----------------------------------------------------------------------------
@@ -88,6 +89,10 @@ namespace OpenSteer {
         // constructor
         AnnotationMixin ();
 
+        // copying gives the copy a trail of its own
+        AnnotationMixin (const AnnotationMixin& other);
+        AnnotationMixin& operator= (const AnnotationMixin& other);
+
         // destructor
         virtual ~AnnotationMixin ();
 
@@ -229,6 +234,8 @@ namespace OpenSteer {
         Vec3 curPosition;           // last reported position of vehicle
         Vec3* trailVertices;        // array (ring) of recent points along trail
         char* trailFlags;           // array (ring) of flag bits for trail points
+
+        void copyTrail (const AnnotationMixin& other);
     };
 
 } // namespace OpenSteer
@@ -254,6 +261,29 @@ OpenSteer::AnnotationMixin<Super>::AnnotationMixin (void)
 }
 
 
+template<class Super>
+OpenSteer::AnnotationMixin<Super>::AnnotationMixin (const AnnotationMixin& other)
+    : Super (other)
+{
+    trailVertices = NULL;
+    trailFlags = NULL;
+    copyTrail (other);
+}
+
+
+template<class Super>
+OpenSteer::AnnotationMixin<Super>&
+OpenSteer::AnnotationMixin<Super>::operator= (const AnnotationMixin& other)
+{
+    if (this != &other)
+    {
+        Super::operator= (other);
+        copyTrail (other);
+    }
+    return *this;
+}
+
+
 template<class Super>
 OpenSteer::AnnotationMixin<Super>::~AnnotationMixin (void)
 {
@@ -262,6 +292,37 @@ OpenSteer::AnnotationMixin<Super>::~AnnotationMixin (void)
 }
 
 
+// ----------------------------------------------------------------------------
+// copy another trail, reusing this one's buffers when they are the same size
+
+
+template<class Super>
+void 
+OpenSteer::AnnotationMixin<Super>::copyTrail (const AnnotationMixin& other)
+{
+    if ((trailVertices == NULL) || (trailVertexCount != other.trailVertexCount))
+    {
+        delete[] trailVertices;
+        delete[] trailFlags;
+        trailVertices = new Vec3[other.trailVertexCount];
+        trailFlags = new char[other.trailVertexCount];
+    }
+
+    trailVertexCount = other.trailVertexCount;
+    trailIndex = other.trailIndex;
+    trailDuration = other.trailDuration;
+    trailSampleInterval = other.trailSampleInterval;
+    trailLastSampleTime = other.trailLastSampleTime;
+    trailDottedPhase = other.trailDottedPhase;
+    curPosition = other.curPosition;
+    for (int i = 0; i < trailVertexCount; i++)
+    {
+        trailVertices[i] = other.trailVertices[i];
+        trailFlags[i] = other.trailFlags[i];
+    }
+}
+
+
 // ----------------------------------------------------------------------------
 // set trail parameters: the amount of time it represents and the number of
 // samples along its length.  re-allocates internal buffers.
@@ -397,6 +458,7 @@ OpenSteer::AnnotationMixin<Super>::annotationLine (const Vec3& startPoint,
     if (OpenSteer::App::get_singleton()->annotationIsOn())
     {
         Draw::drawLine (startPoint, endPoint, color);
+        OPENSTEER_PROFILE_COUNT ("annotation commands", 1);
     }
 }
 
@@ -422,6 +484,7 @@ OpenSteer::AnnotationMixin<Super>::annotationCircleOrDisk (const float radius,
     if (OpenSteer::App::get_singleton()->annotationIsOn())
     {
         Draw::drawCircle (radius, axis, center, color, segments, filled, in3d);
+        OPENSTEER_PROFILE_COUNT ("annotation commands", 1);
     }
 }
 
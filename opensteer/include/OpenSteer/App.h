@@ -256,7 +256,7 @@ namespace OpenSteer {
         int phaseStack[phaseStackSize];
         int phaseStackIndex;
         float phaseTimers[drawPhase+1];
-        float phaseTimerBase;
+        double phaseTimerBase;
         void pushPhase (const int newPhase);
         void popPhase (void);
         void initPhaseTimers (void);
@@ -38,9 +38,20 @@
 // hertz video game console).  Also handles the notion of "pausing" simulation
 // time.
 //
+// Real time is read from a monotonic clock (unaffected by changes to the
+// time of day) in nanoseconds.  Running totals are kept in double precision
+// so they stay exact to well under a millisecond over weeks of running;
+// intervals between frames are handed out as float.
+//
+// Optionally ("fixed step mode") simulation time is handed out in whole steps
+// of a fixed size, however long frames take, so simulation results do not
+// depend on frame timing.  See getStepsThisFrame and getInterpolationAlpha.
+//
 // Usage: allocate a clock, set its "paused" or "targetFPS" parameters, then
 // call updateGlobalSimulationClock before each simulation step.
 //
+// 10-18-26:     fixed step mode, sleep (rather than spin) between frames,
+//               monotonic nanosecond time base and double precision totals
 // 10-04-04 bk:  put everything into the OpenSteer namespace
 // 11-11-03 cwr: another overhaul: support aniamtion mode, switch to
 //               functional API, move smoothed stats inside this class
@@ -56,6 +67,8 @@
 
 #include "OpenSteer/Utilities.h"
 
+#include <stdint.h>
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -73,18 +86,34 @@ namespace OpenSteer {
         // update this clock, called exactly once per simulation step ("frame")
         void update (void);
 
-        // returns the number of seconds of real time (represented as a float)
-        // since the clock was first updated.
-        float realTimeSinceFirstClockUpdate (void);
+        // returns the number of seconds of real time since the clock was
+        // first updated (and the same in whole nanoseconds)
+        double realTimeSinceFirstClockUpdate (void);
+        int64_t realTimeNanosecondsSinceFirstClockUpdate (void);
 
         // force simulation time ahead, ignoring passage of real time.
         // Used for OpenSteerDemo's "single step forward" and animation mode
         float advanceSimulationTimeOneFrame (void);
         void advanceSimulationTime (const float seconds);
 
-        // "wait" until next frame time
+        // "wait" until next frame time: sleep until spinTime before it, then
+        // spin the rest of the way (sleeps can wake up a little late)
         void frameRateSync (void);
 
+        // how long before a frame time to stop sleeping and start spinning
+        float getSpinTime (void) {return spinTime;}
+        float setSpinTime (float st) {return spinTime = st;}
+
+        // wake-up jitter: how late frameRateSync returned after the frame
+        // time it waited for (latest, running average, and largest)
+        float getWakeJitter (void) {return wakeJitter;}
+        float getSmoothedWakeJitter (void) {return smoothedWakeJitter;}
+        float getMaxWakeJitter (void) {return maxWakeJitter;}
+        void resetWakeJitter (void)
+        {
+            wakeJitter = smoothedWakeJitter = maxWakeJitter = 0;
+        }
+
 
         // main clock modes: variable or fixed frame rate, real-time or animation
         // mode, running or paused.
@@ -117,6 +146,52 @@ namespace OpenSteer {
         bool setPausedState (bool newPS) {return paused = newPS;};
 
 
+        // fixed step mode: the simulation time which passes each frame (by
+        // any of the modes above) goes into an accumulator, from which each
+        // update takes as many whole steps of 1/fixedStepRate seconds as it
+        // holds.  At most maxStepsPerFrame are taken, the rest are dropped
+        // (so a slow frame does not ask for yet more work next frame).  The
+        // part of a step left over is the interpolation alpha: how far
+        // between the last two simulation states a frame should be drawn.
+    private:
+        bool fixedStepMode;
+        int fixedStepRate;
+        int maxStepsPerFrame;
+        double stepAccumulator;
+        double fixedStepTime;  // simulation time at the end of the last step
+        int stepsThisFrame;
+        int droppedSteps;      // total steps dropped by maxStepsPerFrame
+        void takeFixedSteps (void);
+    public:
+        bool getFixedStepMode (void) {return fixedStepMode;}
+        bool setFixedStepMode (bool fsm);
+
+        int getFixedStepRate (void) {return fixedStepRate;}
+        int setFixedStepRate (int fsr) {return fixedStepRate = fsr;}
+        float getFixedStepSize (void) {return 1.0f / fixedStepRate;}
+
+        int getMaxStepsPerFrame (void) {return maxStepsPerFrame;}
+        int setMaxStepsPerFrame (int m) {return maxStepsPerFrame = m;}
+
+        // steps due this frame, and the simulation time at the end of each
+        // (step is 0 through getStepsThisFrame()-1)
+        int getStepsThisFrame (void) {return stepsThisFrame;}
+        double getStepTime (int step)
+        {
+            return (fixedStepTime -
+                    ((stepsThisFrame - 1 - step) / (double) fixedStepRate));
+        }
+
+        // fraction of a step from the last simulation state toward the next
+        float getInterpolationAlpha (void)
+        {
+            if (! fixedStepMode) return 1;
+            return (float) (stepAccumulator * fixedStepRate);
+        }
+
+        int getDroppedSteps (void) {return droppedSteps;}
+
+
         // clock keeps track of "smoothed" running average of recent frame rates.
         // When a fixed frame rate is used, a running average of "CPU load" is
         // kept (aka "non-wait time", the percentage of each frame time (time
@@ -141,7 +216,8 @@ namespace OpenSteer {
         }
         float getUsage (void)
         {
-            // run time per frame over target frame time (as a percentage)
+            // run time per frame over target frame time (as a percentage),
+            // not counting time spent sleeping or spinning in frameRateSync
             return ((100 * elapsedNonWaitRealTime) / (1.0f / fixedFrameRate));
         }
 
@@ -149,16 +225,16 @@ namespace OpenSteer {
         // clock state member variables and public accessors for them
     private:
         // real "wall clock" time since launch
-        float totalRealTime;
+        double totalRealTime;
 
         // total time simulation has run
-        float totalSimulationTime;
+        double totalSimulationTime;
 
         // total time spent paused
-        float totalPausedTime;
+        double totalPausedTime;
 
         // sum of (non-realtime driven) advances to simulation time
-        float totalAdvanceTime;
+        double totalAdvanceTime;
 
         // interval since last simulation time
         // (xxx does this need to be stored in the instance? xxx)
@@ -172,10 +248,10 @@ namespace OpenSteer {
         // exclusive of time spent waiting for frame boundary when targetFPS>0
         float elapsedNonWaitRealTime;
     public:
-        float getTotalRealTime (void) {return totalRealTime;}
-        float getTotalSimulationTime (void) {return totalSimulationTime;}
-        float getTotalPausedTime (void) {return totalPausedTime;}
-        float getTotalAdvanceTime (void) {return totalAdvanceTime;}
+        double getTotalRealTime (void) {return totalRealTime;}
+        double getTotalSimulationTime (void) {return totalSimulationTime;}
+        double getTotalPausedTime (void) {return totalPausedTime;}
+        double getTotalAdvanceTime (void) {return totalAdvanceTime;}
         float getElapsedSimulationTime (void) {return elapsedSimulationTime;}
         float getElapsedRealTime (void) {return elapsedRealTime;}
         float getElapsedNonWaitRealTime (void) {return elapsedNonWaitRealTime;}
@@ -183,17 +259,19 @@ namespace OpenSteer {
 
     private:
         // "manually" advance clock by this amount on next update
-        float newAdvanceTime;
-
-        // "Calendar time" when this clock was first updated
-    #ifdef _WIN32
-        // from QueryPerformanceCounter on Windows
-        LONGLONG basePerformanceCounter;
-    #else
-        // from gettimeofday on Linux and Mac OS X
-        int baseRealTimeSec;
-        int baseRealTimeUsec;
-    #endif
+        double newAdvanceTime;
+
+        // frame rate sync: spin time and wake-up statistics
+        float spinTime;
+        float wakeJitter;
+        float smoothedWakeJitter;
+        float maxWakeJitter;
+
+        // monotonic time (in nanoseconds) when this clock was first updated
+        // (from QueryPerformanceCounter on Windows, clock_gettime with
+        // CLOCK_MONOTONIC on Linux and Mac OS X)
+        bool baseRealTimeSet;
+        int64_t baseRealTime;
     };
 
 } // namespace OpenSteer
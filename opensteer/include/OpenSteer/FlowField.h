@@ -0,0 +1,135 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// FlowField: a grid of desired directions of travel toward one goal, for
+// steerForFlowField.  The grid covers a square region of the XZ plane laid
+// out like MapDrive's TerrainMap (center, x and z size, resolution).  Cells
+// are either open or blocked; each open cell stores the path distance to the
+// goal (8-connected Dijkstra, no cutting across blocked corners) and the
+// direction toward its next cell along the shortest route.
+//
+// The field is computed once per goal, after which any number of agents can
+// sample it in constant time.  Changes to blocked cells are queued and
+// applied by update(), which repairs only the part of the field whose
+// routes were affected.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_FLOWFIELD_H
+#define OPENSTEER_FLOWFIELD_H
+
+
+#include <vector>
+#include "Vec3.h"
+
+
+namespace OpenSteer {
+
+
+    class FlowField
+    {
+    public:
+
+        // constructor: all cells open, no goal
+        FlowField (const Vec3& center, float xSize, float zSize, int resolution);
+
+        // destructor
+        ~FlowField ();
+
+        // mark a cell (by integer map index or world position) as blocked or
+        // open.  Takes effect at the next update().
+        void setBlocked (int i, int j, bool blocked);
+        void setBlocked (const Vec3& point, bool blocked);
+        bool isBlocked (int i, int j) const {return blocked[cellIndex (i, j)] != 0;}
+
+        // set the goal and recompute the whole field
+        void setGoal (const Vec3& goal);
+        const Vec3& getGoal (void) const {return goal;}
+
+        // apply pending changes to blocked cells, repairing the field
+        // incrementally.  Returns the number of cells whose distance to the
+        // goal had to be recomputed.
+        int update (void);
+
+        // unit direction toward the goal at a given world position,
+        // blended between the four nearest cell centers (straight at the
+        // goal within its cell).  Returns zero outside the field and where
+        // no nearby cell has a route.
+        Vec3 sampleDirection (const Vec3& point) const;
+
+        // path distance to the goal from a given world position (FLT_MAX
+        // when there is no route)
+        float sampleDistance (const Vec3& point) const;
+
+        // map index of the cell containing a point, false when outside
+        bool cellIndexAt (const Vec3& point, int& i, int& j) const;
+
+        // world position of a cell's center
+        Vec3 cellCenter (int i, int j) const;
+
+        int getResolution (void) const {return resolution;}
+
+        Vec3 center;
+        float xSize;
+        float zSize;
+
+    private:
+
+        int resolution;
+        Vec3 goal;
+        int goalCell;
+
+        std::vector<unsigned char> blocked;
+        std::vector<float> distance;  // path distance to goal, or FLT_MAX
+        std::vector<int> next;        // next cell toward goal, or -1
+        std::vector<Vec3> direction;  // unit direction toward next cell
+
+        // cells whose blocked state changed since the last update
+        std::vector<int> changedCells;
+
+        int cellIndex (int i, int j) const {return i + (j * resolution);}
+
+        // full recompute from the goal cell
+        void recompute (void);
+
+        // Dijkstra relaxation from the given seed cells, returns the number
+        // of cells settled
+        int propagate (std::vector<int>& seeds);
+
+        // set a cell's route to continue through "to"
+        void link (int cell, int to, float d);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_FLOWFIELD_H
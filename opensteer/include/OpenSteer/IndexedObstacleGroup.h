@@ -0,0 +1,139 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// IndexedObstacleGroup: an ObstacleGroup with a spatial index, a bounding
+// volume hierarchy (BVH) over the obstacles' bounding boxes.  Queries
+// return only the obstacles whose boxes overlap a region, such as the
+// corridor swept ahead of a vehicle, instead of every obstacle.
+//
+// It converts to "const ObstacleGroup&" so it can be passed anywhere an
+// ObstacleGroup is accepted (which then sees every obstacle, as before).
+// SteerLibraryMixin::steerToAvoidObstacles has an overload for it which
+// tests only the obstacles near the vehicle's path.
+//
+// The tree is static: obstacles added since it was last built are kept in
+// a short list tested one by one, and the tree is rebuilt once that list
+// grows.  Removing an obstacle rebuilds the tree.  Obstacles are not owned.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_INDEXEDOBSTACLEGROUP_H
+#define OPENSTEER_INDEXEDOBSTACLEGROUP_H
+
+
+#include "Obstacle.h"
+
+
+namespace OpenSteer {
+
+
+    class IndexedObstacleGroup
+    {
+    public:
+
+        // constructors: empty, or indexing a group of obstacles
+        IndexedObstacleGroup (void);
+        IndexedObstacleGroup (const ObstacleGroup& obstacles);
+
+        // replace all obstacles with the given group
+        void assign (const ObstacleGroup& obstacles);
+
+        // add or remove one obstacle, remove all obstacles
+        void add (Obstacle* obstacle);
+        void remove (Obstacle* obstacle);
+        void clear (void);
+
+        // rebuild the tree over all obstacles (also to pick up obstacles
+        // which moved or changed size since they were added)
+        void rebuild (void);
+
+        // all obstacles, in the order they were added
+        const ObstacleGroup& getObstacles (void) const {return all;}
+        operator const ObstacleGroup& (void) const {return all;}
+        size_t size (void) const {return all.size ();}
+
+        // append to "result" the obstacles whose bounds overlap a box
+        void findInBox (const Vec3& boxMin,
+                        const Vec3& boxMax,
+                        ObstacleGroup& result) const;
+
+        // append to "result" the obstacles whose bounds may be within
+        // "radius" of the segment from "start" to "end" (a vehicle's
+        // forward corridor)
+        void findInCorridor (const Vec3& start,
+                             const Vec3& end,
+                             const float radius,
+                             ObstacleGroup& result) const;
+
+        // number of tree nodes (for statistics)
+        int getNodeCount (void) const {return (int) nodes.size ();}
+
+    private:
+
+        // an obstacle with its bounds
+        struct Item
+        {
+            Obstacle* obstacle;
+            Vec3 boxMin;
+            Vec3 boxMax;
+        };
+
+        // tree node: a leaf holds items [first, first+count), an inner
+        // node (count zero) has children at index+1 and "second"
+        struct Node
+        {
+            Vec3 boxMin;
+            Vec3 boxMax;
+            int first;
+            int count;
+            int second;
+        };
+
+        ObstacleGroup all;
+        std::vector<Item> items;       // indexed, in tree order
+        std::vector<Node> nodes;       // nodes[0] is the root
+        std::vector<Item> pending;     // added since the tree was built
+        ObstacleGroup unbounded;       // obstacles without bounds
+
+        void addItem (Obstacle* obstacle);
+        int buildNode (int first, int last);
+
+        // visit the items of every leaf (and the pending items) whose box
+        // passes "test", appending those items which pass it too
+        template <class BoxTest>
+        void find (const BoxTest& test, ObstacleGroup& result) const;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_INDEXEDOBSTACLEGROUP_H
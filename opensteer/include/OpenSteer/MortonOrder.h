@@ -0,0 +1,212 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+//
+// MortonOrder: keep agents which are near each other in space near each
+// other in memory
+//
+// Agents are usually stored in the order they were created, so the
+// neighbors an agent looks at during a proximity query are scattered
+// through memory.  reorderByMortonCode moves agents between their storage
+// slots so that walking the slots in address order follows a Z-order
+// (Morton) curve through space.  Run now and then, it keeps neighbors on
+// nearby cache lines as agents move.
+//
+// Moving an agent's contents to another slot changes its address, so
+// other objects refer to agents through AgentHandles, which follow them.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_MORTONORDER_H
+#define OPENSTEER_MORTONORDER_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "Vec3.h"
+
+
+namespace OpenSteer {
+
+
+    // ----------------------------------------------------------------------------
+    // Morton code of the cell containing a point, in a grid of 1024 cells
+    // along each axis of a box (points outside the box are clamped to it).
+    // The bits of the three cell indices are interleaved: sorting by code
+    // walks the cells in Z-order, which keeps nearby cells close together.
+
+
+    inline uint32_t mortonSpreadBits (uint32_t v)
+    {
+        // put two zero bits between each of the low 10 bits
+        v &= 0x000003ff;
+        v = (v | (v << 16)) & 0xff0000ff;
+        v = (v | (v <<  8)) & 0x0300f00f;
+        v = (v | (v <<  4)) & 0x030c30c3;
+        v = (v | (v <<  2)) & 0x09249249;
+        return v;
+    }
+
+    inline uint32_t mortonCellIndex (float offset, float size)
+    {
+        const float cell = (size > 0) ? (offset * 1024 / size) : 0;
+        return (uint32_t) clip (cell, 0.0f, 1023.0f);
+    }
+
+    inline uint32_t mortonCode (const Vec3& point,
+                                const Vec3& boxMin,
+                                const Vec3& boxSize)
+    {
+        const Vec3 offset = point - boxMin;
+        const uint32_t x = mortonCellIndex (offset.x, boxSize.x);
+        const uint32_t y = mortonCellIndex (offset.y, boxSize.y);
+        const uint32_t z = mortonCellIndex (offset.z, boxSize.z);
+        return (mortonSpreadBits (x) |
+                (mortonSpreadBits (y) << 1) |
+                (mortonSpreadBits (z) << 2));
+    }
+
+
+    // ----------------------------------------------------------------------------
+    // stable handles for agents whose storage is reordered.  Agent has an
+    // int member "handle" which this class maintains.
+
+
+    template <class Agent>
+    class AgentHandles
+    {
+    public:
+
+        // give an agent a handle
+        void add (Agent* agent)
+        {
+            if (freeHandles.empty ())
+            {
+                agent->handle = (int) agents.size ();
+                agents.push_back (agent);
+            }
+            else
+            {
+                agent->handle = freeHandles.back ();
+                freeHandles.pop_back ();
+                agents[agent->handle] = agent;
+            }
+        }
+
+        // retire an agent's handle (which may be given out again)
+        void remove (Agent* agent)
+        {
+            agents[agent->handle] = NULL;
+            freeHandles.push_back (agent->handle);
+            agent->handle = -1;
+        }
+
+        // the agent a handle refers to, NULL for a retired handle
+        Agent* get (const int handle) const
+        {
+            return ((handle >= 0) && (handle < (int) agents.size ())) ?
+                agents[handle] : NULL;
+        }
+
+        // an agent (carrying its handle) now lives at a new address
+        void moved (Agent* agent) {agents[agent->handle] = agent;}
+
+    private:
+
+        std::vector<Agent*> agents;   // indexed by handle
+        std::vector<int> freeHandles;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // reorder the storage of a group of agents by the Morton codes of their
+    // positions.  The slots (addresses) used stay the same, but afterwards
+    // the agents in ascending address order are in Z-order, and "agents"
+    // lists them in that order.
+    //
+    // Agents are moved by copying: Agent must be copy constructible and
+    // assignable, and assignment must leave whatever ties the target slot
+    // has to other objects (a proximity token, for example) with the slot,
+    // updated for the agent now in it.  Handles are updated to match.
+
+
+    template <class Agent>
+    void reorderByMortonCode (std::vector<Agent*>& agents,
+                              const Vec3& boxMin,
+                              const Vec3& boxSize,
+                              AgentHandles<Agent>& handles)
+    {
+        // the slots in address order, and which slot each should get the
+        // contents of (order[k].second is the source of slot k)
+        const size_t count = agents.size ();
+        std::sort (agents.begin(), agents.end());
+        std::vector<std::pair<uint32_t, size_t> > order (count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t code = mortonCode (agents[i]->position (),
+                                              boxMin,
+                                              boxSize);
+            order[i] = std::make_pair (code, i);
+        }
+        std::sort (order.begin(), order.end());
+
+        // apply the permutation a cycle at a time, with one temporary copy
+        // per cycle
+        std::vector<bool> placed (count, false);
+        for (size_t k = 0; k < count; k++)
+        {
+            if (placed[k]) continue;
+            placed[k] = true;
+            if (order[k].second == k) continue;
+
+            const Agent first (*agents[k]);
+            size_t j = k;
+            while (order[j].second != k)
+            {
+                const size_t source = order[j].second;
+                *agents[j] = *agents[source];
+                placed[source] = true;
+                j = source;
+            }
+            *agents[j] = first;
+        }
+
+        for (size_t k = 0; k < count; k++) handles.moved (agents[k]);
+    }
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_MORTONORDER_H
@@ -0,0 +1,167 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+//
+// NeighborList: Verlet neighbor lists, reusing proximity queries across
+// frames.
+//
+// An agent's NeighborList holds the candidates found by one proximity
+// query made with an extra "skin" margin beyond the radius asked for.
+// Until every agent has moved less than half the skin since the list was
+// built, no pair of agents can have closed by more than the skin, so
+// every agent within the radius is still among the candidates: each
+// frame's neighbors are found by checking the cached candidates' distances
+// instead of querying the database.
+//
+// Moves are measured from each agent's position at the start of a
+// generation (its "anchor").  An agent's move since a list was built is at
+// most its distance from its anchor then plus its distance now, so each
+// list keeps the largest such distance at the time it was built (lists are
+// built lazily, after some agents have moved: by other agents earlier in
+// the frame, or because the list's owner skipped frames) and is rebuilt
+// once that plus the largest distance now exceeds half the skin.  When any
+// list would be, NeighborListCache starts a new generation, with new
+// anchors, and each list is rebuilt the next time it is used.
+//
+// In a PlugIn::update loop:
+//
+//     cache.beginFrame ();
+//     for (iterator i = agents.begin(); i != agents.end(); i++)
+//     {
+//         // (in place of token.findNeighbors (position, radius, found))
+//         cache.findNeighbors (list, token, position, radius, found);
+//         ...
+//         cache.noteMoved (list, oldPosition, newPosition);
+//     }
+//
+// Lists hold pointers to agents, so call invalidate when agents are
+// added, removed or moved to other storage.
+//
+// Define OPENSTEER_CHECK_NEIGHBOR_LISTS to assert that each result holds
+// every agent a query of the database finds within the radius.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_NEIGHBORLIST_H
+#define OPENSTEER_NEIGHBORLIST_H
+
+
+#include "AbstractVehicle.h"
+#include "Proximity.h"
+
+
+namespace OpenSteer {
+
+
+    // an agent's cached candidates, kept with the agent
+
+    class NeighborList
+    {
+    public:
+        NeighborList (void)
+            : reach (0), generation (-1), movedWhenBuilt (0),
+              anchorGeneration (-1) {}
+
+        // agents within "reach" (query radius plus skin) when built
+        AVGroup candidates;
+        float reach;
+        int generation;
+
+        // largest distance of any agent from its anchor when built
+        float movedWhenBuilt;
+
+        // position at the start of the current generation
+        Vec3 anchor;
+        int anchorGeneration;
+    };
+
+
+    class NeighborListCache
+    {
+    public:
+
+        typedef AbstractTokenForProximityDatabase<AbstractVehicle*> Token;
+
+        // constructor: margin added to query radii
+        NeighborListCache (const float skin = 2);
+
+        float skin;
+
+        // call once per frame before any queries: starts a new generation
+        // when some list of this one may no longer hold all its neighbors
+        void beginFrame (void);
+
+        // agents within radius of position, from the cached candidates.
+        // The list is rebuilt with token first if it belongs to an older
+        // generation, was built for a smaller radius or agents may have
+        // moved too far since it was built.
+        void findNeighbors (NeighborList& list,
+                            Token& token,
+                            const Vec3& position,
+                            const float radius,
+                            AVGroup& results);
+
+        // after an agent moves (whether or not it has a list of its own,
+        // it may be in others')
+        void noteMoved (NeighborList& list,
+                        const Vec3& oldPosition,
+                        const Vec3& newPosition);
+
+        // start a new generation at the next beginFrame
+        void invalidate (void) {stale = true;}
+
+        // lists rebuilt and neighbor queries answered in the last frame
+        int getRebuildCount (void) const {return rebuilds;}
+        int getQueryCount (void) const {return queries;}
+
+    private:
+
+        int generation;
+        bool stale;
+
+        // largest distance of any agent from its anchor (and its square),
+        // and largest movedWhenBuilt of this generation's lists
+        float maxMoved;
+        float maxMovedSquared;
+        float maxMovedWhenBuilt;
+
+        // square of the largest single move this frame
+        float maxStepSquared;
+
+        int rebuilds;
+        int queries;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_NEIGHBORLIST_H
@@ -0,0 +1,157 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// ObjectPool: storage for many objects of one class, allocated in blocks
+// of slots.  Objects are made in a free slot by spawn and destroyed by
+// despawn, which frees the slot for the next spawn (most recently freed
+// first, while it is still in the cache).  Blocks are kept until the pool
+// itself is destroyed, so a population which comes and goes settles into
+// the same memory instead of fragmenting the heap, and objects spawned
+// together sit together.
+//
+// allocate and release hand out raw slots, for a class's own operator new
+// and delete (see the proximity database tokens).
+//
+// Pools are not thread safe: spawn and despawn from one thread at a time.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_OBJECTPOOL_H
+#define OPENSTEER_OBJECTPOOL_H
+
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace OpenSteer {
+
+
+    template <class T>
+    class ObjectPool
+    {
+    public:
+
+        // constructor: slots are added this many at a time
+        explicit ObjectPool (const int slotsPerBlock = 256)
+            : blockSize (slotsPerBlock > 0 ? slotsPerBlock : 1),
+              freeSlots (NULL),
+              liveCount (0)
+        {}
+
+        // destructor: frees the blocks (objects still alive are not
+        // destroyed, despawn them first)
+        ~ObjectPool ()
+        {
+            for (size_t i = 0; i < blocks.size (); i++) delete [] blocks[i];
+        }
+
+        // make an object in a free slot, passing arguments to its
+        // constructor, and destroy one (which must be exactly a T made by
+        // this pool)
+        template <class... Args>
+        T* spawn (Args&&... args)
+        {
+            return new (allocate ()) T (std::forward<Args> (args)...);
+        }
+        void despawn (T* object)
+        {
+            if (object == NULL) return;
+            object->~T ();
+            release (object);
+        }
+
+        // a raw slot of sizeof (T) bytes, and its return
+        void* allocate (void)
+        {
+            if (freeSlots == NULL) addBlock ();
+            Slot* s = freeSlots;
+            freeSlots = s->next;
+            liveCount++;
+            return &s->storage;
+        }
+        void release (void* slot)
+        {
+            Slot* s = static_cast<Slot*> (slot);
+            s->next = freeSlots;
+            freeSlots = s;
+            liveCount--;
+        }
+
+        // objects alive, and slots in all (alive or free)
+        int getLiveCount (void) const {return liveCount;}
+        int getCapacity (void) const {return (int) blocks.size () * blockSize;}
+
+        // make room for this many objects without further allocation
+        void reserve (const int count)
+        {
+            while (getCapacity () < count) addBlock ();
+        }
+
+    private:
+
+        union Slot
+        {
+            Slot* next;
+            typename std::aligned_storage<sizeof (T), alignof (T)>::type
+                storage;
+        };
+
+        // add a block of slots to the free list, first slot first
+        void addBlock (void)
+        {
+            Slot* block = new Slot [blockSize];
+            blocks.push_back (block);
+            for (int i = blockSize - 1; i >= 0; i--)
+            {
+                block[i].next = freeSlots;
+                freeSlots = &block[i];
+            }
+        }
+
+        int blockSize;
+        std::vector<Slot*> blocks;
+        Slot* freeSlots;
+        int liveCount;
+
+        // not copyable
+        ObjectPool (const ObjectPool&);
+        ObjectPool& operator= (const ObjectPool&);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_OBJECTPOOL_H
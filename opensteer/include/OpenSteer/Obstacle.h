@@ -28,10 +28,18 @@
 // ----------------------------------------------------------------------------
 //
 //
-// Obstacle and SphericalObstacle
+// Obstacle and SphericalObstacle, BoxObstacle, PlaneObstacle,
+// CapsuleObstacle and PolygonObstacle
 //
 // for use with obstacle avoidance
 //
+// Each shape finds where a vehicle's path -- its forward axis, swept by its
+// radius -- first touches it (findIntersectionWithVehiclePath), which is
+// what SteerLibraryMixin::steerToAvoidObstacles works from.  Spheres, boxes
+// and capsules also have a batch version testing one path against many
+// obstacles of that shape at once (see findNearestPathIntersection).
+//
+// 10-18-26:     generic path intersection, box/plane/capsule/polygon shapes
 // 10-04-04 bk:  put everything into the OpenSteer namespace
 // 09-05-02 cwr: created
 //
@@ -50,6 +58,7 @@
 #define OPENSTEER_OBSTACLE_H
 
 
+#include <vector>
 #include "Vec3.h"
 
 // XXX 4-23-03: Temporary work around (see comment above)
@@ -62,20 +71,57 @@ namespace OpenSteer {
     // ----------------------------------------------------------------------------
     // Obstacle: a pure virtual base class for an abstract shape in space, to be
     // used with obstacle avoidance.
-    //
-    // XXX this should define generic methods for querying the obstacle shape
 
 
     class Obstacle
     {
     public:
+        virtual ~Obstacle () {}
+
         enum seenFromState {outside, inside, both};
         virtual seenFromState seenFrom (void) const = 0;
         virtual void setSeenFrom (seenFromState s) = 0;
 
+        // where a vehicle's path first touches the obstacle: the vehicle's
+        // center moving along its forward axis, touching when within its
+        // radius of the obstacle's surface
+        struct PathIntersection
+        {
+            bool intersect;
+            float distance;      // along the forward axis to the contact
+            Vec3 surfacePoint;   // vehicle center at the contact
+            Vec3 surfaceNormal;  // away from the obstacle, at the contact
+            const Obstacle* obstacle;
+
+            PathIntersection (void)
+                : intersect (false), distance (0), obstacle (NULL) {}
+
+            // lateral steering away from the obstacle when the contact is
+            // closer than minDistanceToCollision, else zero
+            Vec3 steerToAvoid (const AbstractVehicle& v,
+                               const float minDistanceToCollision) const;
+        };
+
+        // find the first contact of a vehicle's path with this obstacle
+        // (the path is a ray: contacts behind the vehicle do not count)
+        virtual void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const = 0;
+
+        // shapes with a batch path intersection test
+        enum shapeType {sphereShape, boxShape, capsuleShape, otherShape};
+        virtual shapeType getShapeType (void) const {return otherShape;}
+
         // XXX 4-23-03: Temporary work around (see comment above)
         virtual Vec3 steerToAvoid (const AbstractVehicle& v,
                                    const float minTimeToCollision) const = 0;
+
+        // axis aligned box containing the obstacle, for spatial indexing
+        // (see IndexedObstacleGroup).  Returns false for an unbounded
+        // obstacle, which every spatial query must consider.
+        virtual bool getBounds (Vec3& /*boxMin*/, Vec3& /*boxMax*/) const
+        {
+            return false;
+        }
     };
 
 
@@ -84,6 +130,14 @@ namespace OpenSteer {
     typedef ObstacleGroup::const_iterator ObstacleIterator;
 
 
+    // the nearest intersection of a vehicle's path with a group of
+    // obstacles.  Spheres, boxes and capsules are collected into batches
+    // of the same shape and tested together, other shapes one at a time.
+    void findNearestPathIntersection (const ObstacleGroup& obstacles,
+                                      const AbstractVehicle& v,
+                                      Obstacle::PathIntersection& nearest);
+
+
 
     // ----------------------------------------------------------------------------
     // SphericalObstacle a simple concrete type of obstacle
@@ -102,6 +156,28 @@ namespace OpenSteer {
         seenFromState seenFrom (void) const {return _seenFrom;}
         void setSeenFrom (seenFromState s) {_seenFrom = s;}
 
+        bool getBounds (Vec3& boxMin, Vec3& boxMax) const
+        {
+            const Vec3 r (radius, radius, radius);
+            boxMin = center - r;
+            boxMax = center + r;
+            return true;
+        }
+
+        // where the path meets the sphere grown by the vehicle's radius
+        // (when the vehicle is already inside it: where the path leaves)
+        void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const;
+
+        shapeType getShapeType (void) const {return sphereShape;}
+
+        // batch version: index of the sphere whose intersection is nearest
+        // (-1 if none) and its distance
+        static int findNearestIntersection (const AbstractVehicle& v,
+                                            const SphericalObstacle* const o[],
+                                            const int count,
+                                            float& distance);
+
 
         // XXX 4-23-03: Temporary work around (see comment above)
         //
@@ -157,6 +233,156 @@ namespace OpenSteer {
         seenFromState _seenFrom;
     };
 
+
+    // ----------------------------------------------------------------------------
+    // BoxObstacle: an oriented box, such as a crate or a section of wall.
+    // Its local axes (side, up, forward) must be orthonormal.  The vehicle's
+    // radius grows the box by that much along each axis (a slightly larger
+    // shape than the exact rounded one).
+
+
+    class BoxObstacle : public Obstacle
+    {
+    public:
+        Vec3 center;
+        Vec3 halfSize;   // half the box's extent along side, up, forward
+        Vec3 side;
+        Vec3 up;
+        Vec3 forward;
+
+        // constructors: axis aligned, or with the given orientation
+        BoxObstacle (const Vec3& c, const Vec3& h);
+        BoxObstacle (const Vec3& c, const Vec3& h,
+                     const Vec3& s, const Vec3& u, const Vec3& f);
+
+        seenFromState seenFrom (void) const {return _seenFrom;}
+        void setSeenFrom (seenFromState s) {_seenFrom = s;}
+
+        bool getBounds (Vec3& boxMin, Vec3& boxMax) const;
+
+        void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const;
+
+        Vec3 steerToAvoid (const AbstractVehicle& v,
+                           const float minTimeToCollision) const;
+
+        shapeType getShapeType (void) const {return boxShape;}
+
+        // batch version, as for SphericalObstacle
+        static int findNearestIntersection (const AbstractVehicle& v,
+                                            const BoxObstacle* const o[],
+                                            const int count,
+                                            float& distance);
+
+    private:
+        seenFromState _seenFrom;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // PlaneObstacle: an infinite plane through "point" facing "normal" (unit
+    // length), such as a boundary wall.  Seen from "outside" it is only
+    // visible from the side "normal" points to, from "inside" only from the
+    // other side, by default from both.
+
+
+    class PlaneObstacle : public Obstacle
+    {
+    public:
+        Vec3 point;
+        Vec3 normal;
+
+        // constructor
+        PlaneObstacle (const Vec3& p, const Vec3& n)
+            : point (p), normal (n), _seenFrom (both) {}
+
+        seenFromState seenFrom (void) const {return _seenFrom;}
+        void setSeenFrom (seenFromState s) {_seenFrom = s;}
+
+        void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const;
+
+        Vec3 steerToAvoid (const AbstractVehicle& v,
+                           const float minTimeToCollision) const;
+
+    private:
+        seenFromState _seenFrom;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // CapsuleObstacle: all points within "radius" of the segment from
+    // "start" to "end", such as a pillar, a pipe or a rounded wall.
+
+
+    class CapsuleObstacle : public Obstacle
+    {
+    public:
+        Vec3 start;
+        Vec3 end;
+        float radius;
+
+        // constructor
+        CapsuleObstacle (const Vec3& s, const Vec3& e, float r)
+            : start (s), end (e), radius (r), _seenFrom (outside) {}
+
+        seenFromState seenFrom (void) const {return _seenFrom;}
+        void setSeenFrom (seenFromState s) {_seenFrom = s;}
+
+        bool getBounds (Vec3& boxMin, Vec3& boxMax) const;
+
+        void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const;
+
+        Vec3 steerToAvoid (const AbstractVehicle& v,
+                           const float minTimeToCollision) const;
+
+        shapeType getShapeType (void) const {return capsuleShape;}
+
+        // batch version, as for SphericalObstacle
+        static int findNearestIntersection (const AbstractVehicle& v,
+                                            const CapsuleObstacle* const o[],
+                                            const int count,
+                                            float& distance);
+
+    private:
+        seenFromState _seenFrom;
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // PolygonObstacle: a simple polygon on the XZ plane (corners in order,
+    // Y ignored) extended infinitely along Y, such as the footprint of a
+    // building.  Intersections are found in the XZ plane.
+
+
+    class PolygonObstacle : public Obstacle
+    {
+    public:
+        std::vector<Vec3> corners;
+
+        // constructor
+        PolygonObstacle (const Vec3 c[], const int cornerCount)
+            : corners (c, c + cornerCount), _seenFrom (outside) {}
+
+        seenFromState seenFrom (void) const {return _seenFrom;}
+        void setSeenFrom (seenFromState s) {_seenFrom = s;}
+
+        bool getBounds (Vec3& boxMin, Vec3& boxMax) const;
+
+        // is a point inside the polygon? (XZ plane)
+        bool contains (const Vec3& point) const;
+
+        void findIntersectionWithVehiclePath
+        (const AbstractVehicle& v, PathIntersection& intersection) const;
+
+        Vec3 steerToAvoid (const AbstractVehicle& v,
+                           const float minTimeToCollision) const;
+
+    private:
+        seenFromState _seenFrom;
+    };
+
 } // namespace OpenSteer
     
     
@@ -0,0 +1,291 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// OccupancyGrid: a binary map of impassable cells covering a rectangle of
+// the XZ plane, bit-packed into rows of 64-bit words.  Cell (i, j) is
+// column i (along X) of row j (along Z), laid out like MapDrive's
+// TerrainMap.  Cells outside the grid read as outsideValue.
+//
+// Besides single cell access it provides scans which work a word at a
+// time: spans of a row (mask, popcount, count trailing zeros), rectangles
+// and convex XZ polygons (one row span per crossed row), and segments
+// (a DDA walk which visits each crossed cell exactly once).  Obstacle
+// scans therefore cost per cell rather than per sample point.
+//
+// The grid keeps an occupancy pyramid alongside the cells: at each coarser
+// level a bit is the OR of the 2x2 block of bits below it.  Rectangle,
+// polygon and segment scans skip whole empty blocks at coarse levels and
+// only look at individual cells near obstacles.
+//
+// Optionally the grid also maintains a distance field: for each cell the
+// distance to the nearest set cell, propagated outward from the set cells
+// ("brushfire" over nearest set cell sites) and repaired incrementally
+// when cells change.  It gives constant time clearance queries, and lets
+// segment scans leap across open space (sphere tracing).
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_OCCUPANCYGRID_H
+#define OPENSTEER_OCCUPANCYGRID_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Vec3.h"
+
+
+namespace OpenSteer {
+
+
+    class OccupancyGrid
+    {
+    public:
+
+        typedef uint64_t Word;
+        enum {bitsPerWord = 64};
+
+        // constructor: resolution cells along each axis, all clear
+        OccupancyGrid (const Vec3& center, float xSize, float zSize,
+                       int resolution);
+
+        // storage the grid can use in place of its own (for example a
+        // memory mapped OccupancyMapFile): cells, pyramid levels 1 and up
+        // one after another, and optionally a current distance field.
+        // Sizes are given by cellWordCount and pyramidWordCount.
+        struct Storage
+        {
+            Word* cells;
+            Word* pyramid;
+            int* nearestSites;  // NULL for no distance field
+            float* clearances;
+        };
+
+        // constructor: use external storage, which must outlive the grid
+        OccupancyGrid (const Vec3& center, float xSize, float zSize,
+                       int resolution, const Storage& storage);
+
+        // words of storage needed for cells and pyramid of a resolution
+        static size_t cellWordCount (int resolution);
+        static size_t pyramidWordCount (int resolution);
+
+        // destructor
+        virtual ~OccupancyGrid ();
+
+        // clear all cells (to false)
+        void clear (void);
+
+        // replace all cells with packed rows laid out like rowWords
+        // (getWordsPerRow words for each of resolution rows)
+        void readRows (const Word* source);
+
+        // get and set a cell based on 2d integer map index
+        bool getBit (int i, int j) const
+        {
+            return (rowWords (j)[i / bitsPerWord] >> (i % bitsPerWord)) & 1;
+        }
+        void setBit (int i, int j, bool value)
+        {
+            Word& w = rowWords (j)[i / bitsPerWord];
+            const Word mask = ((Word) 1) << (i % bitsPerWord);
+            if (((w & mask) != 0) == value) return;
+            w ^= mask;
+            cellChanged (i, j, value);
+        }
+
+        // get a cell based on a position in 3d world space
+        bool getValue (const Vec3& point) const;
+
+        // map index of the cell containing a point, false if outside
+        bool cellIndexAt (const Vec3& point, int& i, int& j) const;
+
+        // size of a cell, and the smaller of its two sides
+        float cellXSize (void) const {return xSize / (float) resolution;}
+        float cellZSize (void) const {return zSize / (float) resolution;}
+        float minSpacing (void) const;
+
+        // row span tests, cells i0 through i1 (inclusive) of row j.  Parts
+        // of the span outside the grid count as outsideValue.
+        bool anyInRowSpan (int j, int i0, int i1) const;
+        int countInRowSpan (int j, int i0, int i1) const;
+
+        // first set cell in a row span, or -1 (ignores outsideValue)
+        int firstInRowSpan (int j, int i0, int i1) const;
+
+        // is any cell of an index rectangle set?  (inclusive bounds)
+        bool anyInRect (int i0, int j0, int i1, int j1) const;
+
+        // is any cell overlapping an axis aligned XZ box set?
+        bool anyInXZBox (const Vec3& boxMin, const Vec3& boxMax) const;
+
+        // is any cell touched by a convex polygon on the XZ plane set?
+        // (corners in order, world space, Y ignored)
+        bool anyInXZPolygon (const Vec3 corners[], int cornerCount) const;
+
+        // walk the cells crossed by the segment from "from" to "to",
+        // stopping at the first set cell.  Returns true on a hit and sets
+        // hitDistance to the distance from "from" at which the segment
+        // enters that cell (or leaves the grid, if outsideValue is true).
+        bool scanXZSegment (const Vec3& from,
+                            const Vec3& to,
+                            float& hitDistance) const;
+
+        // an arc of sample points on the XZ plane for scanXZArcs: sample i
+        // (from 0) is "center" plus "spoke" rotated about Y by (i+1) times
+        // angleStep, its length scaled from 1 toward endScale (at the last
+        // sample), making a spiral when endScale is not 1.  With angleStep
+        // zero it is a straight radial ray.
+        struct XZArc
+        {
+            Vec3 center;
+            Vec3 spoke;        // from center to the start of the arc
+            float angleStep;   // radians per sample (signed)
+            float endScale;    // spoke length scale at the last sample
+            int sampleCount;
+
+            // position of sample i (-1 for the start of the arc)
+            Vec3 samplePoint (int i) const;
+        };
+
+        // scan many arcs at once: for each, the index of its first sample
+        // point on a set cell (or outside the grid, if outsideValue is
+        // true), -1 if none.  Arcs are run side by side in lanes, one
+        // sample of each at a time: sample positions and cell indices are
+        // computed for all lanes together, then the cells are fetched.
+        // Arcs over empty parts of the map are dropped before the scan.
+        void scanXZArcs (const XZArc arcs[], int arcCount, int firstHit[]) const;
+
+        // turn the distance field on or off.  Changes to cells are applied
+        // to it by updateDistanceField, until then it is out of date and
+        // clearance queries return zero.
+        void setDistanceFieldEnabled (bool enable);
+        bool hasDistanceField (void) const {return distanceFieldEnabled;}
+        bool isDistanceFieldCurrent (void) const
+        {
+            return distanceFieldEnabled && changedCells.empty () && ! rebuild;
+        }
+        void updateDistanceField (void);
+
+        // distance from a cell's center to the center of the nearest set
+        // cell (FLT_MAX if there is none)
+        float cellClearance (int i, int j) const
+        {
+            return clearance[i + (j * resolution)];
+        }
+
+        // a lower bound on the distance from a point to the nearest set
+        // cell (or to the edge of the grid when outsideValue is true).
+        // Zero when the distance field is not current.
+        float clearanceAt (const Vec3& point) const;
+
+        // occupancy pyramid: level 0 is the grid itself, each further level
+        // has half the resolution (rounded up).  Cell (i, j) of level k
+        // covers cells (i << k, j << k) through (((i+1) << k) - 1, ...).
+        int getPyramidLevelCount (void) const {return 1 + (int) levels.size();}
+        bool getPyramidBit (int level, int i, int j) const
+        {
+            if (level == 0) return getBit (i, j);
+            const PyramidLevel& l = levels[level - 1];
+            const Word w = l.words[(j * l.wordsPerRow) + (i / bitsPerWord)];
+            return (w >> (i % bitsPerWord)) & 1;
+        }
+
+        // direct access to the packed rows
+        int getWordsPerRow (void) const {return wordsPerRow;}
+        const Word* rowWords (int j) const {return cells + (j * wordsPerRow);}
+        Word* rowWords (int j) {return cells + (j * wordsPerRow);}
+
+        // direct access to the rest of the storage (for saving it)
+        const Word* pyramidWords (void) const {return pyramid;}
+        const int* nearestSiteCells (void) const {return nearestSite;}
+        const float* clearanceCells (void) const {return clearance;}
+
+        Vec3 center;
+        float xSize;
+        float zSize;
+        int resolution;
+
+        bool outsideValue;
+
+    private:
+
+        int wordsPerRow;
+        Word* cells;
+        Word* pyramid;
+        std::vector<Word> ownedCells;   // storage, unless external
+        std::vector<Word> ownedPyramid;
+
+        // coarser levels of the occupancy pyramid (levels[0] is level 1)
+        struct PyramidLevel
+        {
+            int resolution;
+            int wordsPerRow;
+            Word* words;
+        };
+        std::vector<PyramidLevel> levels;
+        void initialize (const Storage* storage);
+        void setPyramidBit (int level, int i, int j, bool value);
+        void rebuildPyramid (void);
+
+        // keep the pyramid and distance field in step with a changed cell
+        void cellChanged (int i, int j, bool value);
+
+        // highest pyramid level at which the block containing cell (i, j)
+        // is empty (0 if the cell is set or its level 1 block is not empty)
+        int emptyBlockLevel (int i, int j) const;
+
+        // does any set cell of the rectangle lie in the given blocks of a
+        // pyramid level?
+        bool anyInBlocks (int level, int bi0, int bj0, int bi1, int bj1,
+                          int i0, int j0, int i1, int j1) const;
+
+        // not copyable (may refer to external storage)
+        OccupancyGrid (const OccupancyGrid&);
+        OccupancyGrid& operator= (const OccupancyGrid&);
+
+        // distance field: nearest set cell and distance to it, per cell
+        bool distanceFieldEnabled;
+        bool rebuild;
+        std::vector<int> changedCells;
+        int* nearestSite;
+        float* clearance;
+        std::vector<int> ownedNearestSite;
+        std::vector<float> ownedClearance;
+
+        void rebuildDistanceField (void);
+        void propagateDistanceField (const std::vector<int>& seeds);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_OCCUPANCYGRID_H
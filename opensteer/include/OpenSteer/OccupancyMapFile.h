@@ -0,0 +1,151 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// OccupancyMapFile: a binary file holding an OccupancyGrid exactly as it
+// sits in memory, so a map made offline (see tools/pgm2occmap.cpp) loads
+// without parsing or rebuilding anything.  The file is memory mapped and
+// the grid used in place: its packed cells, its occupancy pyramid and,
+// when saved, its distance field.
+//
+// The mapping is private (copy on write): a loaded grid may be edited
+// like any other, the changes stay in memory and never reach the file.
+// Where mmap is not available the file is read into one buffer instead.
+//
+// File layout: an OccupancyMapFileHeader at offset zero, then the cell
+// words, pyramid words, nearest site indices and clearances, each section
+// starting on a 64 byte boundary at the offset given in the header.  Files
+// are native byte order, checked by OccupancyMapFileHeader::byteOrder.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_OCCUPANCYMAPFILE_H
+#define OPENSTEER_OCCUPANCYMAPFILE_H
+
+
+#include <vector>
+#include "OccupancyGrid.h"
+
+
+namespace OpenSteer {
+
+
+    // ----------------------------------------------------------------------------
+    // header at the start of an occupancy map file
+
+
+    struct OccupancyMapFileHeader
+    {
+        char magic[8];           // "OSOCCMAP"
+        uint32_t version;        // occupancyMapFileVersion
+        uint32_t byteOrder;      // occupancyMapByteOrder, as written
+        uint32_t flags;          // occupancyMapHasDistanceField
+        int32_t resolution;      // cells along each axis
+        float centerX;           // world space rectangle covered by the grid
+        float centerY;
+        float centerZ;
+        float xSize;
+        float zSize;
+        uint32_t outsideValue;   // value of cells outside the grid
+        uint64_t cellsOffset;    // byte offsets of the sections (0: absent)
+        uint64_t pyramidOffset;
+        uint64_t sitesOffset;
+        uint64_t clearanceOffset;
+        uint64_t fileSize;
+        uint32_t reserved[8];
+    };
+
+    enum
+    {
+        occupancyMapFileVersion = 1,
+        occupancyMapByteOrder = 0x01020304,
+        occupancyMapHasDistanceField = 1
+    };
+
+
+    // ----------------------------------------------------------------------------
+
+
+    class OccupancyMapFile
+    {
+    public:
+
+        // constructor and destructor (which closes the file)
+        OccupancyMapFile ();
+        ~OccupancyMapFile ();
+
+        // save a grid, including its distance field if that is current
+        static bool write (const char* path, const OccupancyGrid& grid);
+
+        // load a map file, false if it is missing or not a valid map
+        bool open (const char* path);
+
+        // release the grid and the mapping
+        void close (void);
+
+        bool isOpen (void) const {return loadedGrid != NULL;}
+
+        // the loaded grid (NULL when not open), valid until close
+        OccupancyGrid* grid (void) {return loadedGrid;}
+        const OccupancyMapFileHeader& getHeader (void) const {return header;}
+
+        // make a grid from an 8 bit grayscale image, one cell per pixel:
+        // pixel (x, y) becomes cell (x, y).  The grid is square, pixels
+        // beyond a non-square image read as blocked.  A pixel is blocked
+        // when darker than threshold (or, if darkIsBlocked is false, when
+        // at least as light).
+        static OccupancyGrid* makeGridFromImage (const unsigned char* pixels,
+                                                 int width,
+                                                 int height,
+                                                 const Vec3& center,
+                                                 float cellSize,
+                                                 int threshold,
+                                                 bool darkIsBlocked);
+
+    private:
+
+        OccupancyMapFileHeader header;
+        OccupancyGrid* loadedGrid;
+
+        // the file: mapped into memory, or else read into "buffer"
+        unsigned char* data;
+        size_t dataSize;
+        std::vector<uint64_t> buffer;
+
+        // not copyable
+        OccupancyMapFile (const OccupancyMapFile&);
+        OccupancyMapFile& operator= (const OccupancyMapFile&);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_OCCUPANCYMAPFILE_H
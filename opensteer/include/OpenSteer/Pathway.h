@@ -54,6 +54,8 @@ namespace OpenSteer {
     class Pathway
     {
     public:
+        virtual ~Pathway () {}
+
         // Given an arbitrary point ("A"), returns the nearest point ("P") on
         // this path.  Also returns, via output arguments, the path tangent at
         // P and a measure of how far A is outside the Pathway's "tube".  Note
@@ -102,7 +104,7 @@ namespace OpenSteer {
         float radius;
         bool cyclic;
 
-        PolylinePathway (void) {}
+        PolylinePathway (void) : points (NULL), lengths (NULL), normals (NULL) {}
 
         // construct a PolylinePathway given the number of points (vertices),
         // an array of points, and a path radius.
@@ -111,6 +113,9 @@ namespace OpenSteer {
                          const float _radius,
                          const bool _cyclic);
 
+        // release the point, length and normal arrays
+        virtual ~PolylinePathway ();
+
         // utility for constructors in derived classes
         void initialize (const int _pointCount,
                          const Vec3 _points[],
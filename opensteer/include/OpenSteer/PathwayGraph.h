@@ -0,0 +1,235 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// PathwayGraph: a network of pathways joined at junctions, with A* route
+// planning.  Nodes are junctions (points in space), edges are path "legs"
+// between two junctions, each with its own tube radius.  A planned route is
+// returned as a PathwayRoute which owns a PolylinePathway through the nodes
+// of the route, so it can be handed directly to steerToFollowPath.
+//
+// Routes are cached (least recently used first out) keyed by their start and
+// goal nodes, so agents asking for the same route share one search and one
+// PolylinePathway.  findRoutes plans a batch of requests at once: requests
+// with a common goal share a single backward search from that goal.
+//
+// Note: PolylinePathway keeps scratch state in its instance, so a shared
+// route must only be queried from one thread at a time.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_PATHWAYGRAPH_H
+#define OPENSTEER_PATHWAYGRAPH_H
+
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Pathway.h"
+
+
+namespace OpenSteer {
+
+
+    // ----------------------------------------------------------------------------
+    // PathwayRoute: the result of a route search, a sequence of graph nodes and
+    // the PolylinePathway through them.  Immutable once built.
+
+
+    class PathwayRoute
+    {
+    public:
+
+        // build a route through the given nodes (and their positions) with
+        // the given path tube radius
+        PathwayRoute (const std::vector<int>& nodes,
+                      const std::vector<Vec3>& points,
+                      const float radius);
+
+        ~PathwayRoute ();
+
+        // graph nodes along the route, from start to goal
+        const std::vector<int>& nodes (void) const {return _nodes;}
+
+        // pathway through the route's nodes
+        PolylinePathway& pathway (void) const {return *_pathway;}
+
+        // total length of the route
+        float length (void) const {return _pathway->getTotalPathLength ();}
+
+    private:
+        std::vector<int> _nodes;
+        PolylinePathway* _pathway;
+
+        // not copyable (owns its pathway)
+        PathwayRoute (const PathwayRoute&);
+        PathwayRoute& operator= (const PathwayRoute&);
+    };
+
+
+    // routes are shared between the cache and any number of agents
+    typedef std::shared_ptr<const PathwayRoute> PathwayRouteHandle;
+
+
+    // ----------------------------------------------------------------------------
+    // PathwayGraph
+
+
+    class PathwayGraph
+    {
+    public:
+
+        // a request for a route from start node to goal node (for findRoutes)
+        typedef std::pair<int, int> RouteRequest;
+
+        // constructor: the route cache holds at most this many routes
+        PathwayGraph (const int routeCacheCapacity = 256);
+
+        // destructor
+        ~PathwayGraph ();
+
+        // add a junction at the given position, returns its node index
+        int addNode (const Vec3& position);
+
+        // connect two nodes with a leg of the given tube radius
+        void addEdge (const int from,
+                      const int to,
+                      const float radius,
+                      const bool bidirectional = true);
+
+        // disconnect two nodes (does nothing if they are not connected)
+        void removeEdge (const int from,
+                         const int to,
+                         const bool bidirectional = true);
+
+        // number of nodes, and the position of a given node
+        int nodeCount (void) const {return (int) nodes.size();}
+        const Vec3& nodePosition (const int node) const
+        {
+            return nodes[node].position;
+        }
+
+        // the node nearest a given point (-1 if the graph is empty)
+        int nearestNode (const Vec3& point) const;
+
+        // find a route from start to goal.  Returns an empty handle if
+        // the goal is unreachable or if start and goal are the same node.
+        PathwayRouteHandle findRoute (const int start, const int goal);
+
+        // find a route between the nodes nearest two given points
+        PathwayRouteHandle findRoute (const Vec3& from, const Vec3& to);
+
+        // plan a batch of routes, results[i] is the route for requests[i].
+        // Requests which share a goal share one search.
+        void findRoutes (const std::vector<RouteRequest>& requests,
+                         std::vector<PathwayRouteHandle>& results);
+
+        // forget all cached routes (done automatically when edges change)
+        void clearRouteCache (void);
+
+        // route cache size and statistics
+        int getRouteCacheCapacity (void) const {return cacheCapacity;}
+        void setRouteCacheCapacity (const int capacity);
+        int getRouteCacheSize (void) const {return (int) cacheMap.size();}
+        int getRouteCacheHits (void) const {return cacheHits;}
+        int getRouteCacheMisses (void) const {return cacheMisses;}
+        int getSearchCount (void) const {return searchCount;}
+
+    private:
+
+        struct Edge
+        {
+            int to;
+            float length;
+            float radius;
+        };
+
+        struct Node
+        {
+            Vec3 position;
+            std::vector<Edge> out;  // legs leaving this node
+            std::vector<Edge> in;   // legs arriving here (Edge::to is source)
+        };
+
+        std::vector<Node> nodes;
+
+        // per-node search state, valid when stamp equals searchStamp
+        // (avoids clearing all of it before each search)
+        struct SearchState
+        {
+            float cost;
+            int link;        // parent (A*) or next hop toward goal (batch)
+            float radius;    // radius of the leg to "link"
+            unsigned stamp;
+            bool closed;
+        };
+
+        std::vector<SearchState> search;
+        unsigned searchStamp;
+        void beginSearch (void);
+        SearchState& state (const int node);
+
+        // A* from start to goal, returns an empty handle if unreachable
+        PathwayRouteHandle searchRoute (const int start, const int goal);
+
+        // Dijkstra backward from goal until all given starts are settled,
+        // then build the route from each of them (routes[i] for starts[i])
+        void searchRoutesToGoal (const int goal,
+                                 const std::vector<int>& starts,
+                                 std::vector<PathwayRouteHandle>& routes);
+
+        // build a route by following "link" from start to goal
+        PathwayRouteHandle buildRoute (const int start,
+                                       const int goal,
+                                       const bool forward);
+
+        // least recently used route cache
+        typedef std::pair<int, int> RouteKey;
+        typedef std::pair<RouteKey, PathwayRouteHandle> CacheEntry;
+        typedef std::list<CacheEntry> CacheList;
+        CacheList cacheList; // most recently used first
+        std::map<RouteKey, CacheList::iterator> cacheMap;
+        int cacheCapacity;
+        int cacheHits;
+        int cacheMisses;
+        int searchCount;
+
+        bool lookupCachedRoute (const RouteKey& key, PathwayRouteHandle& route);
+        void insertCachedRoute (const RouteKey& key,
+                                const PathwayRouteHandle& route);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_PATHWAYGRAPH_H
@@ -0,0 +1,193 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// Profiler: where simulation time goes, by named zones.
+//
+// A zone is a scope marked with OPENSTEER_PROFILE_ZONE ("name").  Zones
+// nest, and each thread records the zones it leaves into a ring buffer of
+// its own (no locking).  Once a frame, endFrame gathers them all into
+// per-frame totals for each zone name: calls, total time and "self" time
+// (not counting zones nested inside), which is what points at the
+// behavior eating the frame.  Optionally the zones are also kept as a
+// trace, written out in the Chrome tracing JSON format (load it in
+// chrome://tracing or Perfetto).
+//
+// The profiler is off until setEnabled (true): a zone then costs a test of
+// one flag.  Defining OPENSTEER_NO_PROFILER compiles zones out entirely.
+//
+// Zone names must be string literals (or otherwise outlive the profiler).
+//
+// Besides zones it keeps per-frame counts of things (neighbors found,
+// annotation lines drawn...), added to with OPENSTEER_PROFILE_COUNT.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_PROFILER_H
+#define OPENSTEER_PROFILER_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+
+namespace OpenSteer {
+
+
+    class Profiler
+    {
+    public:
+
+        // totals for the zones of one name over a frame
+        struct ZoneTotals
+        {
+            const char* name;
+            int calls;
+            double seconds;       // including nested zones
+            double selfSeconds;   // excluding nested zones
+        };
+
+        // turn recording on or off (zones already entered still finish)
+        static void setEnabled (bool enable);
+        static bool isEnabled (void)
+        {
+            return enabled.load (std::memory_order_relaxed);
+        }
+
+        // end a frame: gather the zones all threads have left since the
+        // last call into the frame totals (and the trace, when recording
+        // one), and the counts added to.  Call when no other thread is
+        // inside a zone or adding to a count, for example between
+        // simulation updates.
+        static void endFrame (void);
+
+        // totals of the last frame, most self time first, and the totals
+        // for a zone name (NULL if it was not entered last frame)
+        static const std::vector<ZoneTotals>& getFrameTotals (void);
+        static const ZoneTotals* findFrameTotals (const char* name);
+
+        // counts added to during the last frame, and the count of a name
+        // (zero if it was not added to last frame)
+        struct CountTotals
+        {
+            const char* name;
+            int64_t total;
+        };
+        static const std::vector<CountTotals>& getFrameCounts (void);
+        static int64_t getFrameCount (const char* name);
+
+        // real time between the last two endFrame calls
+        static double getFrameSeconds (void);
+
+        // zones lost because a thread's ring buffer filled up in a frame
+        static int getDroppedZones (void);
+
+        // record zones as a trace (up to maxZones of them), from the next
+        // frame on, and write the trace to a file in Chrome tracing
+        // format (returns false if the file cannot be written)
+        static void startTrace (size_t maxZones = 1000000);
+        static void stopTrace (void);
+        static bool isTracing (void);
+        static bool writeChromeTrace (const char* path);
+
+        // used by ProfileZone: time now, and record a zone
+        static int64_t enterZone (void);
+        static void leaveZone (const char* name, int64_t start);
+
+        // used by OPENSTEER_PROFILE_COUNT: add to a count
+        static void addToCount (const char* name, int64_t amount);
+
+    private:
+
+        static std::atomic<bool> enabled;
+    };
+
+
+    // a zone: from construction to destruction of this object
+
+    class ProfileZone
+    {
+    public:
+        explicit ProfileZone (const char* zoneName) : start (0)
+        {
+            name = Profiler::isEnabled () ? zoneName : NULL;
+            if (name) start = Profiler::enterZone ();
+        }
+        ~ProfileZone ()
+        {
+            if (name) Profiler::leaveZone (name, start);
+        }
+    private:
+        const char* name;
+        int64_t start;
+
+        // not copyable
+        ProfileZone (const ProfileZone&);
+        ProfileZone& operator= (const ProfileZone&);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+// mark the rest of the enclosing scope as a zone
+
+
+#define OPENSTEER_PROFILE_JOIN2(a, b) a##b
+#define OPENSTEER_PROFILE_JOIN(a, b) OPENSTEER_PROFILE_JOIN2 (a, b)
+
+#ifndef OPENSTEER_NO_PROFILER
+#define OPENSTEER_PROFILE_ZONE(name) \
+    OpenSteer::ProfileZone OPENSTEER_PROFILE_JOIN (profileZone, __LINE__) (name)
+#else
+#define OPENSTEER_PROFILE_ZONE(name)
+#endif
+
+
+// ----------------------------------------------------------------------------
+// add to a named per-frame count (amount is not evaluated when disabled)
+
+
+#ifndef OPENSTEER_NO_PROFILER
+#define OPENSTEER_PROFILE_COUNT(name, amount)                           \
+    do {                                                                \
+        if (OpenSteer::Profiler::isEnabled ())                          \
+            OpenSteer::Profiler::addToCount ((name), (amount));         \
+    } while (0)
+#else
+#define OPENSTEER_PROFILE_COUNT(name, amount) \
+    do {(void) sizeof (amount);} while (0)
+#endif
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_PROFILER_H
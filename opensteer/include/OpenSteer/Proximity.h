@@ -46,6 +46,8 @@
 #include <algorithm>
 #include <vector>
 #include "OpenSteer/Vec3.h"
+#include "OpenSteer/Profiler.h"
+#include "OpenSteer/ObjectPool.h"
 #include "OpenSteer/lq.h"   // XXX temp?
 
 
@@ -74,6 +76,41 @@ namespace OpenSteer {
     };
 
 
+    // ----------------------------------------------------------------------------
+    // tokens of a class come from an ObjectPool shared by all databases of
+    // that class, so adding and removing many clients does not churn the
+    // heap.  Token classes derive from this, giving their own type.
+
+
+    template <class Token>
+    class PooledToken
+    {
+    public:
+
+        static void* operator new (size_t size)
+        {
+            // (a class derived from Token is not the pool's size)
+            if (size != sizeof (Token)) return ::operator new (size);
+            return pool().allocate ();
+        }
+
+        static void operator delete (void* p, size_t size)
+        {
+            if (size != sizeof (Token)) ::operator delete (p);
+            else pool().release (p);
+        }
+
+    private:
+
+        // never destroyed: tokens may be deleted during static destruction
+        static ObjectPool<Token>& pool (void)
+        {
+            static ObjectPool<Token>* tokens = new ObjectPool<Token> ();
+            return *tokens;
+        }
+    };
+
+
     // ----------------------------------------------------------------------------
     // abstract type for all kinds of proximity databases
 
@@ -125,7 +162,9 @@ namespace OpenSteer {
         }
 
         // "token" to represent objects stored in the database
-        class tokenType : public AbstractTokenForProximityDatabase<ContentType>
+        class tokenType
+            : public AbstractTokenForProximityDatabase<ContentType>,
+              public PooledToken<tokenType>
         {
         public:
 
@@ -136,21 +175,26 @@ namespace OpenSteer {
                 // token represents, and store this token on the database's vector
                 bfpd = &pd;
                 object = parentObject;
+                index = bfpd->group.size ();
                 bfpd->group.push_back (this);
             }
 
             // destructor
             virtual ~tokenType ()
             {
-                // remove this token from the database's vector
-                bfpd->group.erase (std::find (bfpd->group.begin(),
-                                              bfpd->group.end(),
-                                              this));
+                // remove this token from the database's vector: move the
+                // last token into its place
+                tokenVector& group = bfpd->group;
+                tokenType* last = group.back ();
+                group[index] = last;
+                last->index = index;
+                group.pop_back ();
             }
 
             // the client object calls this each time its position changes
             void updateForNewPosition (const Vec3& newPosition)
             {
+                OPENSTEER_PROFILE_ZONE ("proximity update");
                 position = newPosition;
             }
 
@@ -159,6 +203,8 @@ namespace OpenSteer {
                                 const float radius,
                                 std::vector<ContentType>& results)
             {
+                OPENSTEER_PROFILE_ZONE ("neighbor query");
+                const size_t found = results.size ();
                 // loop over all tokens
                 const float r2 = radius * radius;
                 for (tokenIterator i = bfpd->group.begin();
@@ -171,12 +217,15 @@ namespace OpenSteer {
                     // push onto result vector when within given radius
                     if (d2 < r2) results.push_back ((**i).object);
                 }
+                OPENSTEER_PROFILE_COUNT ("neighbors found",
+                                         results.size () - found);
             }
 
         private:
             BruteForceProximityDatabase* bfpd;
             ContentType object;
             Vec3 position;
+            size_t index;   // in bfpd->group
         };
 
         typedef std::vector<tokenType*> tokenVector;
@@ -232,7 +281,9 @@ namespace OpenSteer {
         }
 
         // "token" to represent objects stored in the database
-        class tokenType : public AbstractTokenForProximityDatabase<ContentType>
+        class tokenType
+            : public AbstractTokenForProximityDatabase<ContentType>,
+              public PooledToken<tokenType>
         {
         public:
 
@@ -252,6 +303,7 @@ namespace OpenSteer {
             // the client object calls this each time its position changes
             void updateForNewPosition (const Vec3& p)
             {
+                OPENSTEER_PROFILE_ZONE ("proximity update");
                 lqUpdateForNewLocation (lq, &proxy, p.x, p.y, p.z);
             }
 
@@ -260,11 +312,15 @@ namespace OpenSteer {
                                 const float radius,
                                 std::vector<ContentType>& results)
             {
+                OPENSTEER_PROFILE_ZONE ("neighbor query");
+                const size_t found = results.size ();
                 lqMapOverAllObjectsInLocality (lq, 
                                                center.x, center.y, center.z,
                                                radius,
                                                perNeighborCallBackFunction,
                                                (void*)&results);
+                OPENSTEER_PROFILE_COUNT ("neighbors found",
+                                         results.size () - found);
             }
 
             // called by LQ for each clientObject in the specified neighborhood:
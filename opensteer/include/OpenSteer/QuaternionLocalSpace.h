@@ -0,0 +1,393 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+//
+// QuaternionLocalSpace: a compact alternative to LocalSpaceMixin
+//
+// QuaternionLocalSpaceMixin implements the same interface as
+// LocalSpaceMixin but stores orientation as a unit quaternion packed into
+// four signed 16 bit integers, rather than as three basis vectors.  With
+// position that is 20 bytes of local space per agent instead of 48.  Side,
+// up and forward are derived from the quaternion when they are asked for;
+// getBasis derives all three at once, and the transforms use it.
+//
+// The stored orientation is always a pure rotation, so the setters keep
+// the space orthonormal as they go: setting one basis vector makes it
+// exact and adjusts the other two as little as possible.  The basis read
+// back differs from what was set by the quantization (about 1e-4).
+//
+// SimpleVehicle uses it in place of LocalSpaceMixin when compiled with
+// OPENSTEER_PACKED_LOCAL_SPACE defined.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_QUATERNIONLOCALSPACE_H
+#define OPENSTEER_QUATERNIONLOCALSPACE_H
+
+
+#include <stdint.h>
+#include "LocalSpace.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+namespace OpenSteer {
+
+
+    template <class Super>
+    class QuaternionLocalSpaceMixin : public Super
+    {
+    private:
+
+        Vec3 _position;          // origin of local space
+        int16_t _orientation[4]; // rotation quaternion w, x, y, z (snorm16)
+
+    public:
+
+        // accessors (get and set) for side, up, forward and position
+        Vec3 side (void) const
+        {
+            float w, x, y, z, s;
+            if (! unpack (w, x, y, z, s)) return handedness () * Vec3 (1,0,0);
+            return handedness () * Vec3 (1 - s * (y*y + z*z),
+                                         s * (x*y + w*z),
+                                         s * (x*z - w*y));
+        }
+        Vec3 up (void) const
+        {
+            float w, x, y, z, s;
+            if (! unpack (w, x, y, z, s)) return Vec3 (0, 1, 0);
+            return Vec3 (s * (x*y - w*z),
+                         1 - s * (x*x + z*z),
+                         s * (y*z + w*x));
+        }
+        Vec3 forward (void) const
+        {
+            float w, x, y, z, s;
+            if (! unpack (w, x, y, z, s)) return Vec3 (0, 0, 1);
+            return Vec3 (s * (x*z + w*y),
+                         s * (y*z - w*x),
+                         1 - s * (x*x + y*y));
+        }
+        Vec3 position (void) const {return _position;};
+
+        // setting one basis vector keeps it and rotates the other two to
+        // match (a zero vector leaves the orientation unchanged)
+        Vec3 setSide (Vec3 s)
+        {
+            const Vec3 x = s.normalize () * handedness ();
+            if (x != Vec3::zero)
+            {
+                const Vec3 y = perpendicularUnit (x, up ());
+                pack (x, y, cross (x, y));
+            }
+            return s;
+        }
+        Vec3 setUp (Vec3 u)
+        {
+            const Vec3 y = u.normalize ();
+            if (y != Vec3::zero)
+            {
+                const Vec3 z = perpendicularUnit (y, forward ());
+                pack (cross (y, z), y, z);
+            }
+            return u;
+        }
+        Vec3 setForward (Vec3 f)
+        {
+            const Vec3 z = f.normalize ();
+            if (z != Vec3::zero) packFromForward (z, up ());
+            return f;
+        }
+        Vec3 setPosition (Vec3 p) {return _position = p;};
+        Vec3 setSide     (float x, float y, float z){return setSide (Vec3 (x,y,z));};
+        Vec3 setUp       (float x, float y, float z){return setUp (Vec3 (x,y,z));};
+        Vec3 setForward  (float x, float y, float z){return setForward (Vec3 (x,y,z));};
+        Vec3 setPosition (float x, float y, float z){return _position.set(x,y,z);};
+
+        // derive all three basis vectors at once
+        void getBasis (Vec3& s, Vec3& u, Vec3& f) const
+        {
+            float w, x, y, z, k;
+            if (! unpack (w, x, y, z, k))
+            {
+                s = handedness () * Vec3 (1, 0, 0);
+                u.set (0, 1, 0);
+                f.set (0, 0, 1);
+                return;
+            }
+            const float xx = x*x, yy = y*y, zz = z*z;
+            const float xy = x*y, xz = x*z, yz = y*z;
+            const float wx = w*x, wy = w*y, wz = w*z;
+            s = handedness () * Vec3 (1 - k * (yy + zz),
+                                      k * (xy + wz),
+                                      k * (xz - wy));
+            u.set (k * (xy - wz), 1 - k * (xx + zz), k * (yz + wx));
+            f.set (k * (xz + wy), k * (yz - wx), 1 - k * (xx + yy));
+        }
+
+
+        // ------------------------------------------------------------------------
+        // handedness, as in LocalSpaceMixin
+
+
+        bool rightHanded (void) const {return true;}
+
+
+        // ------------------------------------------------------------------------
+        // constructors (forward is kept exact, side is derived)
+
+
+        QuaternionLocalSpaceMixin (void)
+        {
+            resetLocalSpace ();
+        };
+
+        QuaternionLocalSpaceMixin (const Vec3& Side,
+                                   const Vec3& Up,
+                                   const Vec3& Forward,
+                                   const Vec3& Position)
+        {
+            (void) Side;
+            resetLocalSpace ();
+            regenerateOrthonormalBasis (Forward, Up);
+            _position = Position;
+        };
+
+        QuaternionLocalSpaceMixin (const Vec3& Up,
+                                   const Vec3& Forward,
+                                   const Vec3& Position)
+        {
+            resetLocalSpace ();
+            regenerateOrthonormalBasis (Forward, Up);
+            _position = Position;
+        };
+
+
+        // ------------------------------------------------------------------------
+        // reset transform to identity (see LocalSpaceMixin)
+
+
+        void resetLocalSpace (void)
+        {
+            _orientation[0] = 32767;
+            _orientation[1] = _orientation[2] = _orientation[3] = 0;
+            _position.set (0, 0, 0);
+        };
+
+
+        // ------------------------------------------------------------------------
+        // transform directions and points between global and local space
+
+
+        Vec3 localizeDirection (const Vec3& globalDirection) const
+        {
+            Vec3 s, u, f;
+            getBasis (s, u, f);
+            return Vec3 (globalDirection.dot (s),
+                         globalDirection.dot (u),
+                         globalDirection.dot (f));
+        };
+
+        Vec3 localizePosition (const Vec3& globalPosition) const
+        {
+            return localizeDirection (globalPosition - _position);
+        };
+
+        Vec3 globalizePosition (const Vec3& localPosition) const
+        {
+            return _position + globalizeDirection (localPosition);
+        };
+
+        Vec3 globalizeDirection (const Vec3& localDirection) const
+        {
+            Vec3 s, u, f;
+            getBasis (s, u, f);
+            return ((s * localDirection.x) +
+                    (u * localDirection.y) +
+                    (f * localDirection.z));
+        };
+
+
+        // ------------------------------------------------------------------------
+        // side is always derived from forward and up, nothing to do
+
+
+        void setUnitSideFromForwardAndUp (void) {}
+
+
+        // ------------------------------------------------------------------------
+        // regenerate the orthonormal basis given a new forward, keeping the
+        // old up as nearly as possible
+
+
+        void regenerateOrthonormalBasisUF (const Vec3& newUnitForward)
+        {
+            packFromForward (newUnitForward, up ());
+        }
+
+        void regenerateOrthonormalBasis (const Vec3& newForward)
+        {
+            setForward (newForward);
+        }
+
+        void regenerateOrthonormalBasis (const Vec3& newForward,
+                                         const Vec3& newUp)
+        {
+            const Vec3 z = newForward.normalize ();
+            if (z != Vec3::zero) packFromForward (z, newUp);
+        }
+
+
+        // ------------------------------------------------------------------------
+        // rotate forward to side, as in LocalSpaceMixin
+
+
+        Vec3 localRotateForwardToSide (const Vec3& v) const
+        {
+            return Vec3 (rightHanded () ? -v.z : +v.z,
+                         v.y,
+                         v.x);
+        }
+
+        Vec3 globalRotateForwardToSide (const Vec3& globalForward) const
+        {
+            const Vec3 localForward = localizeDirection (globalForward);
+            const Vec3 localSide = localRotateForwardToSide (localForward);
+            return globalizeDirection (localSide);
+        }
+
+    private:
+
+        // the stored rotation has columns x (side, negated when right
+        // handed), y (up) and z (forward), with x = y cross z
+
+        float handedness (void) const {return rightHanded () ? -1.0f : 1.0f;}
+
+        // the raw quaternion and the scale 2/|q|^2 which takes care of its
+        // quantization error, false for a zero quaternion
+        bool unpack (float& w, float& x, float& y, float& z, float& s) const
+        {
+            w = _orientation[0];
+            x = _orientation[1];
+            y = _orientation[2];
+            z = _orientation[3];
+            const float n = (w * w) + (x * x) + (y * y) + (z * z);
+            s = (n == 0) ? 0 : (2 / n);
+            return n != 0;
+        }
+
+        // unit vector perpendicular to "axis", the component of "hint" in
+        // that plane, or any perpendicular if "hint" is (nearly) parallel
+        static Vec3 perpendicularUnit (const Vec3& axis, const Vec3& hint)
+        {
+            Vec3 p = hint - (axis * axis.dot (hint));
+            if (p.lengthSquared () < 1e-10f) p = findPerpendicularIn3d (axis);
+            return p.normalize ();
+        }
+
+        static Vec3 cross (const Vec3& a, const Vec3& b)
+        {
+            Vec3 c;
+            c.cross (a, b);
+            return c;
+        }
+
+        // forward z exact, up as near to "oldUp" as possible
+        void packFromForward (const Vec3& z, const Vec3& oldUp)
+        {
+            const Vec3 y = perpendicularUnit (z, oldUp);
+            pack (cross (y, z), y, z);
+        }
+
+        static int16_t quantize (float v)
+        {
+            return (int16_t) (v + ((v < 0) ? -0.5f : 0.5f));
+        }
+
+        // store the rotation with orthonormal columns x, y and z
+        void pack (const Vec3& x, const Vec3& y, const Vec3& z)
+        {
+            // Shepperd's method, picking the best conditioned of four
+            // formulas.  Each gives the quaternion times a positive factor,
+            // which normalization removes.
+            float q[4];
+            const float trace = x.x + y.y + z.z;
+            if (trace > 0)
+            {
+                q[0] = trace + 1;
+                q[1] = y.z - z.y;
+                q[2] = z.x - x.z;
+                q[3] = x.y - y.x;
+            }
+            else if ((x.x > y.y) && (x.x > z.z))
+            {
+                q[0] = y.z - z.y;
+                q[1] = 1 + x.x - y.y - z.z;
+                q[2] = y.x + x.y;
+                q[3] = z.x + x.z;
+            }
+            else if (y.y > z.z)
+            {
+                q[0] = z.x - x.z;
+                q[1] = y.x + x.y;
+                q[2] = 1 + y.y - x.x - z.z;
+                q[3] = z.y + y.z;
+            }
+            else
+            {
+                q[0] = x.y - y.x;
+                q[1] = z.x + x.z;
+                q[2] = z.y + y.z;
+                q[3] = 1 + z.z - x.x - y.y;
+            }
+
+            // unit length, with w >= 0 (q and -q are the same rotation),
+            // scaled to the range of int16_t
+            const float n = sqrtXXX ((q[0] * q[0]) + (q[1] * q[1]) +
+                                     (q[2] * q[2]) + (q[3] * q[3]));
+            const float k = ((q[0] < 0) ? -32767 : 32767) / n;
+            for (int i = 0; i < 4; i++) _orientation[i] = quantize (q[i] * k);
+        }
+    };
+
+
+    // ----------------------------------------------------------------------------
+    // Concrete QuaternionLocalSpace class
+
+
+    typedef QuaternionLocalSpaceMixin<AbstractLocalSpace> QuaternionLocalSpace;
+
+} // namespace OpenSteer
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_QUATERNIONLOCALSPACE_H
@@ -0,0 +1,94 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// ReciprocalAvoidance: the geometry behind ORCA ("optimal reciprocal
+// collision avoidance", van den Berg, Guy, Lin and Manocha, 2011), used by
+// SteerLibraryMixin::steerForReciprocalAvoidance.
+//
+// Each neighbor limits an agent's new velocity to one side of a line on the
+// XZ plane: the velocities which avoid colliding with that neighbor within
+// a time horizon, assuming the neighbor takes its half of the avoidance.
+// solveOrcaLines finds the velocity nearest a preferred one which is on
+// the allowed side of every line and no faster than a maximum speed (a 2D
+// linear program, solved incrementally).  When the lines leave no such
+// velocity, it finds the one which violates them least.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_RECIPROCALAVOIDANCE_H
+#define OPENSTEER_RECIPROCALAVOIDANCE_H
+
+
+#include "Vec3.h"
+
+
+namespace OpenSteer {
+
+
+    // a directed line on the XZ plane (Y is zero).  Velocities v on it or
+    // on the side where det (direction, v - point) >= 0 are allowed, with
+    // det (a, b) = a.x * b.z - a.z * b.x.
+    struct OrcaLine
+    {
+        Vec3 point;
+        Vec3 direction;   // unit length
+    };
+
+
+    // most neighbors (nearest first) an agent takes into account
+    enum {orcaMaxNeighbors = 16};
+
+
+    // the line for one neighbor, from its position and velocity relative
+    // to the agent's (neighbor minus agent, and agent minus neighbor), the
+    // sum of the radii, the agent's velocity, the time horizon, and the
+    // simulation time step (used when the two already overlap)
+    void makeOrcaLine (const Vec3& relativePosition,
+                       const Vec3& relativeVelocity,
+                       const float combinedRadius,
+                       const Vec3& velocity,
+                       const float timeHorizon,
+                       const float timeStep,
+                       OrcaLine& line);
+
+
+    // the velocity nearest preferredVelocity allowed by all of the lines
+    // (at most orcaMaxNeighbors) and no faster than maxSpeed
+    Vec3 solveOrcaLines (const OrcaLine lines[],
+                         const int lineCount,
+                         const float maxSpeed,
+                         const Vec3& preferredVelocity);
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_RECIPROCALAVOIDANCE_H
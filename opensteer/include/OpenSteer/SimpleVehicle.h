@@ -67,6 +67,7 @@
 #include "AbstractVehicle.h"
 #include "SteerLibrary.h"
 #include "Annotation.h"
+#include "QuaternionLocalSpace.h"
 
 
 namespace OpenSteer {
@@ -76,7 +77,12 @@ namespace OpenSteer {
 
 
     // SimpleVehicle_1 adds concrete LocalSpace methods to AbstractVehicle
+    // (orientation packed into a quaternion with OPENSTEER_PACKED_LOCAL_SPACE)
+#ifdef OPENSTEER_PACKED_LOCAL_SPACE
+    typedef QuaternionLocalSpaceMixin<AbstractVehicle> SimpleVehicle_1;
+#else
     typedef LocalSpaceMixin<AbstractVehicle> SimpleVehicle_1;
+#endif
 
 
     // SimpleVehicle_2 adds concrete annotation methods to SimpleVehicle_1
@@ -212,7 +218,7 @@ namespace OpenSteer {
         void randomizeHeadingOnXZPlane (void)
         {
             setUp (Vec3::up);
-            setForward (RandomUnitVectorOnXZPlane ());
+            setForward (RandomUnitVectorOnXZPlane (randomStream));
             setSide (localRotateForwardToSide (forward()));
         }
 
@@ -49,8 +49,13 @@
 
 #include "AbstractVehicle.h"
 #include "Pathway.h"
+#include "FlowField.h"
 #include "Obstacle.h"
+#include "IndexedObstacleGroup.h"
+#include "Proximity.h"
+#include "ReciprocalAvoidance.h"
 #include "Utilities.h"
+#include "Profiler.h"
 #include "Annotation.h"
 
 
@@ -68,6 +73,7 @@ namespace OpenSteer {
         using Super::speed;
         using Super::maxSpeed;
         using Super::maxForce;
+        using Super::mass;
         using Super::position;
         using Super::localizePosition;
         using Super::predictFuturePosition;
@@ -95,6 +101,10 @@ namespace OpenSteer {
 
         // -------------------------------------------------- steering behaviors
 
+        // this vehicle's own random numbers (seeded by SimpleVehicle with
+        // its serial number, not changed by reset)
+        RandomStream randomStream;
+
         // Wander behavior
         float WanderSide;
         float WanderUp;
@@ -116,6 +126,12 @@ namespace OpenSteer {
                                 Pathway& path);
         Vec3 steerToStayOnPath (const float predictionTime, Pathway& path);
 
+        // Flow field following behavior: steer toward the direction the
+        // field gives at our predicted future position.  Costs the same
+        // however complex the map behind the field is.
+        Vec3 steerForFlowField (const float predictionTime,
+                                const FlowField& field);
+
         // ------------------------------------------------------------------------
         // Obstacle Avoidance behavior
         //
@@ -137,6 +153,12 @@ namespace OpenSteer {
         Vec3 steerToAvoidObstacles (const float minTimeToCollision,
                                     const ObstacleGroup& obstacles);
 
+        // avoids the obstacles of an IndexedObstacleGroup, considering only
+        // those near the corridor ahead of the vehicle
+
+        Vec3 steerToAvoidObstacles (const float minTimeToCollision,
+                                    const IndexedObstacleGroup& obstacles);
+
 
         // ------------------------------------------------------------------------
         // Unaligned collision avoidance behavior: avoid colliding with other
@@ -149,6 +171,27 @@ namespace OpenSteer {
         Vec3 steerToAvoidNeighbors (const float minTimeToCollision,
                                     const AVGroup& others);
 
+        // the same, considering only the neighbors which could come within
+        // collision range before minTimeToCollision, found with a proximity
+        // database: those within reach at the bound on relative speed (my
+        // speed plus maxSpeedOfOthers).  The neighbors found are left in
+        // "neighbors" (storage supplied by the caller).  Assumes the other
+        // vehicles are no larger than this one.
+
+        Vec3 steerToAvoidNeighbors
+        (const float minTimeToCollision,
+         AbstractTokenForProximityDatabase<AbstractVehicle*>& proximityToken,
+         const float maxSpeedOfOthers,
+         AVGroup& neighbors);
+
+        // the most immediate collision threat among "others" (NULL if none
+        // sooner than minTimeToCollision) and the time until it.  The
+        // nearest approach math is done for a batch of vehicles at once.
+        AbstractVehicle* findMostImmediateThreat
+        (const float minTimeToCollision,
+         const AVGroup& others,
+         float& threatTime);
+
 
         // Given two vehicles, based on their current positions and velocities,
         // determine the time until nearest approach
@@ -178,6 +221,36 @@ namespace OpenSteer {
                                          const AVGroup& others);
 
 
+        // ------------------------------------------------------------------------
+        // Reciprocal avoidance (ORCA): pick the velocity nearest a preferred
+        // one which avoids colliding with any of the nearest neighbors (up
+        // to orcaMaxNeighbors) within timeHorizon, assuming they do the
+        // same.  Neighbors already overlapping are separated within
+        // timeStep.  Velocities are on the XZ plane.  Returns the steering
+        // force which reaches that velocity in timeStep (clipped to
+        // maxForce when applied).
+
+
+        Vec3 steerForReciprocalAvoidance (const float timeHorizon,
+                                          const float timeStep,
+                                          const Vec3& preferredVelocity,
+                                          const AVGroup& others);
+
+        // the same, with neighbors found by a proximity database: those
+        // which could collide within timeHorizon at my maximum speed plus
+        // maxSpeedOfOthers.  The neighbors found are left in "neighbors"
+        // (storage supplied by the caller).  Assumes the other vehicles are
+        // no larger than this one.
+
+        Vec3 steerForReciprocalAvoidance
+        (const float timeHorizon,
+         const float timeStep,
+         const Vec3& preferredVelocity,
+         AbstractTokenForProximityDatabase<AbstractVehicle*>& proximityToken,
+         const float maxSpeedOfOthers,
+         AVGroup& neighbors);
+
+
         // ------------------------------------------------------------------------
         // used by boid behaviors
 
@@ -337,10 +410,11 @@ OpenSteer::Vec3
 OpenSteer::SteerLibraryMixin<Super>::
 steerForWander (float dt)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForWander");
     // random walk WanderSide and WanderUp between -1 and +1
     const float speed = 12 * dt; // maybe this (12) should be an argument?
-    WanderSide = scalarRandomWalk (WanderSide, speed, -1, +1);
-    WanderUp   = scalarRandomWalk (WanderUp,   speed, -1, +1);
+    WanderSide = scalarRandomWalk (WanderSide, speed, -1, +1, randomStream);
+    WanderUp   = scalarRandomWalk (WanderUp,   speed, -1, +1, randomStream);
 
     // return a pure lateral steering vector: (+/-Side) + (+/-Up)
     return (side() * WanderSide) + (up() * WanderUp);
@@ -356,6 +430,7 @@ OpenSteer::Vec3
 OpenSteer::SteerLibraryMixin<Super>::
 steerForSeek (const Vec3& target)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForSeek");
     const Vec3 desiredVelocity = target - position();
     return desiredVelocity - velocity();
 }
@@ -370,6 +445,7 @@ OpenSteer::Vec3
 OpenSteer::SteerLibraryMixin<Super>::
 steerForFlee (const Vec3& target)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForFlee");
     const Vec3 desiredVelocity = position - target;
     return desiredVelocity - velocity();
 }
@@ -412,6 +488,7 @@ OpenSteer::Vec3
 OpenSteer::SteerLibraryMixin<Super>::
 steerToStayOnPath (const float predictionTime, Pathway& path)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToStayOnPath");
     // predict our future position
     const Vec3 futurePosition = predictFuturePosition (predictionTime);
 
@@ -446,6 +523,7 @@ steerToFollowPath (const int direction,
                    const float predictionTime,
                    Pathway& path)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToFollowPath");
     // our goal will be offset from our path distance by this amount
     const float pathDistanceOffset = direction * predictionTime * speed();
 
@@ -497,6 +575,31 @@ steerToFollowPath (const int direction,
 }
 
 
+// ----------------------------------------------------------------------------
+// Flow field following behavior
+
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerForFlowField (const float predictionTime, const FlowField& field)
+{
+    OPENSTEER_PROFILE_ZONE ("steerForFlowField");
+    // sample the field where we will be, falling back on where we are
+    // (the predicted position may be off the field)
+    const Vec3 futurePosition = predictFuturePosition (predictionTime);
+    Vec3 flow = field.sampleDirection (futurePosition);
+    if (flow == Vec3::zero) flow = field.sampleDirection (position ());
+
+    // no direction to follow: no steering
+    if (flow == Vec3::zero) return Vec3::zero;
+
+    // steer to match the velocity the field asks for
+    const Vec3 desiredVelocity = flow * maxSpeed ();
+    return desiredVelocity - velocity ();
+}
+
+
 // ----------------------------------------------------------------------------
 // Obstacle Avoidance behavior
 //
@@ -524,6 +627,7 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerToAvoidObstacle (const float minTimeToCollision,
                       const Obstacle& obstacle)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToAvoidObstacle");
     const Vec3 avoidance = obstacle.steerToAvoid (*this, minTimeToCollision);
 
     // XXX more annotation modularity problems (assumes spherical obstacle)
@@ -534,10 +638,9 @@ steerToAvoidObstacle (const float minTimeToCollision,
 }
 
 
-// this version avoids all of the obstacles in an ObstacleGroup
-//
-// XXX 9-12-03: note this does NOT use the Obstacle::steerToAvoid protocol
-// XXX like the older steerToAvoidObstacle does/did.  It needs to be fixed
+// this version avoids all of the obstacles in an ObstacleGroup, using the
+// generic Obstacle::findIntersectionWithVehiclePath protocol (in batches
+// for shapes which have one, see findNearestPathIntersection)
 
 template<class Super>
 OpenSteer::Vec3
@@ -545,26 +648,14 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerToAvoidObstacles (const float minTimeToCollision,
                        const ObstacleGroup& obstacles)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToAvoidObstacles");
     Vec3 avoidance;
-    PathIntersection nearest, next;
+    Obstacle::PathIntersection nearest;
     const float minDistanceToCollision = minTimeToCollision * speed();
 
-    next.intersect = false;
-    nearest.intersect = false;
-
     // test all obstacles for intersection with my forward axis,
     // select the one whose point of intersection is nearest
-    for (ObstacleIterator o = obstacles.begin(); o != obstacles.end(); o++)
-    {
-        // xxx this should be a generic call on Obstacle, rather than
-        // xxx this code which presumes the obstacle is spherical
-        findNextIntersectionWithSphere ((SphericalObstacle&)**o, next);
-
-        if ((nearest.intersect == false) ||
-            ((next.intersect != false) &&
-             (next.distance < nearest.distance)))
-            nearest = next;
-    }
+    findNearestPathIntersection (obstacles, *this, nearest);
 
     // when a nearest intersection was found
     if ((nearest.intersect != false) &&
@@ -573,12 +664,13 @@ steerToAvoidObstacles (const float minTimeToCollision,
         // show the corridor that was checked for collisions
         annotateAvoidObstacle (minDistanceToCollision);
 
-        // compute avoidance steering force: take offset from obstacle to me,
-        // take the component of that which is lateral (perpendicular to my
-        // forward direction), set length to maxForce, add a bit of forward
-        // component (in capture the flag, we never want to slow down)
-        const Vec3 offset = position() - nearest.obstacle->center;
-        avoidance = offset.perpendicularComponent (forward());
+        // compute avoidance steering force: take the obstacle's surface
+        // normal at the point of contact (for a sphere its lateral part is
+        // that of the offset from the center to me), take the component of
+        // that which is lateral (perpendicular to my forward direction), set
+        // length to maxForce, add a bit of forward component (in capture the
+        // flag, we never want to slow down)
+        avoidance = nearest.surfaceNormal.perpendicularComponent (forward());
         avoidance = avoidance.normalize ();
         avoidance *= maxForce ();
         avoidance += forward() * maxForce () * 0.75;
@@ -588,6 +680,27 @@ steerToAvoidObstacles (const float minTimeToCollision,
 }
 
 
+// this version looks up the obstacles which may intersect the corridor
+// ahead of the vehicle (out to minTimeToCollision at its current speed)
+// and avoids those: only an obstacle intersected closer than that can
+// require avoidance, and its bounds must overlap the corridor
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerToAvoidObstacles (const float minTimeToCollision,
+                       const IndexedObstacleGroup& obstacles)
+{
+    const float minDistanceToCollision = minTimeToCollision * speed();
+    ObstacleGroup nearby;
+    obstacles.findInCorridor (position(),
+                              position() + (forward() * minDistanceToCollision),
+                              radius(),
+                              nearby);
+    return steerToAvoidObstacles (minTimeToCollision, nearby);
+}
+
+
 // ----------------------------------------------------------------------------
 // Unaligned collision avoidance behavior: avoid colliding with other nearby
 // vehicles moving in unconstrained directions.  Determine which (if any)
@@ -602,54 +715,29 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerToAvoidNeighbors (const float minTimeToCollision,
                        const AVGroup& others)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToAvoidNeighbors");
     // first priority is to prevent immediate interpenetration
     const Vec3 separation = steerToAvoidCloseNeighbors (0, others);
     if (separation != Vec3::zero) return separation;
 
     // otherwise, go on to consider potential future collisions
     float steer = 0;
-    AbstractVehicle* threat = NULL;
 
-    // Time (in seconds) until the most immediate collision threat found
-    // so far.  Initial value is a threshold: don't look more than this
-    // many frames into the future.
-    float minTime = minTimeToCollision;
+    // for each of the other vehicles, determine which (if any)
+    // pose the most immediate threat of collision.
+    float threatTime;
+    AbstractVehicle* threat = findMostImmediateThreat (minTimeToCollision,
+                                                       others,
+                                                       threatTime);
 
     // xxx solely for annotation
     Vec3 xxxThreatPositionAtNearestApproach;
     Vec3 xxxOurPositionAtNearestApproach;
-
-    // for each of the other vehicles, determine which (if any)
-    // pose the most immediate threat of collision.
-    for (AVIterator i = others.begin(); i != others.end(); i++)
+    if (threat != NULL)
     {
-        AbstractVehicle& other = **i;
-        if (&other != this)
-        {	
-            // avoid when future positions are this close (or less)
-            const float collisionDangerThreshold = radius() * 2;
-
-            // predicted time until nearest approach of "this" and "other"
-            const float time = predictNearestApproachTime (other);
-
-            // If the time is in the future, sooner than any other
-            // threatened collision...
-            if ((time >= 0) && (time < minTime))
-            {
-                // if the two will be close enough to collide,
-                // make a note of it
-                if (computeNearestApproachPositions (other, time)
-                    < collisionDangerThreshold)
-                {
-                    minTime = time;
-                    threat = &other;
-                    xxxThreatPositionAtNearestApproach
-                        = hisPositionAtNearestApproach;
-                    xxxOurPositionAtNearestApproach
-                        = ourPositionAtNearestApproach;
-                }
-            }
-        }
+        computeNearestApproachPositions (*threat, threatTime);
+        xxxThreatPositionAtNearestApproach = hisPositionAtNearestApproach;
+        xxxOurPositionAtNearestApproach = ourPositionAtNearestApproach;
     }
 
     // if a potential collision was found, compute steering to avoid
@@ -698,6 +786,117 @@ steerToAvoidNeighbors (const float minTimeToCollision,
 }
 
 
+// this version finds its own neighbors: a collision within
+// minTimeToCollision needs the two to start within the danger threshold
+// plus the distance they can close in that time
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerToAvoidNeighbors
+(const float minTimeToCollision,
+ AbstractTokenForProximityDatabase<AbstractVehicle*>& proximityToken,
+ const float maxSpeedOfOthers,
+ AVGroup& neighbors)
+{
+    const float collisionDangerThreshold = radius() * 2;
+    const float maxRelativeSpeed = speed() + maxSpeedOfOthers;
+    const float reach = (collisionDangerThreshold +
+                         (maxRelativeSpeed * minTimeToCollision));
+    neighbors.clear ();
+    proximityToken.findNeighbors (position(), reach, neighbors);
+    return steerToAvoidNeighbors (minTimeToCollision, neighbors);
+}
+
+
+// Find the most immediate collision threat.  Vehicles are taken a batch
+// ("lanes") at a time: their positions and velocities relative to mine are
+// gathered into arrays, a branch-free loop finds each one's time of nearest
+// approach (as predictNearestApproachTime) and squared distance then (as
+// computeNearestApproachPositions), then the threats are picked out in order.
+
+template<class Super>
+OpenSteer::AbstractVehicle*
+OpenSteer::SteerLibraryMixin<Super>::
+findMostImmediateThreat (const float minTimeToCollision,
+                         const AVGroup& others,
+                         float& threatTime)
+{
+    enum {lanes = 8};
+    const Vec3 myPosition = position();
+    const Vec3 myVelocity = velocity();
+
+    // avoid when future positions are this close (or less)
+    const float collisionDangerThreshold = radius() * 2;
+    const float threshold2 = square (collisionDangerThreshold);
+
+    // Time (in seconds) until the most immediate collision threat found
+    // so far.  Initial value is a threshold: don't look more than this
+    // many frames into the future.
+    AbstractVehicle* threat = NULL;
+    threatTime = minTimeToCollision;
+
+    const int count = (int) others.size ();
+    for (int first = 0; first < count; first += lanes)
+    {
+        // gather (padding unused lanes with a copy of the first)
+        const int n = ((count - first) < lanes) ? (count - first) : lanes;
+        float px[lanes], py[lanes], pz[lanes];
+        float vx[lanes], vy[lanes], vz[lanes];
+        float time[lanes], distance2[lanes];
+        for (int k = 0; k < lanes; k++)
+        {
+            const AbstractVehicle& other = *others[first + ((k < n) ? k : 0)];
+            const Vec3 relPosition = myPosition - other.position();
+            const Vec3 relVelocity = other.velocity() - myVelocity;
+            px[k] = relPosition.x;
+            py[k] = relPosition.y;
+            pz[k] = relPosition.z;
+            vx[k] = relVelocity.x;
+            vy[k] = relVelocity.y;
+            vz[k] = relVelocity.z;
+        }
+
+        // time until nearest approach (zero for parallel paths, when the
+        // distance never changes) and the squared distance at that time
+        for (int k = 0; k < lanes; k++)
+        {
+            const float relSpeed2 = ((vx[k] * vx[k]) +
+                                     (vy[k] * vy[k]) +
+                                     (vz[k] * vz[k]));
+            const float projection = ((vx[k] * px[k]) +
+                                      (vy[k] * py[k]) +
+                                      (vz[k] * pz[k]));
+            const float t = ((relSpeed2 > 0) ?
+                             projection / ((relSpeed2 > 0) ? relSpeed2 : 1) :
+                             0);
+            const float dx = px[k] - (vx[k] * t);
+            const float dy = py[k] - (vy[k] * t);
+            const float dz = pz[k] - (vz[k] * t);
+            time[k] = t;
+            distance2[k] = (dx * dx) + (dy * dy) + (dz * dz);
+        }
+
+        // If the time is in the future, sooner than any other threatened
+        // collision, and the two will be close enough to collide, make a
+        // note of it
+        for (int k = 0; k < n; k++)
+        {
+            AbstractVehicle* other = others[first + k];
+            if ((other != this) &&
+                (time[k] >= 0) &&
+                (time[k] < threatTime) &&
+                (distance2[k] < threshold2))
+            {
+                threatTime = time[k];
+                threat = other;
+            }
+        }
+    }
+    return threat;
+}
+
+
 
 // Given two vehicles, based on their current positions and velocities,
 // determine the time until nearest approach
@@ -777,6 +976,7 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerToAvoidCloseNeighbors (const float minSeparationDistance,
                             const AVGroup& others)
 {
+    OPENSTEER_PROFILE_ZONE ("steerToAvoidCloseNeighbors");
     // for each of the other vehicles...
     for (AVIterator i = others.begin(); i != others.end(); i++)    
     {
@@ -801,6 +1001,89 @@ steerToAvoidCloseNeighbors (const float minSeparationDistance,
 }
 
 
+// ----------------------------------------------------------------------------
+// Reciprocal avoidance: one ORCA line per neighbor, nearest first, then
+// the linear program for the new velocity (see ReciprocalAvoidance.h)
+
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerForReciprocalAvoidance (const float timeHorizon,
+                             const float timeStep,
+                             const Vec3& preferredVelocity,
+                             const AVGroup& others)
+{
+    OPENSTEER_PROFILE_ZONE ("steerForReciprocalAvoidance");
+    // keep the nearest others, by insertion into arrays sorted by distance
+    const AbstractVehicle* nearest[orcaMaxNeighbors];
+    float nearestDistance[orcaMaxNeighbors];
+    int count = 0;
+    for (AVIterator i = others.begin(); i != others.end(); i++)
+    {
+        const AbstractVehicle* other = *i;
+        if (other == this) continue;
+
+        const float d = (other->position() - position()).lengthSquared ();
+        if ((count == orcaMaxNeighbors) && (d >= nearestDistance[count-1]))
+            continue;
+
+        int slot = (count < orcaMaxNeighbors) ? count++ : count - 1;
+        while ((slot > 0) && (nearestDistance[slot-1] > d))
+        {
+            nearest[slot] = nearest[slot-1];
+            nearestDistance[slot] = nearestDistance[slot-1];
+            slot--;
+        }
+        nearest[slot] = other;
+        nearestDistance[slot] = d;
+    }
+
+    // one line for each of them, on the XZ plane
+    const Vec3 myVelocity (velocity().x, 0, velocity().z);
+    OrcaLine lines[orcaMaxNeighbors];
+    for (int i = 0; i < count; i++)
+    {
+        const AbstractVehicle& other = *nearest[i];
+        const Vec3 offset = other.position() - position();
+        const Vec3 otherVelocity = other.velocity();
+        makeOrcaLine (Vec3 (offset.x, 0, offset.z),
+                      Vec3 (myVelocity.x - otherVelocity.x,
+                            0,
+                            myVelocity.z - otherVelocity.z),
+                      radius() + other.radius(),
+                      myVelocity,
+                      timeHorizon,
+                      timeStep,
+                      lines[i]);
+    }
+
+    const Vec3 newVelocity = solveOrcaLines (lines, count, maxSpeed(),
+                                             preferredVelocity);
+    return (newVelocity - myVelocity) * (mass() / timeStep);
+}
+
+
+template<class Super>
+OpenSteer::Vec3
+OpenSteer::SteerLibraryMixin<Super>::
+steerForReciprocalAvoidance
+(const float timeHorizon,
+ const float timeStep,
+ const Vec3& preferredVelocity,
+ AbstractTokenForProximityDatabase<AbstractVehicle*>& proximityToken,
+ const float maxSpeedOfOthers,
+ AVGroup& neighbors)
+{
+    const float reach = ((radius() * 2) +
+                         ((maxSpeed() + maxSpeedOfOthers) * timeHorizon));
+    neighbors.clear ();
+    proximityToken.findNeighbors (position(), reach, neighbors);
+    return steerForReciprocalAvoidance (timeHorizon, timeStep,
+                                        preferredVelocity, neighbors);
+}
+
+
 // ----------------------------------------------------------------------------
 // used by boid behaviors: is a given vehicle within this boid's neighborhood?
 
@@ -857,6 +1140,7 @@ steerForSeparation (const float maxDistance,
                     const float cosMaxAngle,
                     const AVGroup& flock)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForSeparation");
     // steering accumulator and count of neighbors, both initially zero
     Vec3 steering;
     int neighbors = 0;
@@ -896,6 +1180,7 @@ steerForAlignment (const float maxDistance,
                    const float cosMaxAngle,
                    const AVGroup& flock)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForAlignment");
     // steering accumulator and count of neighbors, both initially zero
     Vec3 steering;
     int neighbors = 0;
@@ -933,6 +1218,7 @@ steerForCohesion (const float maxDistance,
                   const float cosMaxAngle,
                   const AVGroup& flock)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForCohesion");
     // steering accumulator and count of neighbors, both initially zero
     Vec3 steering;
     int neighbors = 0;
@@ -977,6 +1263,7 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerForPursuit (const AbstractVehicle& quarry,
                  const float maxPredictionTime)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForPursuit");
     // offset from this to quarry, that distance, unit vector toward quarry
     const Vec3 offset = quarry.position() - position();
     const float distance = offset.length ();
@@ -1071,6 +1358,7 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerForPursuitAndAnnotate (const AbstractVehicle& quarry,
                  const float maxPredictionTime)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForPursuit");
     // offset from this to quarry, that distance, unit vector toward quarry
     const Vec3 offset = quarry.position() - position();
     const float distance = offset.length ();
@@ -1172,6 +1460,7 @@ OpenSteer::SteerLibraryMixin<Super>::
 steerForEvasion (const AbstractVehicle& menace,
                  const float maxPredictionTime)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForEvasion");
     // offset from this to menace, that distance, unit vector toward menace
     const Vec3 offset = menace.position() - position;
     const float distance = offset.length ();
@@ -1197,6 +1486,7 @@ OpenSteer::Vec3
 OpenSteer::SteerLibraryMixin<Super>::
 steerForTargetSpeed (const float targetSpeed)
 {
+    OPENSTEER_PROFILE_ZONE ("steerForTargetSpeed");
     const float mf = maxForce ();
     const float speedError = targetSpeed - speed ();
     return forward () * clip (speedError, -mf, +mf);
@@ -0,0 +1,198 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// TiledOccupancyMap: an occupancy map too large to keep in memory, split
+// into square tiles of bit-packed cells stored in a tile file on disk.
+// The file is memory mapped (where the platform allows, else read and
+// written in place) and tiles are paged in as OccupancyGrids on demand,
+// keeping at most a given number resident, least recently used first out.
+//
+// updateWorkingSet pages in the tiles around a set of active vehicles and
+// asks the OS to read ahead the ring of tiles beyond them, so vehicles
+// moving across the map find their tiles already resident.  fillGrid
+// copies the map under an OccupancyGrid (such as MapDrive's TerrainMap)
+// so existing grid based steering can run on a window of a huge world.
+//
+// Tile file layout: a TileFileHeader at offset zero, then all tiles, row
+// of tiles by row of tiles, starting at TileFileHeader::dataOffset.  Each
+// tile is tileResolution rows of packed 64-bit words, the same layout as
+// OccupancyGrid::rowWords.  Files are native byte order.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_TILEDOCCUPANCYMAP_H
+#define OPENSTEER_TILEDOCCUPANCYMAP_H
+
+
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <vector>
+#include "OccupancyGrid.h"
+
+
+namespace OpenSteer {
+
+
+    // ----------------------------------------------------------------------------
+    // header at the start of a tile file
+
+
+    struct TileFileHeader
+    {
+        char magic[8];          // "OSTILES\0"
+        uint32_t version;       // tileFileVersion
+        uint32_t dataOffset;    // byte offset of the first tile
+        int32_t tileResolution; // cells along each side of a tile
+        int32_t tilesX;         // number of tiles along X
+        int32_t tilesZ;         // number of tiles along Z
+        float cellSize;         // size of a (square) cell
+        float originX;          // world X of the map's minimum corner
+        float originZ;          // world Z of the map's minimum corner
+        uint32_t reserved[6];
+    };
+
+    enum {tileFileVersion = 1};
+
+
+    // ----------------------------------------------------------------------------
+
+
+    class TiledOccupancyMap
+    {
+    public:
+
+        // constructor: keep at most this many tiles resident
+        TiledOccupancyMap (int residentTileCapacity = 64);
+
+        // destructor: closes the tile file (saving modified tiles)
+        ~TiledOccupancyMap ();
+
+        // create a new tile file with all cells clear (sparse where the
+        // file system allows) and open it for reading and writing
+        bool create (const char* path,
+                     const Vec3& origin,
+                     int tilesX,
+                     int tilesZ,
+                     int tileResolution,
+                     float cellSize);
+
+        // open an existing tile file
+        bool open (const char* path, bool writable);
+
+        // save modified tiles, drop all resident tiles, close the file
+        void close (void);
+
+        bool isOpen (void) const {return data != NULL || file != NULL;}
+
+        // cell at a world position (pages its tile in if needed).  Cells
+        // outside the map read as outsideValue.
+        bool getValue (const Vec3& point);
+
+        // change a cell (ignored outside the map or if opened read only)
+        void setValue (const Vec3& point, bool value);
+
+        // page in every tile within "radius" of any of the positions and
+        // hint the OS to read ahead tiles within "radius + readAheadDistance".
+        // Tiles in this working set are not evicted until the next call.
+        void updateWorkingSet (const std::vector<Vec3>& positions,
+                               float radius,
+                               float readAheadDistance);
+
+        // copy the map cells under each cell center of a grid into it
+        void fillGrid (OccupancyGrid& grid);
+
+        // save modified resident tiles to the file
+        void flush (void);
+
+        // resident tile (NULL if not resident), and map size in tiles
+        const OccupancyGrid* residentTile (int tx, int tz) const;
+        int getTilesX (void) const {return header.tilesX;}
+        int getTilesZ (void) const {return header.tilesZ;}
+        float getTileSize (void) const
+        {
+            return header.tileResolution * header.cellSize;
+        }
+
+        // cache statistics
+        int getResidentTileCount (void) const {return (int) index.size ();}
+        int getTileLoads (void) const {return tileLoads;}
+        int getTileEvictions (void) const {return tileEvictions;}
+
+        bool outsideValue;
+
+    private:
+
+        struct Tile
+        {
+            int key;             // tz * tilesX + tx
+            OccupancyGrid* grid;
+            bool dirty;
+            unsigned useStamp;   // working set stamp when last used
+        };
+
+        typedef std::list<Tile> TileList;
+        TileList tiles;                         // most recently used first
+        std::map<int, TileList::iterator> index;
+        int capacity;
+        unsigned workingSetStamp;
+        int tileLoads;
+        int tileEvictions;
+
+        // the tile file: mapped into memory, or else read through "file"
+        TileFileHeader header;
+        bool writable;
+        unsigned char* data;
+        size_t dataSize;
+        FILE* file;
+        int wordsPerTile;
+
+        // tile containing a world position, false if outside the map
+        bool tileAt (const Vec3& point, int& tx, int& tz) const;
+
+        // resident tile for a key, paging it in (and evicting) if needed
+        Tile& fetchTile (int key);
+        void evictTiles (void);
+        void loadTile (Tile& tile);
+        void saveTile (const Tile& tile);
+        void readAhead (int key);
+        size_t tileOffset (int key) const;
+
+        // not copyable
+        TiledOccupancyMap (const TiledOccupancyMap&);
+        TiledOccupancyMap& operator= (const TiledOccupancyMap&);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_TILEDOCCUPANCYMAP_H
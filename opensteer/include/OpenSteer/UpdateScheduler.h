@@ -0,0 +1,152 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// UpdateScheduler: level of detail for simulation updates.  Agents are
+// sorted into tiers by their distance to the nearest viewpoint (cameras,
+// players), or put into a tier of the caller's choosing.  Agents in the
+// nearest tier update every frame, those in further tiers every Nth frame
+// with the simulation time accumulated since their last update.  The
+// agents of a tier are spread evenly over its N frames, so the cost of a
+// frame stays level.  Plugins may also give agents in the lowest tier a
+// cheaper set of behaviors (for example no neighbor avoidance).
+//
+// In a PlugIn::update loop:
+//
+//     scheduler.beginFrame ();
+//     for (each vehicle v)
+//     {
+//         float stepTime;
+//         if (scheduler.isDue (v.schedule, v.position(), elapsedTime,
+//                              stepTime))
+//             v.update (currentTime, stepTime);
+//     }
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_UPDATESCHEDULER_H
+#define OPENSTEER_UPDATESCHEDULER_H
+
+
+#include <vector>
+#include "Vec3.h"
+
+
+namespace OpenSteer {
+
+
+    class UpdateScheduler
+    {
+    public:
+
+        // an agent's scheduling state, kept with the agent
+        class Agent
+        {
+        public:
+            Agent (void) : tier (0), forcedTier (-1), slot (-1),
+                           pendingTime (0) {}
+
+            // tier the agent was last scheduled in
+            int tier;
+
+            // tier to use whatever its distance (for example 0 for the
+            // player's own character), -1 to go by distance
+            int forcedTier;
+
+            // (internal) spreads a tier's agents over its frames
+            int slot;
+
+            // simulation time not yet handed to an update
+            float pendingTime;
+        };
+
+        // constructor: a single tier, updating every frame
+        UpdateScheduler (void);
+
+        // tiers, nearest first: an agent further than the previous tier's
+        // maxDistance from every viewpoint, but within this one's of some
+        // viewpoint, updates every "interval" frames.  The last tier also
+        // takes all agents beyond its maxDistance.
+        void clearTiers (void);
+        void addTier (const float maxDistance, const int interval);
+        int getTierCount (void) const {return (int) tiers.size ();}
+        int getLowestTier (void) const {return getTierCount () - 1;}
+        int getInterval (const int tier) const {return tiers[tier].interval;}
+
+        // points distances are measured from (none: all in the first tier)
+        void clearViewpoints (void) {viewpoints.clear ();}
+        void addViewpoint (const Vec3& p) {viewpoints.push_back (p);}
+
+        // start a frame of updates
+        void beginFrame (void);
+
+        // schedule an agent for this frame: assign its tier and add
+        // elapsedTime to its pending time.  Returns true when the agent
+        // should update this frame, with stepTime set to the pending time
+        // (which is then cleared).
+        bool isDue (Agent& agent,
+                    const Vec3& position,
+                    const float elapsedTime,
+                    float& stepTime);
+
+        // tier for a position, by distance to the nearest viewpoint
+        int tierForPosition (const Vec3& position) const;
+
+        // agents scheduled into and updated in a tier this frame
+        int getScheduledCount (const int tier) const
+        {
+            return tiers[tier].scheduled;
+        }
+        int getUpdatedCount (const int tier) const
+        {
+            return tiers[tier].updated;
+        }
+
+    private:
+
+        struct Tier
+        {
+            float maxDistanceSquared;
+            int interval;
+            int scheduled;
+            int updated;
+        };
+
+        std::vector<Tier> tiers;
+        std::vector<Vec3> viewpoints;
+        unsigned frame;
+        int nextSlot;
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_UPDATESCHEDULER_H
@@ -42,9 +42,11 @@
 
 
 #include <iostream>  // for ostream, <<, etc.
-#include <cstdlib>   // for rand, etc.
+#include <cstdlib>   // for abs, etc.
 #include <cfloat>    // for FLT_MAX, etc.
 #include <cmath>     // for sqrt, etc.
+#include <stdint.h>  // for uint64_t
+#include <atomic>    // for seeding per thread random streams
 
 
 // ----------------------------------------------------------------------------
@@ -72,11 +74,70 @@ namespace OpenSteer {
     // Random number utilities
 
 
+    // A stream of random numbers (SplitMix64).  Each number is a hash of a
+    // counter, so the whole state is 64 bits and streams with different
+    // seeds are unrelated.  Each vehicle keeps its own, seeded with its
+    // serial number, so its random choices do not depend on the order or
+    // thread in which vehicles are updated.
+
+    class RandomStream
+    {
+    public:
+
+        RandomStream (uint64_t seed = 0) {setSeed (seed);}
+
+        // start over: the same seed always gives the same numbers
+        void setSeed (uint64_t seed) {counter = mix (seed);}
+
+        // next 64 random bits
+        uint64_t next (void)
+        {
+            counter += 0x9E3779B97F4A7C15ULL;
+            return mix (counter);
+        }
+
+        // a float randomly distributed between 0 and 1 (24 random bits)
+        float frandom01 (void)
+        {
+            return ((float) (next () >> 40)) * (1.0f / 16777216.0f);
+        }
+
+        // a float randomly distributed between lowerBound and upperBound
+        float frandom2 (float lowerBound, float upperBound)
+        {
+            return lowerBound + (frandom01 () * (upperBound - lowerBound));
+        }
+
+    private:
+
+        static uint64_t mix (uint64_t z)
+        {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        uint64_t counter;
+    };
+
+
+    // The random stream of the calling thread, for random numbers which do
+    // not belong to a vehicle.  Threads are given seeds 0, 1, 2... in the
+    // order they first ask, so the main thread's numbers are repeatable.
+
+    inline RandomStream& threadRandomStream (void)
+    {
+        static std::atomic<uint64_t> threadCount (0);
+        static thread_local RandomStream stream (threadCount++);
+        return stream;
+    }
+
+
     // Returns a float randomly distributed between 0 and 1
 
     inline float frandom01 (void)
     {
-        return (((float) rand ()) / ((float) RAND_MAX));
+        return threadRandomStream().frandom01 ();
     }
 
 
@@ -84,7 +145,7 @@ namespace OpenSteer {
 
     inline float frandom2 (float lowerBound, float upperBound)
     {
-        return lowerBound + (frandom01 () * (upperBound - lowerBound));
+        return threadRandomStream().frandom2 (lowerBound, upperBound);
     }
 
 
@@ -158,14 +219,25 @@ namespace OpenSteer {
     inline float scalarRandomWalk (const float initial, 
                                    const float walkspeed,
                                    const float min,
-                                   const float max)
+                                   const float max,
+                                   RandomStream& random)
     {
-        const float next = initial + (((frandom01() * 2) - 1) * walkspeed);
+        const float step = (random.frandom01() * 2) - 1;
+        const float next = initial + (step * walkspeed);
         if (next < min) return min;
         if (next > max) return max;
         return next;
     }
 
+    inline float scalarRandomWalk (const float initial, 
+                                   const float walkspeed,
+                                   const float min,
+                                   const float max)
+    {
+        return scalarRandomWalk (initial, walkspeed, min, max,
+                                 threadRandomStream ());
+    }
+
 
     // ----------------------------------------------------------------------------
 
@@ -241,8 +241,12 @@ namespace OpenSteer {
     // Returns a position randomly distributed inside a sphere of unit radius
     // centered at the origin.  Orientation will be random and length will range
     // between 0 and 1
+    //
+    // (these random vector functions draw on the given RandomStream, or by
+    // default the calling thread's)
 
 
+    Vec3 RandomVectorInUnitRadiusSphere (RandomStream& random);
     Vec3 RandomVectorInUnitRadiusSphere (void);
 
 
@@ -252,6 +256,7 @@ namespace OpenSteer {
     // random and length will range between 0 and 1
 
 
+    Vec3 randomVectorOnUnitRadiusXZDisk (RandomStream& random);
     Vec3 randomVectorOnUnitRadiusXZDisk (void);
 
 
@@ -261,6 +266,11 @@ namespace OpenSteer {
     // and length will be 1
 
 
+    inline Vec3 RandomUnitVector (RandomStream& random)
+    {
+        return RandomVectorInUnitRadiusSphere (random).normalize();
+    }
+
     inline Vec3 RandomUnitVector (void)
     {
         return RandomVectorInUnitRadiusSphere().normalize();
@@ -273,6 +283,11 @@ namespace OpenSteer {
     // random and length will be 1
 
 
+    inline Vec3 RandomUnitVectorOnXZPlane (RandomStream& random)
+    {
+        return RandomVectorInUnitRadiusSphere (random).setYtoZero().normalize();
+    }
+
     inline Vec3 RandomUnitVectorOnXZPlane (void)
     {
         return RandomVectorInUnitRadiusSphere().setYtoZero().normalize();
@@ -0,0 +1,131 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// WorkerPool: a few threads which run the items of a job in parallel,
+// for simulation steps where each vehicle's work is independent of the
+// others (each vehicle reads shared data such as a map, and writes only
+// its own state).
+//
+// parallelFor divides the items [0, count) into chunks, hands them out to
+// the worker threads and the calling thread alike, and returns once every
+// item is done.  Jobs run one at a time: calls from several threads queue.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OPENSTEER_WORKERPOOL_H
+#define OPENSTEER_WORKERPOOL_H
+
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace OpenSteer {
+
+
+    class WorkerPool
+    {
+    public:
+
+        // a job: run items begin through end - 1.  Called concurrently
+        // from several threads, for disjoint ranges of items.
+        class Job
+        {
+        public:
+            virtual ~Job () {}
+            virtual void run (int begin, int end) = 0;
+        };
+
+        // constructor: start this many worker threads (by default one
+        // fewer than the hardware threads, the caller being the last)
+        WorkerPool (int workerThreadCount = -1);
+
+        // destructor: stops the worker threads
+        ~WorkerPool ();
+
+        // run all items of a job, chunkSize items at a time
+        void parallelFor (int count, int chunkSize, Job& job);
+
+        // threads which take part in a job, including the caller
+        int getThreadCount (void) const {return 1 + (int) threads.size ();}
+
+        // total time the worker threads (not callers) have spent running
+        // jobs.  Sampled twice, the difference over the real time between
+        // the samples (times the worker count) gives their utilization.
+        double getWorkerBusySeconds (void) const
+        {
+            return busyNanoseconds.load (std::memory_order_relaxed) * 1e-9;
+        }
+
+        // pool shared by the whole library, started on first use
+        static WorkerPool& shared (void);
+
+        // the shared pool if something has started it, otherwise NULL
+        // (for statistics, which should not start it)
+        static WorkerPool* sharedIfStarted (void);
+
+    private:
+
+        void workerLoop (void);
+        void runChunks (void);
+
+        std::vector<std::thread> threads;
+
+        // current job, guarded by "mutex" (nextItem is claimed atomically)
+        std::mutex mutex;
+        std::mutex jobMutex;            // one job at a time
+        std::condition_variable wake;   // a job was posted, or quit
+        std::condition_variable done;   // the last worker finished
+        Job* job;
+        int itemCount;
+        int chunk;
+        std::atomic<int> nextItem;
+        int busyWorkers;
+        unsigned generation;
+        bool quit;
+
+        std::atomic<int64_t> busyNanoseconds;
+        static std::atomic<WorkerPool*> sharedPool;
+
+        // not copyable
+        WorkerPool (const WorkerPool&);
+        WorkerPool& operator= (const WorkerPool&);
+    };
+
+} // namespace OpenSteer
+
+
+// ----------------------------------------------------------------------------
+#endif // OPENSTEER_WORKERPOOL_H
@@ -37,8 +37,13 @@
 
 
 #include <sstream>
+#include <vector>
 #include "OpenSteer/SimpleVehicle.h"
+#include "OpenSteer/QuaternionLocalSpace.h"
 #include "OpenSteer/Proximity.h"
+#include "OpenSteer/ObjectPool.h"
+#include "OpenSteer/MortonOrder.h"
+#include "OpenSteer/NeighborList.h"
 #include "OpenSteer/App.h"
 
 
@@ -72,11 +77,35 @@ public:
         proximityToken = NULL;
         newPD (pd);
 
+        // no handle until added to a flock
+        handle = -1;
+
         // reset all boid state
         reset ();
     }
 
 
+    // copy constructor: the copy is not in a proximity database
+    Boid (const Boid& other)
+        : SimpleVehicle (other)
+    {
+        proximityToken = NULL;
+        handle = other.handle;
+    }
+
+
+    // assignment takes on the other boid's state but keeps this boid's
+    // proximity token, which moves to the new position (so boids can be
+    // moved between storage slots, see reorderByMortonCode)
+    Boid& operator= (const Boid& other)
+    {
+        SimpleVehicle::operator= (other);
+        handle = other.handle;
+        if (proximityToken) proximityToken->updateForNewPosition (position());
+        return *this;
+    }
+
+
     // destructor
     ~Boid ()
     {
@@ -101,10 +130,10 @@ public:
         setSpeed (maxSpeed() * 0.3f);
 
         // randomize initial orientation
-        regenerateOrthonormalBasisUF (RandomUnitVector ());
+        regenerateOrthonormalBasisUF (RandomUnitVector (randomStream));
 
         // randomize initial position
-        setPosition (RandomVectorInUnitRadiusSphere () * 20);
+        setPosition (RandomVectorInUnitRadiusSphere (randomStream) * 20);
 
         // notify proximity database that our position has changed
         proximityToken->updateForNewPosition (position());
@@ -122,7 +151,10 @@ public:
     void update (const float currentTime, const float elapsedTime)
     {
         // steer to flock and perhaps to stay within the spherical boundary
+        const Vec3 oldPosition = position ();
         applySteeringForce (steerToFlock () + handleBoundary(), elapsedTime);
+        if (useNeighborLists)
+            neighborCache.noteMoved (neighborList, oldPosition, position());
 
         // notify proximity database that our position has changed
         proximityToken->updateForNewPosition (position());
@@ -149,8 +181,13 @@ public:
                                                 cohesionRadius));
 
         // find all flockmates within maxRadius using proximity database
+        // (or the cached neighbor list)
         neighbors.clear();
-        proximityToken->findNeighbors (position(), maxRadius, neighbors);
+        if (useNeighborLists)
+            neighborCache.findNeighbors (neighborList, *proximityToken,
+                                         position(), maxRadius, neighbors);
+        else
+            proximityToken->findNeighbors (position(), maxRadius, neighbors);
 
         // determine each of the three component behaviors of flocking
         const Vec3 separation = steerForSeparation (separationRadius,
@@ -237,6 +274,16 @@ public:
     // a pointer to this boid's interface object for the proximity database
     ProximityToken* proximityToken;
 
+    // stable handle, which follows the boid when its storage is reordered
+    int handle;
+
+    // flockmates found by an earlier query, reused while valid
+    NeighborList neighborList;
+
+    // reuse neighbor queries across frames? (shared by all boids)
+    static bool useNeighborLists;
+    static NeighborListCache neighborCache;
+
     // allocate one and share amoung instances just to save memory usage
     // (change to per-instance allocation to be more MP-safe)
     static AVGroup neighbors;
@@ -246,10 +293,53 @@ public:
 
 
 AVGroup Boid::neighbors;
+bool Boid::useNeighborLists = false;
+NeighborListCache Boid::neighborCache;
 float Boid::worldRadius = 50.0;
 int Boid::boundaryCondition = 0;
 
 
+// ----------------------------------------------------------------------------
+// the local space part of SimpleVehicle::applySteeringForce, for the local
+// space benchmark (F5): each step a steering force given in local terms
+// moves every agent and regenerates its basis from the new velocity.
+// Returns the seconds taken.
+
+
+template <class Space>
+float timeLocalSpaceSteps (Clock& clock, const int count, const int steps)
+{
+    const float elapsedTime = 1.0f / 60;
+    const float maxSpeed = 9;
+    std::vector<Space> spaces (count);
+    std::vector<float> speeds (count, maxSpeed / 2);
+    for (int i = 0; i < count; i++)
+    {
+        spaces[i].setPosition (RandomVectorInUnitRadiusSphere () * 50);
+        spaces[i].regenerateOrthonormalBasisUF (RandomUnitVector ());
+    }
+
+    const double start = clock.realTimeSinceFirstClockUpdate ();
+    for (int s = 0; s < steps; s++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Space& space = spaces[i];
+            const Vec3 steering = space.globalizeDirection (Vec3 (2, 1, 3));
+            const Vec3 velocity = space.forward () * speeds[i];
+            const Vec3 newVelocity =
+                (velocity + (steering * elapsedTime)).truncateLength (maxSpeed);
+            speeds[i] = newVelocity.length ();
+            space.setPosition (space.position () + (newVelocity * elapsedTime));
+            if (speeds[i] > 0)
+                space.regenerateOrthonormalBasisUF (newVelocity / speeds[i]);
+        }
+    }
+    const double end = clock.realTimeSinceFirstClockUpdate ();
+    return (float) (end - start);
+}
+
+
 // ----------------------------------------------------------------------------
 // PlugIn for OpenSteer::App
 
@@ -270,6 +360,10 @@ public:
         cyclePD = -1;
         nextPD ();
 
+        // storage is reordered only when asked for (F6)
+        mortonOrder = false;
+        framesSinceReorder = 0;
+
         // make default-sized flock
         population = 0;
         for (int i = 0; i < 200; i++) addBoidToFlock ();
@@ -286,6 +380,17 @@ public:
 
     void update (const float currentTime, const float elapsedTime)
     {
+        // now and then put boids near each other in space near each other
+        // in memory
+        const int reorderInterval = 60;
+        if (mortonOrder && (++framesSinceReorder >= reorderInterval))
+        {
+            reorderFlock ();
+            framesSinceReorder = 0;
+        }
+
+        if (Boid::useNeighborLists) Boid::neighborCache.beginFrame ();
+
         // update flock simulation for each boid
         for (iterator i = flock.begin(); i != flock.end(); i++)
         {
@@ -323,6 +428,14 @@ public:
             case 0: status << "steer back when outside"; break;
             case 1: status << "wrap around (teleport)";  break;
         }
+        status << "\n[F6]    Storage: ";
+        status << (mortonOrder ? "reordered by Morton code" : "spawn order");
+        status << "\n[F8]    Neighbor lists: ";
+        if (Boid::useNeighborLists)
+            status << Boid::neighborCache.getRebuildCount () << " of "
+                   << Boid::neighborCache.getQueryCount () << " rebuilt";
+        else
+            status << "off";
         status << std::endl;
         const Vec3 screenLocation (10, 50, 0);
         Draw::drawTextAt2dLocation (status, screenLocation, gGray80);
@@ -342,6 +455,7 @@ public:
     {
         // reset each boid in flock
         for (iterator i = flock.begin(); i != flock.end(); i++) (**i).reset();
+        Boid::neighborCache.invalidate ();
 
         // reset camera position
         OpenSteer::App::get_singleton()->position3dCamera (*OpenSteer::App::get_singleton()->selectedVehicle);
@@ -395,6 +509,10 @@ public:
         case 2:  removeBoidFromFlock ();          break;
         case 3:  nextPD ();                       break;
         case 4:  Boid::nextBoundaryCondition ();  break;
+        case 5:  runLocalSpaceBenchmark ();       break;
+        case 6:  toggleMortonOrder ();            break;
+        case 7:  runLargeFlockBenchmark ();       break;
+        case 8:  toggleNeighborLists ();          break;
         }
     }
 
@@ -408,14 +526,20 @@ public:
         OpenSteer::App::get_singleton()->printMessage ("  F2     remove a boid from the flock.");
         OpenSteer::App::get_singleton()->printMessage ("  F3     use next proximity database.");
         OpenSteer::App::get_singleton()->printMessage ("  F4     next flock boundary condition.");
+        OpenSteer::App::get_singleton()->printMessage ("  F5     benchmark basis vector and quaternion local spaces.");
+        OpenSteer::App::get_singleton()->printMessage ("  F6     toggle reordering boid storage by Morton code.");
+        OpenSteer::App::get_singleton()->printMessage ("  F7     benchmark storage order and neighbor lists, 50000 boids.");
+        OpenSteer::App::get_singleton()->printMessage ("  F8     toggle reusing neighbor queries (Verlet lists).");
         OpenSteer::App::get_singleton()->printMessage ("");
     }
 
     void addBoidToFlock (void)
     {
         population++;
-        Boid* boid = new Boid (*pd);
+        Boid* boid = boidPool.spawn (*pd);
         flock.push_back (boid);
+        handles.add (boid);
+        Boid::neighborCache.invalidate ();
         if (population == 1) OpenSteer::App::get_singleton()->selectedVehicle = boid;
     }
 
@@ -424,7 +548,7 @@ public:
         if (population > 0)
         {
             // save a pointer to the last boid, then remove it from the flock
-            const Boid* boid = flock.back();
+            Boid* boid = flock.back();
             flock.pop_back();
             population--;
 
@@ -432,11 +556,179 @@ public:
             if (boid == OpenSteer::App::get_singleton()->selectedVehicle)
                 OpenSteer::App::get_singleton()->selectedVehicle = NULL;
 
-            // delete the Boid
-            delete boid;
+            // delete the Boid (freeing its slot for the next one)
+            handles.remove (boid);
+            boidPool.despawn (boid);
+            Boid::neighborCache.invalidate ();
         }
     }
 
+    // time the local space part of applySteeringForce with the usual three
+    // basis vectors and with a packed quaternion (as SimpleVehicle uses
+    // with OPENSTEER_PACKED_LOCAL_SPACE) and print nanoseconds per agent
+    // step for increasing numbers of agents
+    void runLocalSpaceBenchmark (void)
+    {
+        App& app = *OpenSteer::App::get_singleton();
+        const int counts[] = {10000, 100000, 1000000};
+        const int countCount = sizeof (counts) / sizeof (counts[0]);
+        const int agentSteps = 4000000;
+
+        std::ostringstream header;
+        header << name() << ": local space nanoseconds per agent step, "
+               << "basis vectors (" << sizeof (LocalSpace) << " bytes) / "
+               << "quaternion (" << sizeof (QuaternionLocalSpace)
+               << " bytes)" << std::ends;
+        app.printMessage (header);
+
+        for (int c = 0; c < countCount; c++)
+        {
+            const int count = counts[c];
+            const int steps = agentSteps / count;
+            const float basis =
+                timeLocalSpaceSteps<LocalSpace> (app.clock, count, steps);
+            const float packed =
+                timeLocalSpaceSteps<QuaternionLocalSpace> (app.clock,
+                                                           count, steps);
+            const float scale = 1e9f / (count * (float) steps);
+
+            std::ostringstream message;
+            message << "  " << count << " agents: " << basis * scale
+                    << " / " << packed * scale << std::ends;
+            app.printMessage (message);
+        }
+    }
+
+    // reorder the flock's storage by the Morton codes of the boids'
+    // positions, keeping the same boid selected
+    void reorderFlock (void)
+    {
+        App& app = *OpenSteer::App::get_singleton();
+        const int selected = (app.selectedVehicle == NULL) ? -1 :
+            static_cast<Boid*> (app.selectedVehicle)->handle;
+
+        const float r = Boid::worldRadius * 1.1f;
+        reorderByMortonCode (flock,
+                             Vec3 (-r, -r, -r),
+                             Vec3 (r * 2, r * 2, r * 2),
+                             handles);
+
+        if (selected != -1) app.selectedVehicle = handles.get (selected);
+
+        // neighbor lists refer to storage slots
+        Boid::neighborCache.invalidate ();
+    }
+
+    void toggleNeighborLists (void)
+    {
+        Boid::useNeighborLists = !Boid::useNeighborLists;
+        Boid::neighborCache.invalidate ();
+    }
+
+    void toggleMortonOrder (void)
+    {
+        mortonOrder = !mortonOrder;
+        framesSinceReorder = 0;
+        if (mortonOrder) reorderFlock ();
+    }
+
+    // time flock updates for a large flock (spread out to the default
+    // flock's density) in spawn order, then after reordering its storage
+    // by Morton code, then reusing neighbor queries as well.  Besides
+    // milliseconds per update it prints the mean distance in memory from a
+    // boid to its neighbors, which is what decides how many of their cache
+    // lines are shared.
+    void runLargeFlockBenchmark (void)
+    {
+        App& app = *OpenSteer::App::get_singleton();
+        const int count = 50000;
+        const int frames = 10;
+        const float elapsedTime = 1.0f / 60;
+        const float neighborRadius = 9;
+
+        // 200 boids in a sphere of radius 20, scaled up to count boids
+        const float radius = 20 * powf (count / 200.0f, 1.0f / 3);
+        const float savedWorldRadius = Boid::worldRadius;
+        const bool savedNeighborLists = Boid::useNeighborLists;
+        Boid::worldRadius = radius;
+
+        const float r = radius * 1.1f;
+        const float div = ceilf ((r * 2) / neighborRadius);
+        typedef LQProximityDatabase<AbstractVehicle*> LQPDAV;
+        LQPDAV database (Vec3::zero,
+                         Vec3 (r * 2, r * 2, r * 2),
+                         Vec3 (div, div, div));
+        ObjectPool<Boid> pool (1024);
+        AgentHandles<Boid> benchmarkHandles;
+        std::vector<Boid*> boids (count);
+        for (int i = 0; i < count; i++)
+        {
+            boids[i] = pool.spawn (database);
+            boids[i]->setPosition (RandomVectorInUnitRadiusSphere () * radius);
+            boids[i]->proximityToken->updateForNewPosition (boids[i]->position());
+            benchmarkHandles.add (boids[i]);
+        }
+
+        std::ostringstream header;
+        header << name() << ": " << count << " boids, milliseconds per "
+               << "update (mean memory distance to neighbors)" << std::ends;
+        app.printMessage (header);
+
+        const char* const runNames[] = {"spawn order:                 ",
+                                        "Morton order:                ",
+                                        "Morton order, neighbor lists:"};
+        for (int run = 0; run < 3; run++)
+        {
+            Boid::useNeighborLists = (run == 2);
+            Boid::neighborCache.invalidate ();
+            if (run == 1)
+                reorderByMortonCode (boids,
+                                     Vec3 (-r, -r, -r),
+                                     Vec3 (r * 2, r * 2, r * 2),
+                                     benchmarkHandles);
+
+            // how far apart in memory are neighbors?
+            double distance = 0;
+            int pairs = 0;
+            AVGroup neighbors;
+            for (int i = 0; i < count; i++)
+            {
+                neighbors.clear ();
+                boids[i]->proximityToken->findNeighbors (boids[i]->position(),
+                                                         neighborRadius,
+                                                         neighbors);
+                const char* a = (const char*) boids[i];
+                for (AVIterator n = neighbors.begin(); n != neighbors.end(); n++)
+                {
+                    const char* b = (const char*) static_cast<Boid*> (*n);
+                    distance += (a < b) ? (b - a) : (a - b);
+                }
+                pairs += (int) neighbors.size ();
+            }
+
+            const double start = app.clock.realTimeSinceFirstClockUpdate ();
+            for (int f = 0; f < frames; f++)
+            {
+                if (Boid::useNeighborLists) Boid::neighborCache.beginFrame ();
+                for (int i = 0; i < count; i++)
+                    boids[i]->update (0, elapsedTime);
+            }
+            const double end = app.clock.realTimeSinceFirstClockUpdate ();
+
+            std::ostringstream message;
+            message << "  " << runNames[run] << " "
+                    << (float) ((end - start) * 1000 / frames) << " ("
+                    << (int) (distance / maxXXX (pairs, 1) / 1024) << " KB)"
+                    << std::ends;
+            app.printMessage (message);
+        }
+
+        for (int i = 0; i < count; i++) pool.despawn (boids[i]);
+        Boid::worldRadius = savedWorldRadius;
+        Boid::useNeighborLists = savedNeighborLists;
+        Boid::neighborCache.invalidate ();
+    }
+
     // return an AVGroup containing each boid of the flock
     const AVGroup& allVehicles (void) {return (const AVGroup&)flock;}
     // flock: a group (STL vector) of pointers to all boids
@@ -448,6 +740,13 @@ public:
     int population;
     // which of the various proximity databases is currently in use
     int cyclePD;
+    // storage for the boids, reused as they come and go
+    ObjectPool<Boid> boidPool;
+    // handles which follow boids as their storage is reordered
+    AgentHandles<Boid> handles;
+    // periodically reorder storage by Morton code? (F6)
+    bool mortonOrder;
+    int framesSinceReorder;
 };
 
 
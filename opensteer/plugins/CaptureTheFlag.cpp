@@ -103,10 +103,11 @@ public:
     static void initializeObstacles (void);
     static void addOneObstacle (void);
     static void removeOneObstacle (void);
-    float minDistanceToObstacle (const Vec3 point);
+    float minDistanceToObstacle (const Vec3 point, const float range);
     static int obstacleCount;
     static const int maxObstacleCount;
     static SOG allObstacles;
+    static IndexedObstacleGroup obstacleIndex; // same obstacles, indexed
 };
 
 
@@ -257,12 +258,14 @@ void CtfBase::randomizeStartingPositionAndHeading (void)
 {
     // randomize position on a ring between inner and outer radii
     // centered around the home base
-    const float rRadius = frandom2 (gMinStartRadius, gMaxStartRadius);
-    const Vec3 randomOnRing = RandomUnitVectorOnXZPlane () * rRadius;
+    const float rRadius = randomStream.frandom2 (gMinStartRadius,
+                                                 gMaxStartRadius);
+    const Vec3 randomOnRing = (RandomUnitVectorOnXZPlane (randomStream) *
+                               rRadius);
     setPosition (gHomeBaseCenter + randomOnRing);
 
     // are we are too close to an obstacle?
-    if (minDistanceToObstacle (position()) < radius()*5)
+    if (minDistanceToObstacle (position(), radius()*5) < radius()*5)
     {
         // if so, retry the randomization (this recursive call may not return
         // if there is too little free space)
@@ -296,7 +299,7 @@ void CtfEnemy::update (const float currentTime, const float elapsedTime)
     {
         const Vec3 avoidance =
             steerToAvoidObstacles (gAvoidancePredictTimeMin,
-                                   (ObstacleGroup&) allObstacles);
+                                   obstacleIndex);
 
         // saved for annotation
         avoiding = (avoidance == Vec3::zero);
@@ -545,7 +548,7 @@ Vec3 CtfSeeker::steeringForSeeker (void)
     adjustObstacleAvoidanceLookAhead (clearPath);
     const Vec3 obstacleAvoidance =
         steerToAvoidObstacles (gAvoidancePredictTime,
-                               (ObstacleGroup&) allObstacles);
+                               obstacleIndex);
 
     // saved for annotation
     avoiding = (obstacleAvoidance != Vec3::zero);
@@ -736,6 +739,7 @@ void CtfSeeker::update (const float currentTime, const float elapsedTime)
 
 int CtfBase::obstacleCount = -1; // this value means "uninitialized"
 SOG CtfBase::allObstacles;
+IndexedObstacleGroup CtfBase::obstacleIndex;
 
 
 #define testOneObstacleOverlap(radius, center)               \
@@ -773,9 +777,15 @@ void CtfBase::addOneObstacle (void)
             c = randomVectorOnUnitRadiusXZDisk () * gMaxStartRadius * 1.1f;
             minClearance = FLT_MAX;
 
-            for (SOI so = allObstacles.begin(); so != allObstacles.end(); so++)
+            // only obstacles within the required clearance can overlap
+            const float reach = r + requiredClearance;
+            const Vec3 box (reach, reach, reach);
+            ObstacleGroup nearby;
+            obstacleIndex.findInBox (c - box, c + box, nearby);
+            for (ObstacleIterator o = nearby.begin(); o != nearby.end(); o++)
             {
-                testOneObstacleOverlap ((**so).radius, (**so).center);
+                const SphericalObstacle& so = *(SphericalObstacle*) *o;
+                testOneObstacleOverlap (so.radius, so.center);
             }
 
             testOneObstacleOverlap (gHomeBaseRadius - requiredClearance,
@@ -784,20 +794,28 @@ void CtfBase::addOneObstacle (void)
         while (minClearance < requiredClearance);
 
         // add new non-overlapping obstacle to registry
-        allObstacles.push_back (new SphericalObstacle (r, c));
+        SphericalObstacle* so = new SphericalObstacle (r, c);
+        allObstacles.push_back (so);
+        obstacleIndex.add (so);
         obstacleCount++;
     }
 }
 
 
-float CtfBase::minDistanceToObstacle (const Vec3 point)
+// (obstacles farther than "range" from the point are not considered:
+// returns FLT_MAX if there are none closer)
+float CtfBase::minDistanceToObstacle (const Vec3 point, const float range)
 {
     float r = 0;
     Vec3 c = point;
     float minClearance = FLT_MAX;
-    for (SOI so = allObstacles.begin(); so != allObstacles.end(); so++)
+    const Vec3 box (range, range, range);
+    ObstacleGroup nearby;
+    obstacleIndex.findInBox (c - box, c + box, nearby);
+    for (ObstacleIterator o = nearby.begin(); o != nearby.end(); o++)
     {
-        testOneObstacleOverlap ((**so).radius, (**so).center);
+        const SphericalObstacle& so = *(SphericalObstacle*) *o;
+        testOneObstacleOverlap (so.radius, so.center);
     }
     return minClearance;
 }
@@ -808,6 +826,7 @@ void CtfBase::removeOneObstacle (void)
     if (obstacleCount > 0)
     {
         obstacleCount--;
+        obstacleIndex.remove (allObstacles.back());
         allObstacles.pop_back();
     }
 }
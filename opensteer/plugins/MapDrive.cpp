@@ -42,6 +42,10 @@
 // simulation is restarted.  (This plug-in includes two non-path-following
 // demos of map-based obstacle avoidance.  Use F1 to select among them.)
 //
+// Any number of drivers (F7) can share one map and route, which are
+// immutable and reference counted.  The camera follows the first driver,
+// the others are updated in parallel on a WorkerPool.
+//
 // 08-16-04 cwr: merge back into OpenSteer code base
 // 10-15-03 cwr: created 
 //
@@ -51,8 +55,13 @@
 
 #include "OpenSteer/App.h"
 #include "OpenSteer/SimpleVehicle.h"
+#include "OpenSteer/OccupancyGrid.h"
+#include "OpenSteer/WorkerPool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <cassert>
 
@@ -64,19 +73,15 @@ using namespace OpenSteer;
 
 
 // class BinaryTerrainMap : public TerrainMap
-class TerrainMap
+// (cells are kept bit-packed by OccupancyGrid)
+class TerrainMap : public OccupancyGrid
 {
 public:
 
     // constructor
     TerrainMap (const Vec3& c, float x, float z, int r)
-        : center(c),
-          xSize(x),
-          zSize(z),
-          resolution(r),
-          outsideValue (false)
+        : OccupancyGrid (c, x, z, r)
     {
-        map.reserve (resolution * resolution);
     }
 
     // destructor
@@ -84,52 +89,24 @@ public:
     {
     }
 
-    // clear the map (to false)
-    void clear (void)
-    {
-        for (int i = 0; i < resolution; i++)
-            for (int j = 0; j < resolution; j++)
-                setMapBit (i, j, 0);
-    }
-
 
     // get and set a bit based on 2d integer map index
     bool getMapBit (int i, int j) const
     {
-        return map[mapAddress(i, j)];
+        return getBit (i, j);
     }
 
     bool setMapBit (int i, int j, bool value)
     {
-        return map[mapAddress(i, j)] = value;
+        setBit (i, j, value);
+        return value;
     }
 
 
     // get a value based on a position in 3d world space
     bool getMapValue (const Vec3& point) const
     {
-        const Vec3 local = point - center;
-        const Vec3 localXZ = local.setYtoZero();
-
-        const float hxs = xSize/2;
-        const float hzs = zSize/2;
-
-        const float x = localXZ.x;
-        const float z = localXZ.z;
-
-        const bool out = (x > +hxs) || (x < -hxs) || (z > +hzs) || (z < -hzs);
-
-        if (out) 
-        {
-            return outsideValue;
-        }
-        else
-        {
-            const float r = (float) resolution; // prevent VC7.1 warning
-            const int i = (int) remapInterval (x, -hxs, hxs, 0.0f, r);
-            const int j = (int) remapInterval (z, -hzs, hzs, 0.0f, r);
-            return getMapBit (i, j);
-        }
+        return getValue (point);
     }
 
 
@@ -176,66 +153,46 @@ public:
     }
 
 
-    float minSpacing (void) const
-    {
-        return minXXX (xSize, zSize) / (float)resolution;
-    }
-
-    // used to detect if vehicle body is on any obstacles
+    // used to detect if vehicle body is on any obstacles: tests the map
+    // cells under the rectangle a row span at a time
     bool scanLocalXZRectangle (const AbstractLocalSpace& localSpace,
                                float xMin, float xMax,
                                float zMin, float zMax) const
     {
-        const float spacing = minSpacing() / 2;
-
-        for (float x = xMin; x < xMax; x += spacing)
+        const Vec3 corners[4] =
         {
-            for (float z = zMin; z < zMax; z += spacing)
-            {
-                const Vec3 sample (x, 0, z);
-                const Vec3 global = localSpace.globalizePosition (sample);
-                if (getMapValue (global)) return true;
-            }
-        }
-        return false;
-    }
-
-    // Scans along a ray (directed line segment) on the XZ plane, sampling
-    // the map for a "true" cell.  Returns the index of the first sample
-    // that gets a "hit", or zero if no hits found.
+            localSpace.globalizePosition (Vec3 (xMin, 0, zMin)),
+            localSpace.globalizePosition (Vec3 (xMax, 0, zMin)),
+            localSpace.globalizePosition (Vec3 (xMax, 0, zMax)),
+            localSpace.globalizePosition (Vec3 (xMin, 0, zMax)),
+        };
+        return anyInXZPolygon (corners, 4);
+    }
+
+    // Scans along a ray (directed line segment) on the XZ plane, looking
+    // in the map for a "true" cell.  Returns the index of the first sample
+    // point at or beyond where the ray enters that cell, or zero if no hits
+    // found.  The ray is walked cell by cell (scanXZSegment), so cells too
+    // small to catch a sample are not missed.
     int scanXZray (const Vec3& origin,
                    const Vec3& sampleSpacing,
                    const int sampleCount) const
     {
-        Vec3 samplePoint (origin);
+        if (sampleCount < 1) return 0;
 
-        for (int i = 1; i <= sampleCount; i++)
-        {
-            samplePoint += sampleSpacing;
-            if (getMapValue (samplePoint)) return i;
-        }
+        float hitDistance;
+        const Vec3 end = origin + (sampleSpacing * (float) sampleCount);
+        if (! scanXZSegment (origin, end, hitDistance)) return 0;
 
-        return 0;
+        const float spacing = sampleSpacing.setYtoZero().length ();
+        const int sample = (int) ceilf (hitDistance / spacing);
+        return std::max (1, std::min (sample, sampleCount));
     }
 
 
     int cellwidth (void) const {return resolution;}  // xxx cwr
     int cellheight (void) const {return resolution;}  // xxx cwr
     bool isPassable (const Vec3& point) const {return ! getMapValue (point);}
-
-
-    Vec3 center;
-    float xSize;
-    float zSize;
-    int resolution;
-
-    bool outsideValue;
-
-private:
-
-    int mapAddress (int i, int j) const {return i + (j * resolution);}
-
-    std::vector<bool> map;
 };
 
 
@@ -275,7 +232,24 @@ public:
         }
     }
 
-    virtual ~GCRoute() {}
+    virtual ~GCRoute() {delete [] radii;}
+
+    // The queries below are const and keep no state in the route (unlike
+    // PolylinePathway's, which pass results through member variables), so
+    // one route can be shared by many vehicles updated in parallel.
+
+    // distance from a point to segment i (from points[i-1] to points[i]),
+    // also returns the nearest point on the segment and how far along the
+    // segment it lies
+    float segmentDistance (const Vec3& point,
+                           const int i,
+                           Vec3& nearest,
+                           float& projection) const
+    {
+        projection = clip (normals[i].dot (point - points[i-1]), 0, lengths[i]);
+        nearest = points[i-1] + (normals[i] * projection);
+        return Vec3::distance (point, nearest);
+    }
 
     // override the PolylinePathway method to allow for GCRoute-style
     // per-leg radii
@@ -285,7 +259,9 @@ public:
     // P and a measure of how far A is outside the Pathway's "tube".  Note
     // that a negative distance indicates A is inside the Pathway.
 
-    Vec3 mapPointToPath (const Vec3& point, Vec3& tangent, float& outside)
+    Vec3 mapPointToPath (const Vec3& point,
+                         Vec3& tangent,
+                         float& outside) const
     {
         Vec3 onPath;
         outside = FLT_MAX;
@@ -293,10 +269,9 @@ public:
         // loop over all segments, find the one nearest to the given point
         for (int i = 1; i < pointCount; i++)
         {
-            // QQQ note bizarre calling sequence of pointToSegmentDistance
-            segmentLength = lengths[i];
-            segmentNormal = normals[i];
-            const float d =pointToSegmentDistance(point,points[i-1],points[i]);
+            Vec3 nearest;
+            float projection;
+            const float d = segmentDistance (point, i, nearest, projection);
 
             // measure how far original point is outside the Pathway's "tube"
             // (negative values (from 0 to -radius) measure "insideness")
@@ -307,8 +282,8 @@ public:
             if (o < outside)
             {
                 outside = o;
-                onPath = chosen;
-                tangent = segmentNormal;
+                onPath = nearest;
+                tangent = normals[i];
             }
         }
 
@@ -316,17 +291,88 @@ public:
         return onPath;
     }
 
+    // (the Pathway protocol's version, for use through a Pathway&)
+    Vec3 mapPointToPath (const Vec3& point, Vec3& tangent, float& outside)
+    {
+        const GCRoute& route = *this;
+        return route.mapPointToPath (point, tangent, outside);
+    }
+
     // ignore that "tangent" output argument which is never used
     // XXX eventually move this to Pathway class
-    Vec3 mapPointToPath (const Vec3& point, float& outside)
+    Vec3 mapPointToPath (const Vec3& point, float& outside) const
     {
         Vec3 tangent;
         return mapPointToPath (point, tangent, outside);
     }
 
+    // given an arbitrary point, convert it to a distance along the path
+    float mapPointToPathDistance (const Vec3& point) const
+    {
+        float minDistance = FLT_MAX;
+        float segmentLengthTotal = 0;
+        float pathDistance = 0;
+
+        for (int i = 1; i < pointCount; i++)
+        {
+            Vec3 nearest;
+            float projection;
+            const float d = segmentDistance (point, i, nearest, projection);
+            if (d < minDistance)
+            {
+                minDistance = d;
+                pathDistance = segmentLengthTotal + projection;
+            }
+            segmentLengthTotal += lengths[i];
+        }
+        return pathDistance;
+    }
+
+    // given a distance along the path, convert it to a point on the path
+    Vec3 mapPathDistanceToPoint (float pathDistance) const
+    {
+        // clip or wrap given path distance according to cyclic flag
+        float remaining = pathDistance;
+        if (cyclic)
+        {
+            remaining = (float) fmod (pathDistance, totalPathLength);
+        }
+        else
+        {
+            if (pathDistance < 0) return points[0];
+            if (pathDistance >= totalPathLength) return points [pointCount-1];
+        }
+
+        // find the segment containing that distance, interpolate along it
+        for (int i = 1; i < pointCount; i++)
+        {
+            if (lengths[i] < remaining)
+                remaining -= lengths[i];
+            else
+                return interpolate (remaining / lengths[i],
+                                    points[i-1],
+                                    points[i]);
+        }
+        return Vec3::zero;
+    }
+
+    // is the given point inside the path tube?
+    bool isInsidePath (const Vec3& point) const
+    {
+        return howFarOutsidePath (point) < 0;
+    }
+
+    // how far outside path tube is the given point?  (negative is inside)
+    float howFarOutsidePath (const Vec3& point) const
+    {
+        float outside;
+        mapPointToPath (point, outside);
+        return outside;
+    }
+
     // get the index number of the path segment nearest the given point
     // XXX consider moving this to path class
-    int indexOfNearestSegment (const Vec3& point)
+    int indexOfNearestSegment (const Vec3& point) const
     {
         int index = 0;
         float minDistance = FLT_MAX;
@@ -334,9 +380,9 @@ public:
         // loop over all segments, find the one nearest the given point
         for (int i = 1; i < pointCount; i++)
         {
-            segmentLength = lengths[i];
-            segmentNormal = normals[i];
-            float d = pointToSegmentDistance (point, points[i-1], points[i]);
+            Vec3 nearest;
+            float projection;
+            float d = segmentDistance (point, i, nearest, projection);
             if (d < minDistance)
             {
                 minDistance = d;
@@ -348,13 +394,13 @@ public:
 
     // returns the dot product of the tangents of two path segments, 
     // used to measure the "angle" at a path vertex: how sharp is the turn?
-    float dotSegmentUnitTangents (int segmentIndex0, int segmentIndex1)
+    float dotSegmentUnitTangents (int segmentIndex0, int segmentIndex1) const
     {
         return normals[segmentIndex0].dot (normals[segmentIndex1]);
     }
 
     // return path tangent at given point (its projection on path)
-    Vec3 tangentAt (const Vec3& point)
+    Vec3 tangentAt (const Vec3& point) const
     {
         return normals [indexOfNearestSegment (point)];
     }
@@ -363,11 +409,13 @@ public:
     // multiplied by the given pathfollowing direction (+1/-1 =
     // upstream/downstream).  Near path vertices (waypoints) use the
     // tangent of the "next segment" in the given direction
-    Vec3 tangentAt (const Vec3& point, const int pathFollowDirection)
+    Vec3 tangentAt (const Vec3& point, const int pathFollowDirection) const
     {
         const int segmentIndex = indexOfNearestSegment (point);
         const int nextIndex = segmentIndex + pathFollowDirection;
-        const bool insideNextSegment = isInsidePathSegment (point, nextIndex);
+        const bool insideNextSegment = ((nextIndex > 0) &&
+                                        (nextIndex < pointCount) &&
+                                        isInsidePathSegment (point, nextIndex));
         const int i = (segmentIndex +
                        (insideNextSegment ? pathFollowDirection : 0));
         return normals [i] * (float)pathFollowDirection;
@@ -375,13 +423,15 @@ public:
 
     // is the given point "near" a waypoint of this path?  ("near" == closer
     // to the waypoint than the max of radii of two adjacent segments)
-    bool nearWaypoint (const Vec3& point)
+    bool nearWaypoint (const Vec3& point) const
     {
         // loop over all waypoints
         for (int i = 1; i < pointCount; i++)
         {
             // return true if near enough to this waypoint
-            const float r = maxXXX (radii[i], radii[i+1]);
+            // (the last waypoint has only one adjacent segment)
+            const int next = std::min (i + 1, pointCount - 1);
+            const float r = maxXXX (radii[i], radii[next]);
             const float d = (point - points[i]).length ();
             if (d < r) return true;
         }
@@ -391,14 +441,13 @@ public:
     // is the given point inside the path tube of the given segment
     // number?  (currently not used. this seemed like a useful utility,
     // but wasn't right for the problem I was trying to solve)
-    bool isInsidePathSegment (const Vec3& point, const int segmentIndex)
+    bool isInsidePathSegment (const Vec3& point, const int segmentIndex) const
     {
         const int i = segmentIndex;
 
-        // QQQ note bizarre calling sequence of pointToSegmentDistance
-        segmentLength = lengths[i];
-        segmentNormal = normals[i];
-        const float d = pointToSegmentDistance(point, points[i-1], points[i]);
+        Vec3 nearest;
+        float projection;
+        const float d = segmentDistance (point, i, nearest, projection);
 
         // measure how far original point is outside the Pathway's "tube"
         // (negative values (from 0 to -radius) measure "insideness")
@@ -413,6 +462,17 @@ public:
 };
 
 
+// ----------------------------------------------------------------------------
+// The map and route are shared by all drivers: immutable once published,
+// reference counted, and replaced as a whole (not edited) when the world
+// is regenerated.  A driver keeps the old ones alive until it is handed
+// the new ones.
+
+
+typedef std::shared_ptr<const TerrainMap> TerrainMapHandle;
+typedef std::shared_ptr<const GCRoute> GCRouteHandle;
+
+
 // ----------------------------------------------------------------------------
 
 
@@ -420,9 +480,43 @@ class MapDriver : public SimpleVehicle
 {
 public:
 
-    // constructor
-    MapDriver () : map (makeMap ()), path (makePath ())
-    {
+    // the scans made by steerToAvoidObstaclesOnMap: a line straight
+    // ahead (from start, samples steps of step) or, with curved steering,
+    // an arc from start (growing by endRadius over its length), with the
+    // zone it looks at and its annotation colors
+    struct ObstacleScan
+    {
+        enum Zone {corridorL, corridorR, wingL, wingR};
+        Zone zone;
+        Vec3 start;
+        Vec3 step;
+        int samples;
+        float endRadius;
+        Vec3 beforeColor;
+        Vec3 afterColor;
+        bool outermost;  // the outermost corridor lines
+    };
+
+    // constructor: drive on a shared map and route, "index" numbers the
+    // drivers on the map (driver 0 starts in the usual place, the others
+    // spread out over the map)
+    MapDriver (const TerrainMapHandle& m, const GCRouteHandle& p, int index)
+        : map (m), path (p), driverIndex (index)
+    {
+        // don't print messages from worker threads
+        quiet = (driverIndex != 0);
+
+        // nearest obstacle in each zone, for annotation
+        savedNearestWR = savedNearestR = savedNearestL = savedNearestWL = 0;
+
+        // follow the path "upstream or downstream" (+1/-1)
+        // (set before reset, which uses them)
+        pathFollowDirection = 1;
+
+        // use curved prediction and incremental steering:
+        curvedSteering = true;
+        incrementalSteering = true;
+
         reset ();
 
         // to compute mean time between collisions
@@ -450,13 +544,6 @@ public:
         hintGivenCount = 0;
         hintTakenCount = 0;
 
-        // follow the path "upstream or downstream" (+1/-1)
-        pathFollowDirection = 1;
-
-        // use curved prediction and incremental steering:
-        curvedSteering = true;
-        incrementalSteering = true;
-
         // 10 seconds with 200 points along the trail
         setTrailParameters (10, 200);
     }
@@ -464,8 +551,6 @@ public:
     // destructor
     ~MapDriver ()
     {
-        delete (map);
-        delete (path);
     }
 
     // reset state
@@ -515,6 +600,9 @@ public:
             regenerateOrthonormalBasisUF (Vec3::side * d);
         }
 
+        // other drivers start elsewhere, spread over the map
+        if (driverIndex != 0) placeAwayFromStart ();
+
         // reset bookeeping to detect stuck cycles
         resetStuckCycleDetection ();
 
@@ -707,9 +795,13 @@ public:
             !collisionLastTime &&
             (timeSinceLastCollision > 1))
         {
-            std::ostringstream message;
-            message << "collision after "<<timeSinceLastCollision<<" seconds";
-            App::get_singleton()->printMessage (message);
+            if (! quiet)
+            {
+                std::ostringstream message;
+                message << "collision after " << timeSinceLastCollision
+                        << " seconds";
+                App::get_singleton()->printMessage (message);
+            }
             sumOfCollisionFreeTimes += timeSinceLastCollision;
             countOfCollisionFreeTimes++;
             timeOfLastCollision = currentTime;
@@ -872,74 +964,20 @@ public:
         // assert loops will terminate
     assert (spacing > 0);
 
-        // scan corridor straight ahead of vehicle,
-        // keep track of nearest obstacle on left and right sides
+        // the scans: pairs of lines along the corridor straight ahead of
+        // the vehicle, then the "wings" from its front corners
+        obstacleScans.clear ();
         while (s < maxSide)
         {
             sOffset = side() * s;
             s += spacing;
-            const Vec3 lOffset = fOffset + sOffset;
-            const Vec3 rOffset = fOffset - sOffset;
-
-            Vec3 lObsPos, rObsPos;
-
-            const int L = (curvedSteering ? 
-                           (int) (scanObstacleMap (lOffset,
-                                                   center,
-                                                   arcAngle,
-                                                   maxSamples,
-                                                   0,
-                                                   gYellow,
-                                                   gRed,
-                                                   lObsPos)
-                                  / spacing) :
-                           map.scanXZray (lOffset, step, maxSamples));
-            const int R = (curvedSteering ? 
-                           (int) (scanObstacleMap (rOffset,
-                                                    center,
-                                                   arcAngle,
-                                                   maxSamples,
-                                                   0,
-                                                   gYellow,
-                                                   gRed,
-                                                   rObsPos)
-                                  / spacing) :
-                           map.scanXZray (rOffset, step, maxSamples));
-
-            if ((L > 0) && (L < nearestL))
-            {
-                nearestL = L;
-                if (L < nearestR) nearestO = ((curvedSteering) ?
-                                              lObsPos :
-                                              lOffset + ((float)L * step));
-            }
-            if ((R > 0) && (R < nearestR))
-            {
-                nearestR = R;
-                if (R < nearestL) nearestO = ((curvedSteering) ?
-                                              rObsPos :
-                                              rOffset + ((float)R * step));
-            }
-
-            if (!curvedSteering)
-            {
-                annotateAvoidObstaclesOnMap (lOffset, L, step);
-                annotateAvoidObstaclesOnMap (rOffset, R, step);
-            }
-
-            if (curvedSteering)
-            {
-                // QQQ temporary global QQQoaJustScraping
-                const bool outermost = s >= maxSide;
-                const bool eitherSide = (L > 0) || (R > 0);
-                if (!outermost && eitherSide) QQQoaJustScraping = false;
-            }
+            const bool outermost = s >= maxSide;
+            addObstacleScan (ObstacleScan::corridorL, fOffset + sOffset, step,
+                             maxSamples, 0, gYellow, gRed, outermost);
+            addObstacleScan (ObstacleScan::corridorR, fOffset - sOffset, step,
+                             maxSamples, 0, gYellow, gRed, outermost);
         }
-        qqqLastNearestObstacle = nearestO;
-
-        // scan "wings"
         {
-            const int wingScans = 4;
             // see duplicated code at: QQQ draw sensing "wings"
             // QQQ should be a parameter of this method
             const Vec3 wingWidth = side() * wingSlope () * maxForward;
@@ -947,9 +985,9 @@ public:
             const Vec3 beforeColor (0.75f, 0.9f, 0.0f);  // for annotation
             const Vec3 afterColor  (0.9f,  0.5f, 0.0f);  // for annotation
 
-            for (int i=1; i<=wingScans; i++)
+            for (int i=1; i<=avoidanceWingScans; i++)
             {
-                const float fraction = (float)i / (float)wingScans;
+                const float fraction = (float)i / (float)avoidanceWingScans;
                 const Vec3 endside = sOffset + (wingWidth * fraction);
                 const Vec3 corridorFront = forward() * maxForward;
 
@@ -961,41 +999,96 @@ public:
                     const Vec3 end = fOffset + corridorFront + (endside * k);
                     const Vec3 ray = end - start;
                     const float rayLength = ray.length();
-                    const Vec3 step = ray * spacing / rayLength;
-                    const int raySamples = (int) (rayLength / spacing);
+                    // (for curved scans: the spiral's change in radius)
                     const float endRadius =
                         wingSlope () * maxForward * fraction *
-                        (signedRadius < 0 ? 1 : -1) * (j==1?1:-1);
-                    Vec3 ignore;
-                    const int scan = (curvedSteering ?
-                                      (int) (scanObstacleMap (start,
-                                                              center,
-                                                              arcAngle,
-                                                              raySamples,
-                                                              endRadius,
-                                                              beforeColor,
-                                                              afterColor,
-                                                              ignore)
-                                             / spacing) :
-                                      map.scanXZray (start, step, raySamples));
-
-                    if (!curvedSteering)
-                        annotateAvoidObstaclesOnMap (start,scan,step);
-
-                    if (j==1) 
-                    {
-                        if ((scan > 0) && (scan < nearestWL)) nearestWL = scan;
-                    }
-                    else
-                    {
-                        if ((scan > 0) && (scan < nearestWR)) nearestWR = scan;
-                    }
+                        (signedRadius < 0 ? 1 : -1) * k;
+                    addObstacleScan ((j == 1) ?
+                                     ObstacleScan::wingL :
+                                     ObstacleScan::wingR,
+                                     start,
+                                     ray * spacing / rayLength,
+                                     (int) (rayLength / spacing),
+                                     endRadius,
+                                     beforeColor,
+                                     afterColor,
+                                     false);
                 }
             }
-            wingDrawFlagL = nearestWL != infinity;
-            wingDrawFlagR = nearestWR != infinity;
         }
 
+        // with curved steering every scan is an arc: scan them all in one
+        // batch
+        if (curvedSteering)
+        {
+            scanArcs.clear ();
+            for (size_t i = 0; i < obstacleScans.size (); i++)
+            {
+                const ObstacleScan& scan = obstacleScans[i];
+                scanArcs.push_back (obstacleScanArc (scan.start, center,
+                                                     arcAngle, scan.samples,
+                                                     scan.endRadius));
+            }
+            scanObstacleArcs (map);
+        }
+
+        // keep track of the nearest obstacle in each zone
+        for (size_t i = 0; i < obstacleScans.size (); i++)
+        {
+            const ObstacleScan& scan = obstacleScans[i];
+            int hit;
+            Vec3 obstaclePosition;
+            if (curvedSteering)
+            {
+                hit = (int) (obstacleScanResult (scanArcs[i],
+                                                 scanHits[i],
+                                                 scan.beforeColor,
+                                                 scan.afterColor,
+                                                 obstaclePosition)
+                             / spacing);
+            }
+            else
+            {
+                hit = map.scanXZray (scan.start, scan.step, scan.samples);
+                obstaclePosition = scan.start + ((float)hit * scan.step);
+                annotateAvoidObstaclesOnMap (scan.start, hit, scan.step);
+            }
+            if (hit <= 0) continue;
+
+            switch (scan.zone)
+            {
+            case ObstacleScan::corridorL:
+                if (hit < nearestL)
+                {
+                    nearestL = hit;
+                    if (hit < nearestR) nearestO = obstaclePosition;
+                }
+                break;
+            case ObstacleScan::corridorR:
+                if (hit < nearestR)
+                {
+                    nearestR = hit;
+                    if (hit < nearestL) nearestO = obstaclePosition;
+                }
+                break;
+            case ObstacleScan::wingL:
+                if (hit < nearestWL) nearestWL = hit;
+                break;
+            case ObstacleScan::wingR:
+                if (hit < nearestWR) nearestWR = hit;
+                break;
+            }
+
+            // QQQ temporary global QQQoaJustScraping
+            if (curvedSteering && !scan.outermost &&
+                ((scan.zone == ObstacleScan::corridorL) ||
+                 (scan.zone == ObstacleScan::corridorR)))
+                QQQoaJustScraping = false;
+        }
+        qqqLastNearestObstacle = nearestO;
+        wingDrawFlagL = nearestWL != infinity;
+        wingDrawFlagR = nearestWR != infinity;
+
         // for annotation
         savedNearestWR = (float) nearestWR;
         savedNearestR  = (float) nearestR;
@@ -1189,68 +1282,101 @@ public:
                            const Vec3& afterColor,
                            Vec3& returnObstaclePosition)
     {
-        // "spoke" is initially the vector from center to start,
-        // which is then rotated step by step around center
-        Vec3 spoke = start - center;
-        // determine the angular step per segment
-        const float step = arcAngle / segments;
-        // store distance to, and position of first obstacle
-        float obstacleDistance = 0;
-        returnObstaclePosition = Vec3::zero;
-        // for spiral "ramps" of changing radius
-        const float startRadius = (endRadiusChange == 0) ? 0 : spoke.length(); 
-
-        // traverse each segment along arc
-        float sin=0, cos=0;
-        Vec3 oldPoint = start;
-        bool obstacleFound = false;
-        for (int i = 0; i < segments; i++)
+        const OccupancyGrid::XZArc arc = obstacleScanArc (start,
+                                                          center,
+                                                          arcAngle,
+                                                          segments,
+                                                          endRadiusChange);
+        int hit;
+        map->scanXZArcs (&arc, 1, &hit);
+        return obstacleScanResult (arc, hit, beforeColor, afterColor,
+                                   returnObstaclePosition);
+    }
+
+
+    // the arc scanned by scanObstacleMap: "spoke" is the vector from
+    // center to start, rotated step by step around center (and for spiral
+    // "ramps" its length changed by endRadiusChange over the whole arc)
+    OccupancyGrid::XZArc obstacleScanArc (const Vec3& start,
+                                          const Vec3& center,
+                                          const float arcAngle,
+                                          const int segments,
+                                          const float endRadiusChange) const
+    {
+        OccupancyGrid::XZArc arc;
+        arc.center = center;
+        arc.spoke = start - center;
+        arc.angleStep = (segments > 0) ? arcAngle / segments : 0;
+        arc.sampleCount = segments;
+        const float startRadius = arc.spoke.length ();
+        arc.endScale = (((endRadiusChange == 0) || (startRadius == 0)) ?
+                        1.0f :
+                        maxXXX (0, startRadius + endRadiusChange) / startRadius);
+        return arc;
+    }
+
+
+    // distance to (and position of) the first obstacle found by an arc
+    // scan, zero if none, annotating the arc up to and past the obstacle
+    float obstacleScanResult (const OccupancyGrid::XZArc& arc,
+                              const int hit,
+                              const Vec3& beforeColor,
+                              const Vec3& afterColor,
+                              Vec3& returnObstaclePosition) const
+    {
+        if (App::get_singleton()->annotationIsOn ())
         {
-            // rotate "spoke" to next step around circle
-            // (sin and cos values get filled in on first call)
-            spoke = spoke.rotateAboutGlobalY (step, sin, cos);
-
-            // for spiral "ramps" of changing radius
-            const float adjust = ((endRadiusChange == 0) ?
-                                  1.0f :
-                                  interpolate ((float)(i+1) / (float)segments,
-                                               1.0f,
-                                               (maxXXX (0,
-                                                        (startRadius +
-                                                         endRadiusChange))
-                                                / startRadius)));
-
-            // construct new scan point: center point, offset by rotated
-            // spoke (possibly adjusting the radius if endRadiusChange!=0)
-            const Vec3 newPoint = center + (spoke * adjust);
-
-            // once an obstacle if found "our work here is done" -- continue
-            // to loop only for the sake of annotation (make that optional?)
-            if (obstacleFound)
+            Vec3 oldPoint = arc.samplePoint (-1);
+            for (int i = 0; i < arc.sampleCount; i++)
             {
-                annotationLine (oldPoint, newPoint, afterColor);
+                const Vec3 newPoint = arc.samplePoint (i);
+                const bool after = (hit >= 0) && (i > hit);
+                annotationLine (oldPoint, newPoint,
+                                after ? afterColor : beforeColor);
+                oldPoint = newPoint;
             }
-            else
-            {
-                // no obstacle found on this scan so far,
-                // scan map along current segment (a chord of the arc)
-                const Vec3 offset = newPoint - oldPoint;
-                const float d2 = offset.length() * 2;
-
-                // when obstacle found: set flag, save distance and position
-                if (! map->isPassable (newPoint))
-                {
-                    obstacleFound = true;
-                    obstacleDistance = d2 * 0.5f * (i+1);
-                    returnObstaclePosition = newPoint;
-                }
-                annotationLine (oldPoint, newPoint, beforeColor);
-            }
-            // save new point for next time around loop
-            oldPoint = newPoint;
         }
-        // return distance to first obstacle (or zero if none found)
-        return obstacleDistance;
+
+        returnObstaclePosition = Vec3::zero;
+        if (hit < 0) return 0;
+
+        // approximate distance: the chord into the obstacle's sample point
+        // times the number of chords
+        returnObstaclePosition = arc.samplePoint (hit);
+        const Vec3 chord = returnObstaclePosition - arc.samplePoint (hit - 1);
+        return chord.length () * (hit + 1);
+    }
+
+
+    // add a scan to obstacleScans, for steerToAvoidObstaclesOnMap
+    void addObstacleScan (const ObstacleScan::Zone zone,
+                          const Vec3& start,
+                          const Vec3& step,
+                          const int samples,
+                          const float endRadius,
+                          const Vec3& beforeColor,
+                          const Vec3& afterColor,
+                          const bool outermost)
+    {
+        ObstacleScan scan;
+        scan.zone = zone;
+        scan.start = start;
+        scan.step = step;
+        scan.samples = samples;
+        scan.endRadius = endRadius;
+        scan.beforeColor = beforeColor;
+        scan.afterColor = afterColor;
+        scan.outermost = outermost;
+        obstacleScans.push_back (scan);
+    }
+
+
+    // scan a batch of arcs (scanArcs) in one pass, results in scanHits
+    void scanObstacleArcs (const TerrainMap& map)
+    {
+        scanHits.resize (scanArcs.size ());
+        if (! scanArcs.empty ())
+            map.scanXZArcs (&scanArcs[0], (int) scanArcs.size (), &scanHits[0]);
     }
 
 
@@ -1279,7 +1405,9 @@ public:
         const Vec3 qqqLift (0, 0.2f, 0);
         Vec3 ignore;
 
-        // scan region ahead of vehicle
+        // scan region ahead of vehicle (with curved steering the arcs are
+        // collected here and scanned in one batch below)
+        scanArcs.clear ();
         while (s < maxSide)
         {
             const Vec3 sOffset = side() * s;
@@ -1293,35 +1421,28 @@ public:
                                                  maxForward * bevel));
             const float angle = (scanDist * twoPi * sign) / circumference;
             const int samples = (int) (scanDist / spacing);
-            const int L = (curvedSteering ?
-                           (int) (scanObstacleMap (lOffset + qqqLift,
-                                                   center,
-                                                   angle,
-                                                   samples,
-                                                   0,
-                                                   gMagenta,
-                                                   gCyan,
-                                                   ignore)
-                                  / spacing) :
-                           map->scanXZray (lOffset, step, samples));
-            const int R = (curvedSteering ?
-                           (int) (scanObstacleMap (rOffset + qqqLift,
-                                                   center,
-                                                   angle,
-                                                   samples,
-                                                   0,
-                                                   gMagenta,
-                                                   gCyan,
-                                                   ignore)
-                                  / spacing) :
-                           map->scanXZray (rOffset, step, samples));
-
-            returnFlag = returnFlag || (L > 0);
-            returnFlag = returnFlag || (R > 0);
-
-            // annotation
-            if (! curvedSteering)
+            if (curvedSteering)
+            {
+                scanArcs.push_back (obstacleScanArc (lOffset + qqqLift,
+                                                     center,
+                                                     angle,
+                                                     samples,
+                                                     0));
+                scanArcs.push_back (obstacleScanArc (rOffset + qqqLift,
+                                                     center,
+                                                     angle,
+                                                     samples,
+                                                     0));
+            }
+            else
             {
+                const int L = map->scanXZray (lOffset, step, samples);
+                const int R = map->scanXZray (rOffset, step, samples);
+
+                returnFlag = returnFlag || (L > 0);
+                returnFlag = returnFlag || (R > 0);
+
+                // annotation
                 const Vec3 d (step * (float) samples);
                 annotationLine (lOffset, lOffset + d, gWhite);
                 annotationLine (rOffset, rOffset + d, gWhite);
@@ -1330,6 +1451,21 @@ public:
             // increment sideways displacement of scan line
             s += spacing;
         }
+
+        if (curvedSteering)
+        {
+            scanObstacleArcs (*map);
+            for (size_t a = 0; a < scanArcs.size (); a++)
+            {
+                const int scan = (int) (obstacleScanResult (scanArcs[a],
+                                                            scanHits[a],
+                                                            gMagenta,
+                                                            gCyan,
+                                                            ignore)
+                                        / spacing);
+                returnFlag = returnFlag || (scan > 0);
+            }
+        }
         return returnFlag;
     }
 
@@ -1409,7 +1545,7 @@ public:
     //
     Vec3 steerToFollowPath (const int direction,
                             const float predictionTime,
-                            GCRoute& path)
+                            const GCRoute& path)
     {
         if (curvedSteering)
             return steerToFollowPathCurve (direction, predictionTime, path);
@@ -1420,7 +1556,7 @@ public:
 
     Vec3 steerToFollowPathLinear (const int direction,
                                   const float predictionTime,
-                                  GCRoute& path)
+                                  const GCRoute& path)
     {
         // our goal will be offset from our path distance by this amount
         const float pathDistanceOffset = direction * predictionTime * speed();
@@ -1509,7 +1645,7 @@ public:
     //
     Vec3 steerToFollowPathCurve (const int direction,
                                  const float predictionTime,
-                                 GCRoute& path)
+                                 const GCRoute& path)
     {
         // predict our future position (based on current curvature and speed)
         const Vec3 futurePosition = predictFuturePosition (predictionTime);
@@ -1628,6 +1764,17 @@ public:
 
     // draw vehicle's body and annotation
     void draw (void)
+    {
+        drawBody ();
+
+        // annotate trail
+        const Vec3 darkGreen (0, 0.6f, 0);
+        drawTrail (darkGreen, gBlack);
+    }
+
+
+    // draw just the vehicle's body
+    void drawBody (void)
     {
         // for now: draw as a 2d bounding box on the ground
         Vec3                     bodyColor = gBlack;
@@ -1645,10 +1792,6 @@ public:
                         p + bbFront - bbSide + bbHeight,
                         p - bbFront - bbSide + bbHeight,
                         bodyColor);
-
-        // annotate trail
-        const Vec3 darkGreen (0, 0.6f, 0);
-        drawTrail (darkGreen, gBlack);
     }
 
 
@@ -1755,7 +1898,7 @@ public:
     }
 
 
-    GCRoute* makePath (void)
+    static GCRoute* makePath (void)
     {
         // a few constants based on world size
         const float m = worldSize * 0.4; // main diamond size
@@ -1793,12 +1936,16 @@ public:
     }
 
 
-    TerrainMap* makeMap (void)
+    static TerrainMap* makeMap (void)
     {
-        return new TerrainMap (Vec3::zero,
-                               worldSize,
-                               worldSize,
-                               (int)worldSize + 1);
+        TerrainMap* m = new TerrainMap (Vec3::zero,
+                                        worldSize,
+                                        worldSize,
+                                        (int)worldSize + 1);
+
+        // keep a distance field so scans can leap across open ground
+        m->setDistanceFieldEnabled (true);
+        return m;
     }
 
 
@@ -1816,6 +1963,8 @@ public:
                 lapsStarted++;
                 lapsFinished++;
 
+                // (the camera follows only the first driver)
+                const bool moveCamera = (driverIndex == 0);
                 const Vec3 camOffsetBefore =
                     App::get_singleton()->camera.position() - position ();
 
@@ -1829,12 +1978,15 @@ public:
                 // reset bookeeping to detect stuck cycles
                 resetStuckCycleDetection ();
 
-                // new camera position and aimpoint to compensate for teleport
-                App::get_singleton()->camera.target = position ();
-                App::get_singleton()->camera.setPosition (position () + camOffsetBefore);
+                if (moveCamera)
+                {
+                    // new camera position and aimpoint to compensate for teleport
+                    App::get_singleton()->camera.target = position ();
+                    App::get_singleton()->camera.setPosition (position () + camOffsetBefore);
 
-                // make camera jump immediately to new position
-                App::get_singleton()->camera.doNotSmoothNextMove ();
+                    // make camera jump immediately to new position
+                    App::get_singleton()->camera.doNotSmoothNextMove ();
+                }
 
                 // prevent long streaks due to teleportation 
                 clearTrailHistory ();
@@ -1864,6 +2016,39 @@ public:
     }
 
 
+    // start somewhere other than the usual place: on the route (heading
+    // along it) when path following, else at a random clear spot
+    void placeAwayFromStart (void)
+    {
+        if (demoSelect == 2)
+        {
+            // spread along the middle of the route (whose ends lie
+            // outside the map)
+            const float fraction = randomStream.frandom2 (0.35f, 0.65f);
+            const float distance = path->totalPathLength * fraction;
+            const Vec3 onPath = path->mapPathDistanceToPoint (distance);
+            const Vec3 heading = path->tangentAt (onPath, pathFollowDirection);
+            setPosition (onPath);
+            regenerateOrthonormalBasisUF (heading);
+        }
+        else
+        {
+            // try a few random spots, prefer one clear of obstacles
+            const float s = worldSize * 0.4f;
+            for (int tries = 0; tries < 20; tries++)
+            {
+                setPosition (Vec3 (randomStream.frandom2 (-s, s),
+                                   0,
+                                   randomStream.frandom2 (-s, s)));
+                if (map->clearanceAt (position ()) > halfLength * 2) break;
+            }
+            const Vec3 heading = RandomUnitVectorOnXZPlane (randomStream);
+            regenerateOrthonormalBasisUF (heading);
+        }
+        resetStuckCycleDetection ();
+    }
+
+
     void resetStuckCycleDetection (void)
     {
         resetSmoothedPosition (position () + (forward () * -80)); // qqq
@@ -2124,11 +2309,17 @@ public:
         }
     }
 
-    // map of obstacles
-    TerrainMap* map;
+    // map of obstacles (shared by all drivers)
+    TerrainMapHandle map;
+
+    // route for path following (waypoints and legs, shared by all drivers)
+    GCRouteHandle path;
+
+    // number of this driver on the map, zero for the one the camera follows
+    int driverIndex;
 
-    // route for path following (waypoints and legs)
-    GCRoute* path;
+    // don't print messages (set for drivers updated on worker threads)
+    bool quiet;
 
     // follow the path "upstream or downstream" (+1/-1)
     int pathFollowDirection;
@@ -2189,9 +2380,18 @@ public:
     bool curvedSteering;
     bool incrementalSteering;
 
+    // number of "wing" scans on each side in steerToAvoidObstaclesOnMap
+    enum {avoidanceWingScans = 4};
+
+    std::vector<ObstacleScan> obstacleScans;
+
+    // batch of arc scans and their results (first hit sample, or -1)
+    std::vector<OccupancyGrid::XZArc> scanArcs;
+    std::vector<int> scanHits;
+
     // save obstacle avoidance stats for annotation
     // (nearest obstacle in each of the four zones)
-    static float savedNearestWR, savedNearestR, savedNearestL, savedNearestWL;
+    float savedNearestWR, savedNearestR, savedNearestL, savedNearestWL;
 
     float annoteMaxRelSpeed, annoteMaxRelSpeedCurve, annoteMaxRelSpeedPath;
 
@@ -2214,10 +2414,36 @@ float MapDriver::worldDiag = sqrtXXX (square (worldSize) / 2);
 // int MapDriver::demoSelect = 0;
 int MapDriver::demoSelect = 2;
 
-float MapDriver::savedNearestWR = 0;
-float MapDriver::savedNearestR = 0;
-float MapDriver::savedNearestL = 0;
-float MapDriver::savedNearestWL = 0;
+// ----------------------------------------------------------------------------
+// updates a range of drivers, run on the WorkerPool's threads: each driver
+// scans the shared map and route and changes only its own state
+
+
+class MapDriverUpdate : public WorkerPool::Job
+{
+public:
+
+    MapDriverUpdate (const std::vector<MapDriver*>& d,
+                     const int first,
+                     const float c,
+                     const float e)
+        : drivers (d), firstDriver (first), currentTime (c), elapsedTime (e)
+    {
+    }
+
+    void run (int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            drivers[firstDriver + i]->update (currentTime, elapsedTime);
+    }
+
+private:
+
+    const std::vector<MapDriver*>& drivers;
+    const int firstDriver;
+    const float currentTime;
+    const float elapsedTime;
+};
 
 
 // ----------------------------------------------------------------------------
@@ -2237,11 +2463,16 @@ public:
 
     void open (void)
     {
-        // make new MapDriver
-        vehicle = new MapDriver ();
+        // make the shared map and route, and the first MapDriver
+        map.reset (MapDriver::makeMap ());
+        path.reset (MapDriver::makePath ());
+        vehicle = new MapDriver (map, path, 0);
         vehicles.push_back (vehicle);
         App::get_singleton()->selectedVehicle = vehicle;
 
+        // more drivers can share the map (see F7), updated in parallel
+        parallelUpdate = true;
+
         // marks as obstacles map cells adjacent to the path
         usePathFences = true; 
 
@@ -2269,6 +2500,21 @@ public:
         // update simulation of test vehicle
         vehicle->update (currentTime, elapsedTime);
 
+        // update any other drivers, without annotation
+        updateDrivers (1, currentTime, elapsedTime, parallelUpdate);
+
+        // other drivers leaving the map or getting stuck start again alone
+        for (size_t i = 1; i < vehicles.size (); i++)
+        {
+            MapDriver& driver = *vehicles[i];
+            driver.handleExitFromMap ();
+            if (driver.stuck && (driver.relativeSpeed () < 0.001))
+            {
+                driver.stuckCount++;
+                driver.reset ();
+            }
+        }
+
         // when vehicle drives outside the world
         if (vehicle->handleExitFromMap ()) regenerateMap ();
 
@@ -2281,6 +2527,30 @@ public:
     }
 
 
+    // update drivers "first" and up, with annotation turned off: on the
+    // WorkerPool's threads when "parallel" is set, else on this one
+    void updateDrivers (const int first,
+                        const float currentTime,
+                        const float elapsedTime,
+                        const bool parallel)
+    {
+        const int count = (int) vehicles.size () - first;
+        if (count <= 0) return;
+
+        App& app = *App::get_singleton();
+        const bool annotation = app.annotationIsOn ();
+        app.setAnnotationOff ();
+
+        MapDriverUpdate job (vehicles, first, currentTime, elapsedTime);
+        if (parallel)
+            WorkerPool::shared().parallelFor (count, 4, job);
+        else
+            job.run (0, count);
+
+        if (annotation) app.setAnnotationOn ();
+    }
+
+
     void redraw (const float currentTime, const float elapsedTime)
     {
         // update camera, tracking test vehicle
@@ -2299,8 +2569,9 @@ public:
         vehicle->drawMap ();
         if (vehicle->demoSelect == 2) vehicle->drawPath ();
 
-        // draw test vehicle
+        // draw test vehicle, and the bodies of any others
         vehicle->draw ();
+        for (size_t i = 1; i < vehicles.size (); i++) vehicles[i]->drawBody ();
 
         // QQQ mark origin to help spot artifacts
         const float tick = 2;
@@ -2359,6 +2630,13 @@ public:
         status << "\n[F5] prediction: ";
         if (vehicle->curvedSteering)
             status << "curved"; else status << "linear";
+        status << "\n[F7] drivers: " << vehicles.size ();
+        status << "\n[F9] update: ";
+        if (parallelUpdate)
+            status << "parallel (" << WorkerPool::shared().getThreadCount ()
+                   << " threads)";
+        else
+            status << "serial";
         if (2 == vehicle->demoSelect)
         {
             status << "\n\nLap " << vehicle->lapsStarted
@@ -2416,15 +2694,25 @@ public:
 
     void close (void)
     {
+        for (size_t i = 0; i < vehicles.size (); i++) delete vehicles[i];
         vehicles.clear ();
-        delete (vehicle);
+        vehicle = NULL;
+        map.reset ();
+        path.reset ();
     }
 
     void reset (void)
     {
         regenerateMap();
 
-        // reset vehicle
+        // reset vehicles (the others follow the test vehicle's settings)
+        for (size_t i = 1; i < vehicles.size (); i++)
+        {
+            vehicles[i]->pathFollowDirection = vehicle->pathFollowDirection;
+            vehicles[i]->curvedSteering = vehicle->curvedSteering;
+            vehicles[i]->incrementalSteering = vehicle->incrementalSteering;
+            vehicles[i]->reset ();
+        }
         vehicle->reset ();
         // make camera jump immediately to new position
         App::get_singleton()->camera.doNotSmoothNextMove ();
@@ -2454,9 +2742,19 @@ public:
                 const float pathRadii[pathPointCount] = {10, 10};
                 const Vec3 pathPoints[pathPointCount] = {c, d};
                 GCRoute r (pathPointCount, pathPoints, pathRadii, false);
-                drawPathFencesOnMap (*vehicle->map, r);
+
+                // the map is shared and immutable: draw on a copy of it
+                TerrainMap* newMap = MapDriver::makeMap ();
+                newMap->readRows (map->rowWords (0));
+                drawPathFencesOnMap (*newMap, r);
+                newMap->updateDistanceField ();
+                publishMapAndPath (newMap, path);
                 break;
             }
+
+        case 7: selectNextDriverCount (); break;
+        case 8: runDriverCountBenchmark (); break;
+        case 9: toggleParallelUpdate (); break;
         }
     }
 
@@ -2471,13 +2769,115 @@ public:
         App::get_singleton()->printMessage ("  F3     toggle path fences.");
         App::get_singleton()->printMessage ("  F4     toggle random rock clumps.");
         App::get_singleton()->printMessage ("  F5     toggle curved prediction.");
+        App::get_singleton()->printMessage ("  F7     select next number of drivers.");
+        App::get_singleton()->printMessage ("  F8     benchmark frame time against number of drivers.");
+        App::get_singleton()->printMessage ("  F9     toggle parallel update of drivers.");
         App::get_singleton()->printMessage ("");
     }
 
+
+    // change the number of drivers sharing the map (the test vehicle,
+    // driver 0, always remains)
+    void setDriverCount (const int count)
+    {
+        while ((int) vehicles.size () > std::max (count, 1))
+        {
+            MapDriver* driver = vehicles.back ();
+            vehicles.pop_back ();
+            if (driver == App::get_singleton()->selectedVehicle)
+                App::get_singleton()->selectedVehicle = vehicle;
+            delete driver;
+        }
+        while ((int) vehicles.size () < count)
+        {
+            MapDriver* driver = new MapDriver (map, path, (int) vehicles.size ());
+            driver->pathFollowDirection = vehicle->pathFollowDirection;
+            driver->curvedSteering = vehicle->curvedSteering;
+            driver->incrementalSteering = vehicle->incrementalSteering;
+            driver->reset ();
+            vehicles.push_back (driver);
+        }
+    }
+
+    void selectNextDriverCount (void)
+    {
+        const int counts[] = {1, 10, 100, 300};
+        const int countCount = sizeof (counts) / sizeof (counts[0]);
+        int next = 0;
+        while ((next < countCount) && (counts[next] <= (int) vehicles.size ()))
+            next++;
+        setDriverCount (counts[next % countCount]);
+
+        std::ostringstream message;
+        message << name() << ": " << vehicles.size () << " drivers" << std::ends;
+        App::get_singleton()->printMessage (message);
+    }
+
+    void toggleParallelUpdate (void)
+    {
+        parallelUpdate = ! parallelUpdate;
+    }
+
+    // time the update of all drivers (without annotation) for a range of
+    // driver counts, serially and in parallel, and print a table of
+    // milliseconds per frame
+    void runDriverCountBenchmark (void)
+    {
+        App& app = *App::get_singleton();
+        const int counts[] = {1, 10, 50, 100, 200, 500};
+        const int countCount = sizeof (counts) / sizeof (counts[0]);
+        const int frames = 60;
+        const float elapsedTime = 1.0f / 60;
+        const int savedCount = (int) vehicles.size ();
+
+        std::ostringstream header;
+        header << name() << ": ms per frame, serial / parallel ("
+               << WorkerPool::shared().getThreadCount () << " threads)"
+               << std::ends;
+        app.printMessage (header);
+
+        const bool annotation = app.annotationIsOn ();
+        app.setAnnotationOff ();
+
+        for (int c = 0; c < countCount; c++)
+        {
+            setDriverCount (counts[c]);
+            float msPerFrame[2];
+            for (int parallel = 0; parallel < 2; parallel++)
+            {
+                // same starting state for both runs
+                reset ();
+                float currentTime = app.clock.getTotalSimulationTime ();
+                const double start = app.clock.realTimeSinceFirstClockUpdate ();
+                for (int f = 0; f < frames; f++)
+                {
+                    currentTime += elapsedTime;
+                    // driver 0 may print messages: keep it on this thread
+                    vehicle->update (currentTime, elapsedTime);
+                    updateDrivers (1, currentTime, elapsedTime, parallel != 0);
+                }
+                const double end = app.clock.realTimeSinceFirstClockUpdate ();
+                msPerFrame[parallel] = (end - start) * 1000 / frames;
+            }
+
+            std::ostringstream message;
+            message << "  " << std::setw (4) << counts[c] << " drivers: "
+                    << std::setprecision (3) << std::setiosflags (std::ios::fixed)
+                    << msPerFrame[0] << " / " << msPerFrame[1] << std::ends;
+            app.printMessage (message);
+        }
+
+        if (annotation) app.setAnnotationOn ();
+        setDriverCount (savedCount);
+        reset ();
+    }
+
     void reversePathFollowDirection (void)
     {
         int& pfd = vehicle->pathFollowDirection;
         pfd = (pfd > 0) ? -1 : +1;
+        for (size_t i = 1; i < vehicles.size (); i++)
+            vehicles[i]->pathFollowDirection = pfd;
     }
 
     void togglePathFences (void)
@@ -2530,35 +2930,59 @@ public:
         return (int) frandom2 ((float) min, (float) max);
     }
 
+    // the map and route are shared and immutable: build new ones, then
+    // hand them to every driver
     void regenerateMap (void)
     {
-        // regenerate map: clear and add random "rocks"
-        vehicle->map->clear();
-        drawRandomClumpsOfRocksOnMap (*vehicle->map);
-        clearCenterOfMap (*vehicle->map);
+        // regenerate map: new and clear, add random "rocks"
+        TerrainMap* newMap = MapDriver::makeMap ();
+        drawRandomClumpsOfRocksOnMap (*newMap);
+        clearCenterOfMap (*newMap);
 
         // draw fences for first two demo modes
-        if (vehicle->demoSelect < 2) drawBoundaryFencesOnMap (*vehicle->map);
+        if (vehicle->demoSelect < 2) drawBoundaryFencesOnMap (*newMap);
 
         // randomize path widths
+        GCRoute* newPath = new GCRoute (path->pointCount,
+                                        path->points,
+                                        path->radii,
+                                        path->cyclic);
         if (vehicle->demoSelect == 2)
         {
-            const int count = vehicle->path->pointCount;
+            const int count = newPath->pointCount;
             const bool upstream = vehicle->pathFollowDirection > 0;
             const int entryIndex = upstream ? 1 : count-1;
             const int exitIndex  = upstream ? count-1 : 1;
-            const float lastExitRadius = vehicle->path->radii[exitIndex];
+            const float lastExitRadius = newPath->radii[exitIndex];
             for (int i = 1; i < count; i++)
             {
-                 vehicle->path->radii[i] = frandom2 (4, 19);
+                 newPath->radii[i] = frandom2 (4, 19);
             }
-            vehicle->path->radii[entryIndex] = lastExitRadius;
+            newPath->radii[entryIndex] = lastExitRadius;
         }
 
         // mark path-boundary map cells as obstacles
         // (when in path following demo and appropriate mode is set)
         if (usePathFences && (vehicle->demoSelect == 2))
-            drawPathFencesOnMap (*vehicle->map, *vehicle->path);
+            drawPathFencesOnMap (*newMap, *newPath);
+
+        // bring the map's distance field up to date with the new obstacles
+        newMap->updateDistanceField ();
+
+        publishMapAndPath (newMap, GCRouteHandle (newPath));
+    }
+
+    // make a new map and route current for all drivers (the old ones are
+    // released when the last driver lets go of them)
+    void publishMapAndPath (TerrainMap* newMap, const GCRouteHandle& newPath)
+    {
+        map.reset (newMap);
+        path = newPath;
+        for (size_t i = 0; i < vehicles.size (); i++)
+        {
+            vehicles[i]->map = map;
+            vehicles[i]->path = path;
+        }
     }
 
     void drawRandomClumpsOfRocksOnMap (TerrainMap& map)
@@ -2624,7 +3048,7 @@ public:
     }
 
 
-    void drawPathFencesOnMap (TerrainMap& map, GCRoute& path)
+    void drawPathFencesOnMap (TerrainMap& map, const GCRoute& path)
     {
         const float xs = map.xSize / (float)map.resolution;
         const float zs = map.zSize / (float)map.resolution;
@@ -2653,8 +3077,15 @@ public:
 
     const AVGroup& allVehicles (void) {return (const AVGroup&) vehicles;}
 
-    MapDriver* vehicle;
-    std::vector<MapDriver*> vehicles; // for allVehicles
+    MapDriver* vehicle;               // the test vehicle (vehicles[0])
+    std::vector<MapDriver*> vehicles; // all drivers, for allVehicles
+
+    // the map and route shared by all drivers
+    TerrainMapHandle map;
+    GCRouteHandle path;
+
+    // update drivers other than the test vehicle on the WorkerPool
+    bool parallelUpdate;
 
     float initCamDist, initCamElev;
 
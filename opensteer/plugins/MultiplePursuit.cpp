@@ -143,8 +143,9 @@ public:
         // centered around the home base
         const float inner = 20;
         const float outer = 30;
-        const float radius = frandom2 (inner, outer);
-        const Vec3 randomOnRing = RandomUnitVectorOnXZPlane () * radius;
+        const float radius = randomStream.frandom2 (inner, outer);
+        const Vec3 randomOnRing = RandomUnitVectorOnXZPlane (randomStream) *
+                                  radius;
         setPosition (wanderer->position() + randomOnRing);
 
         // randomize 2D heading
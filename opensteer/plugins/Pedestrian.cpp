@@ -40,6 +40,10 @@
 #include "OpenSteer/Pathway.h"
 #include "OpenSteer/SimpleVehicle.h"
 #include "OpenSteer/Proximity.h"
+#include "OpenSteer/ObjectPool.h"
+#include "OpenSteer/UpdateScheduler.h"
+#include "OpenSteer/ActivitySet.h"
+#include "OpenSteer/NeighborList.h"
 #include "OpenSteer/App.h"
 
 #include <iomanip>
@@ -73,6 +77,23 @@ bool gUseDirectedPathFollowing = true;
 // this was added for debugging tool, but I might as well leave it in
 bool gWanderSwitch = true;
 
+// avoid neighbors with reciprocal velocity obstacles (ORCA) rather than
+// by steering away from the most immediate threat
+bool gReciprocalAvoidance = false;
+
+// update pedestrians far from the camera target and the selected pedestrian
+// less often, and without neighbor avoidance in the furthest tier
+bool gLevelOfDetail = false;
+
+// stop and rest on reaching either end of the path (with directed path
+// following), until this is switched off.  Resting pedestrians fall asleep
+// and cost nothing, except for a moment when someone passes close by.
+bool gRestAtPathEnds = false;
+
+// find neighbors from lists cached across frames (Verlet lists) rather
+// than querying the proximity database every frame
+bool gNeighborLists = false;
+
 
 // ----------------------------------------------------------------------------
 
@@ -123,20 +144,29 @@ public:
 
         // set initial position
         // (random point on path + random horizontal offset)
-        const float d = path->getTotalPathLength() * frandom01();
+        const float d = path->getTotalPathLength() * randomStream.frandom01();
         const float r = path->radius;
-        const Vec3 randomOffset = randomVectorOnUnitRadiusXZDisk () * r;
+        const Vec3 randomOffset =
+            randomVectorOnUnitRadiusXZDisk (randomStream) * r;
         setPosition (path->mapPathDistanceToPoint (d) + randomOffset);
 
         // randomize 2D heading
         randomizeHeadingOnXZPlane ();
 
         // pick a random direction for path following (upstream or downstream)
-        pathDirection = (frandom01() > 0.5) ? -1 : +1;
+        pathDirection = (randomStream.frandom01() > 0.5) ? -1 : +1;
 
         // trail parameters: 3 seconds with 60 points along the trail
         setTrailParameters (3, 60);
 
+        // full set of behaviors until the update scheduler says otherwise
+        schedule = UpdateScheduler::Agent ();
+        cheapSteering = false;
+
+        // walking, not resting
+        resting = false;
+        steeringMagnitude = 0;
+
         // notify proximity database that our position has changed
         proximityToken->updateForNewPosition (position());
     }
@@ -144,22 +174,36 @@ public:
     // per frame simulation update
     void update (const float currentTime, const float elapsedTime)
     {
-        // apply steering force to our momentum
-        applySteeringForce (determineCombinedSteering (elapsedTime),
-                            elapsedTime);
+        const Vec3 oldPosition = position ();
+        if (resting)
+        {
+            // brake to a stop
+            const float brakingRate = 4;
+            steeringMagnitude = speed() * brakingRate;
+            applyBrakingForce (brakingRate, elapsedTime);
+        }
+        else
+        {
+            // apply steering force to our momentum
+            const Vec3 steering = determineCombinedSteering (elapsedTime);
+            steeringMagnitude = steering.length ();
+            applySteeringForce (steering, elapsedTime);
+        }
 
-        // reverse direction when we reach an endpoint
+        // reverse direction when we reach an endpoint (and maybe rest)
         if (gUseDirectedPathFollowing)
         {
             const Vec3 darkRed (0.7, 0, 0);
 
             if (Vec3::distance (position(), gEndpoint0) < path->radius)
             {
+                if (pathDirection != +1) resting = gRestAtPathEnds;
                 pathDirection = +1;
                 annotationXZCircle (path->radius, gEndpoint0, darkRed, 20);
             }
             if (Vec3::distance (position(), gEndpoint1) < path->radius)
             {
+                if (pathDirection != -1) resting = gRestAtPathEnds;
                 pathDirection = -1;
                 annotationXZCircle (path->radius, gEndpoint1, darkRed, 20);
             }
@@ -171,6 +215,8 @@ public:
 
         // notify proximity database that our position has changed
         proximityToken->updateForNewPosition (position());
+        if (gNeighborLists)
+            neighborCache.noteMoved (neighborList, oldPosition, position());
     }
 
     // compute combined steering force: move forward, avoid obstacles
@@ -187,7 +233,7 @@ public:
 
         // determine if obstacle avoidance is required
         Vec3 obstacleAvoidance;
-        if (leakThrough < frandom01())
+        if (leakThrough < randomStream.frandom01())
         {
             const float oTime = 6; // minTimeToCollision = 6 seconds
             obstacleAvoidance = steerToAvoidObstacles (oTime, gObstacles);
@@ -198,22 +244,68 @@ public:
         {
             steeringForce += obstacleAvoidance;
         }
+        else if (cheapSteering)
+        {
+            // far from view: no neighbor avoidance, just follow the path
+            steeringForce += steerAlongPath (elapsedTime);
+        }
+        else if (gReciprocalAvoidance)
+        {
+            // path following and wander give a preferred velocity, from
+            // which reciprocal avoidance picks one free of collisions with
+            // the nearest neighbors in the next caLeadTime seconds
+            const float caLeadTime = 3;
+            const Vec3 preferred =
+                (steeringForce + steerAlongPath (elapsedTime)).setYtoZero ();
+            const float timeStep = maxXXX (elapsedTime, 1.0f / 1000);
+            const Vec3 preferredVelocity = preferred.normalize () * maxSpeed();
+            if (gNeighborLists)
+            {
+                findNeighborsInList (caLeadTime);
+                steeringForce =
+                    steerForReciprocalAvoidance (caLeadTime,
+                                                 timeStep,
+                                                 preferredVelocity,
+                                                 neighbors);
+            }
+            else
+            {
+                steeringForce =
+                    steerForReciprocalAvoidance (caLeadTime,
+                                                 timeStep,
+                                                 preferredVelocity,
+                                                 *proximityToken,
+                                                 maxSpeed(),
+                                                 neighbors);
+            }
+        }
         else
         {
             // otherwise consider avoiding collisions with others
             Vec3 collisionAvoidance;
             const float caLeadTime = 3;
 
-            // find all neighbors within maxRadius using proximity database
-            // (radius is largest distance between vehicles traveling head-on
-            // where a collision is possible within caLeadTime seconds.)
-            const float maxRadius = caLeadTime * maxSpeed() * 2;
-            neighbors.clear();
-            proximityToken->findNeighbors (position(), maxRadius, neighbors);
-
-            if (leakThrough < frandom01())
-                collisionAvoidance =
-                    steerToAvoidNeighbors (caLeadTime, neighbors) * 10;
+            // consider the neighbors found by the proximity database within
+            // the largest distance between vehicles where a collision is
+            // possible within caLeadTime seconds (all pedestrians share
+            // the same maximum speed)
+            if (leakThrough < randomStream.frandom01())
+            {
+                if (gNeighborLists)
+                {
+                    findNeighborsInList (caLeadTime);
+                    collisionAvoidance =
+                        steerToAvoidNeighbors (caLeadTime, neighbors) * 10;
+                }
+                else
+                {
+                    collisionAvoidance =
+                        steerToAvoidNeighbors (caLeadTime,
+                                               *proximityToken,
+                                               maxSpeed(),
+                                               neighbors) * 10;
+                }
+            }
 
             // if collision avoidance is needed, do it
             if (collisionAvoidance != Vec3::zero)
@@ -222,19 +314,7 @@ public:
             }
             else
             {
-                // add in wander component (according to user switch)
-                if (gWanderSwitch)
-                    steeringForce += steerForWander (elapsedTime);
-
-                // do (interactively) selected type of path following
-                const float pfLeadTime = 3;
-                const Vec3 pathFollow =
-                    (gUseDirectedPathFollowing ?
-                     steerToFollowPath (pathDirection, pfLeadTime, *path) :
-                     steerToStayOnPath (pfLeadTime, *path));
-
-                // add in to steeringForce
-                steeringForce += pathFollow * 0.5;
+                steeringForce += steerAlongPath (elapsedTime);
             }
         }
 
@@ -242,6 +322,40 @@ public:
         return steeringForce.setYtoZero ();
     }
 
+    // set "neighbors" to those which could come within collision range in
+    // the next caLeadTime seconds, from this pedestrian's neighbor list.
+    // The reach is for both at top speed (all pedestrians share the same
+    // maximum speed), so it does not change from frame to frame.
+    void findNeighborsInList (const float caLeadTime)
+    {
+        const float reach = (radius() * 2) + (maxSpeed() * 2 * caLeadTime);
+        neighbors.clear ();
+        neighborCache.findNeighbors (neighborList,
+                                     *proximityToken,
+                                     position(),
+                                     reach,
+                                     neighbors);
+    }
+
+    // wander (according to user switch) and follow the path
+    Vec3 steerAlongPath (const float elapsedTime)
+    {
+        // add in wander component (according to user switch)
+        Vec3 steeringForce;
+        if (gWanderSwitch)
+            steeringForce += steerForWander (elapsedTime);
+
+        // do (interactively) selected type of path following
+        const float pfLeadTime = 3;
+        const Vec3 pathFollow =
+            (gUseDirectedPathFollowing ?
+             steerToFollowPath (pathDirection, pfLeadTime, *path) :
+             steerToStayOnPath (pfLeadTime, *path));
+
+        // add in to steeringForce
+        return steeringForce + (pathFollow * 0.5);
+    }
+
 
     // draw this pedestrian into scene
     void draw (void)
@@ -335,6 +449,9 @@ public:
 
         // allocate a token for this boid in the proximity database
         proximityToken = pd.allocateToken (this);
+
+        // (sleeping pedestrians will not update it for themselves)
+        proximityToken->updateForNewPosition (position());
     }
 
     // a pointer to this boid's interface object for the proximity database
@@ -353,10 +470,121 @@ public:
 
     // direction for path following (upstream or downstream)
     int pathDirection;
+
+    // level of detail: update schedule, and whether to skip neighbor
+    // avoidance (set by the PlugIn for the lowest tier)
+    UpdateScheduler::Agent schedule;
+    bool cheapSteering;
+
+    // resting at the end of the path, and asleep or not
+    bool resting;
+    ActivityState activity;
+
+    // size of the last steering force, for the ActivitySet
+    float steeringMagnitude;
+
+    // neighbors found by an earlier query, reused while valid, and the
+    // cache deciding when (shared by all pedestrians)
+    NeighborList neighborList;
+    static NeighborListCache neighborCache;
 };
 
 
 AVGroup Pedestrian::neighbors;
+NeighborListCache Pedestrian::neighborCache;
+
+
+// ----------------------------------------------------------------------------
+// a stripped down pedestrian for the crowd benchmark (F7): no path or
+// obstacles, just a preferred velocity across a square of crowd
+
+
+class CrowdBenchmarkAgent : public SimpleVehicle
+{
+public:
+
+    // constructor
+    CrowdBenchmarkAgent (ProximityDatabase& pd,
+                         const Vec3& startPosition,
+                         const Vec3& heading)
+    {
+        // trails are not drawn, keep them small
+        setTrailParameters (1, 2);
+
+        // as Pedestrian
+        setMaxSpeed (2.0);
+        setMaxForce (8.0);
+        setRadius (0.5);
+
+        setPosition (startPosition);
+        regenerateOrthonormalBasisUF (heading);
+        setSpeed (maxSpeed());
+        preferredVelocity = heading * maxSpeed();
+
+        proximityToken = pd.allocateToken (this);
+        proximityToken->updateForNewPosition (position());
+    }
+
+    // destructor
+    ~CrowdBenchmarkAgent ()
+    {
+        delete proximityToken;
+    }
+
+    // decide on steering, by reciprocal avoidance or else as Pedestrian
+    // does: avoid the most immediate threat, otherwise head on
+    void determineSteering (const bool reciprocal, const float elapsedTime)
+    {
+        const float caLeadTime = 3;
+        if (reciprocal)
+        {
+            steering = steerForReciprocalAvoidance (caLeadTime,
+                                                    elapsedTime,
+                                                    preferredVelocity,
+                                                    *proximityToken,
+                                                    maxSpeed(),
+                                                    neighbors);
+        }
+        else
+        {
+            steering = steerToAvoidNeighbors (caLeadTime,
+                                              *proximityToken,
+                                              maxSpeed(),
+                                              neighbors) * 10;
+            if (steering == Vec3::zero)
+                steering = preferredVelocity - velocity();
+        }
+    }
+
+    // apply the steering decided on (after all agents have decided)
+    void update (const float elapsedTime)
+    {
+        applySteeringForce (steering.setYtoZero (), elapsedTime);
+        proximityToken->updateForNewPosition (position());
+    }
+
+    // number of neighbors overlapping this one
+    int countOverlaps (void)
+    {
+        neighbors.clear ();
+        proximityToken->findNeighbors (position(), radius() * 2, neighbors);
+        int overlaps = 0;
+        for (AVIterator i = neighbors.begin(); i != neighbors.end(); i++)
+        {
+            const float d = Vec3::distance (position(), (**i).position());
+            if ((*i != this) && (d < radius() + (**i).radius())) overlaps++;
+        }
+        return overlaps;
+    }
+
+    ProximityToken* proximityToken;
+    Vec3 preferredVelocity;
+    Vec3 steering;
+    static AVGroup neighbors;
+};
+
+
+AVGroup CrowdBenchmarkAgent::neighbors;
 
 
 // ----------------------------------------------------------------------------
@@ -445,6 +673,13 @@ public:
         population = 0;
         for (int i = 0; i < 100; i++) addPedestrianToCrowd ();
 
+        // level of detail tiers: every frame near the viewpoints, every
+        // other frame further out, every fourth (and cheaply) beyond that
+        scheduler.clearTiers ();
+        scheduler.addTier (20, 1);
+        scheduler.addTier (40, 2);
+        scheduler.addTier (FLT_MAX, 4);
+
         // initialize camera and selectedVehicle
         Pedestrian& firstPedestrian = **crowd.begin();
         App::get_singleton()->init3dCamera (firstPedestrian);
@@ -455,13 +690,98 @@ public:
 
     void update (const float currentTime, const float elapsedTime)
     {
-        // update each Pedestrian
+        // Pedestrians to update: all of them, or only those awake
+        const Pedestrian::groupType& active =
+            gRestAtPathEnds ? activity.getAwake () : crowd;
+
+        if (gNeighborLists) Pedestrian::neighborCache.beginFrame ();
+
+        if (gLevelOfDetail)
+        {
+            updateWithLevelOfDetail (active, currentTime, elapsedTime);
+        }
+        else
+        {
+            // update each Pedestrian
+            for (iterator i = active.begin(); i != active.end(); i++)
+            {
+                updatePedestrian (**i, currentTime, elapsedTime);
+            }
+        }
+
+        // put Pedestrians which have come to rest to sleep, wake others
+        if (gRestAtPathEnds) activity.endFrame ();
+    }
+
+    // update a Pedestrian, and when resting is on note whether it is idle
+    // and wake those asleep which it walks up to
+    void updatePedestrian (Pedestrian& p,
+                           const float currentTime,
+                           const float elapsedTime)
+    {
+        p.update (currentTime, elapsedTime);
+        if (gRestAtPathEnds)
+        {
+            activity.noteUpdate (p, p.steeringMagnitude, elapsedTime);
+            activity.wakeNeighbors (p, *p.proximityToken, nearby);
+        }
+    }
+
+    // update the Pedestrians due this frame, by their distance to the
+    // camera target and the selected Pedestrian
+    void updateWithLevelOfDetail (const Pedestrian::groupType& active,
+                                  const float currentTime,
+                                  const float elapsedTime)
+    {
+        App& app = *App::get_singleton();
+        scheduler.clearViewpoints ();
+        scheduler.addViewpoint (app.camera.target);
+        if (app.selectedVehicle)
+            scheduler.addViewpoint (app.selectedVehicle->position());
+        scheduler.beginFrame ();
+
+        const int lowestTier = scheduler.getLowestTier ();
+        for (iterator i = active.begin(); i != active.end(); i++)
+        {
+            Pedestrian& p = **i;
+            float stepTime;
+            if (scheduler.isDue (p.schedule, p.position(),
+                                 elapsedTime, stepTime))
+            {
+                p.cheapSteering = (p.schedule.tier == lowestTier);
+                updatePedestrian (p, currentTime, stepTime);
+            }
+        }
+    }
+
+    // switch level of detail on or off, starting everyone afresh
+    void toggleLevelOfDetail (void)
+    {
+        gLevelOfDetail = !gLevelOfDetail;
         for (iterator i = crowd.begin(); i != crowd.end(); i++)
         {
-            (**i).update (currentTime, elapsedTime);
+            (**i).schedule.pendingTime = 0;
+            (**i).cheapSteering = false;
         }
     }
 
+    // switch neighbor lists on or off, starting them afresh
+    void toggleNeighborLists (void)
+    {
+        gNeighborLists = !gNeighborLists;
+        Pedestrian::neighborCache.invalidate ();
+    }
+
+    // switch resting at path ends on or off, waking everyone
+    void toggleRestAtPathEnds (void)
+    {
+        gRestAtPathEnds = !gRestAtPathEnds;
+        for (iterator i = crowd.begin(); i != crowd.end(); i++)
+            (**i).resting = false;
+        activity.wakeAll ();
+        activity.endFrame ();
+    }
+
     void redraw (const float currentTime, const float elapsedTime)
     {
         // selected Pedestrian (user can mouse click to select another)
@@ -525,6 +845,35 @@ public:
             status << "Stay on the path.";
         status << "\n[F5] Wander: ";
         if (gWanderSwitch) status << "yes"; else status << "no";
+        status << "\n[F6] Avoid neighbors: ";
+        if (gReciprocalAvoidance)
+            status << "reciprocal (ORCA)";
+        else
+            status << "most immediate threat";
+        status << "\n[F8] Level of detail: ";
+        if (gLevelOfDetail)
+        {
+            status << "updated";
+            for (int t = 0; t < scheduler.getTierCount (); t++)
+                status << (t ? " / " : " ")
+                       << scheduler.getUpdatedCount (t) << " of "
+                       << scheduler.getScheduledCount (t);
+        }
+        else
+        {
+            status << "off";
+        }
+        status << "\n[F9] Rest at path ends: ";
+        if (gRestAtPathEnds)
+            status << "yes (" << activity.getSleeping().size() << " asleep)";
+        else
+            status << "no";
+        status << "\n[F10] Neighbor lists: ";
+        if (gNeighborLists)
+            status << Pedestrian::neighborCache.getRebuildCount () << " of "
+                   << Pedestrian::neighborCache.getQueryCount () << " rebuilt";
+        else
+            status << "off";
         status << std::endl;
         const Vec3 screenLocation (10, 50, 0);
         Draw::drawTextAt2dLocation (status, screenLocation, gGray80);
@@ -583,6 +932,9 @@ public:
     {
         // reset each Pedestrian
         for (iterator i = crowd.begin(); i != crowd.end(); i++) (**i).reset ();
+        Pedestrian::neighborCache.invalidate ();
+        activity.wakeAll ();
+        activity.endFrame ();
         // reset camera position
         App::get_singleton()->position2dCamera (*App::get_singleton()->selectedVehicle);
         // make camera jump immediately to new position
@@ -598,6 +950,11 @@ public:
             case 3: nextPD ();                                             break;
             case 4: gUseDirectedPathFollowing = !gUseDirectedPathFollowing; break;
             case 5: gWanderSwitch = !gWanderSwitch;                         break;
+            case 6: gReciprocalAvoidance = !gReciprocalAvoidance;           break;
+            case 7: runCrowdBenchmark ();                                  break;
+            case 8: toggleLevelOfDetail ();                                break;
+            case 9: toggleRestAtPathEnds ();                               break;
+            case 10: toggleNeighborLists ();                               break;
         }
     }
 
@@ -613,6 +970,11 @@ public:
         App::get_singleton()->printMessage ("  F3     use next proximity database.");
         App::get_singleton()->printMessage ("  F4     toggle directed path follow.");
         App::get_singleton()->printMessage ("  F5     toggle wander component on/off.");
+        App::get_singleton()->printMessage ("  F6     toggle reciprocal neighbor avoidance.");
+        App::get_singleton()->printMessage ("  F7     benchmark neighbor avoidance in dense crowds.");
+        App::get_singleton()->printMessage ("  F8     toggle level of detail updates.");
+        App::get_singleton()->printMessage ("  F9     toggle resting (and sleeping) at path ends.");
+        App::get_singleton()->printMessage ("  F10    toggle reusing neighbor queries (Verlet lists).");
         App::get_singleton()->printMessage ("");
     }
 
@@ -620,8 +982,10 @@ public:
     void addPedestrianToCrowd (void)
     {
         population++;
-        Pedestrian* pedestrian = new Pedestrian (*pd);
+        Pedestrian* pedestrian = pedestrianPool.spawn (*pd);
         crowd.push_back (pedestrian);
+        activity.add (pedestrian);
+        Pedestrian::neighborCache.invalidate ();
         if (population == 1) App::get_singleton()->selectedVehicle = pedestrian;
     }
 
@@ -631,16 +995,18 @@ public:
         if (population > 0)
         {
             // save pointer to last pedestrian, then remove it from the crowd
-            const Pedestrian* pedestrian = crowd.back();
+            Pedestrian* pedestrian = crowd.back();
             crowd.pop_back();
+            activity.remove (pedestrian);
             population--;
 
             // if it is OpenSteer::App's selected vehicle, unselect it
             if (pedestrian == App::get_singleton()->selectedVehicle)
                 App::get_singleton()->selectedVehicle = NULL;
 
-            // delete the Pedestrian
-            delete pedestrian;
+            // delete the Pedestrian (freeing its slot for the next one)
+            pedestrianPool.despawn (pedestrian);
+            Pedestrian::neighborCache.invalidate ();
         }
     }
 
@@ -682,6 +1048,101 @@ public:
     }
 
 
+    // time both kinds of neighbor avoidance for crowds of increasing size
+    // at the same density (crossing flows on a square, one agent per
+    // areaPerAgent square meters) and print a table of agents updated per
+    // second, and of overlapping pairs left after the run
+    void runCrowdBenchmark (void)
+    {
+        App& app = *App::get_singleton();
+        const int counts[] = {10000, 30000, 100000};
+        const int countCount = sizeof (counts) / sizeof (counts[0]);
+        const int frames = 10;
+        const float elapsedTime = 1.0f / 60;
+        const float areaPerAgent = 4;
+        const float spacing = sqrtXXX (areaPerAgent);
+
+        const bool annotation = app.annotationIsOn ();
+        app.setAnnotationOff ();
+
+        std::ostringstream header;
+        header << name() << ": agents per second (overlapping pairs after "
+               << frames << " frames), avoid threat / reciprocal" << std::ends;
+        app.printMessage (header);
+
+        for (int c = 0; c < countCount; c++)
+        {
+            // jittered grid of starting positions, heading four ways
+            const int count = counts[c];
+            const int side = (int) ceil (sqrtXXX ((float) count));
+            const float size = side * spacing;
+            std::vector<Vec3> positions (count);
+            std::vector<Vec3> headings (count);
+            const Vec3 ways[4] = {Vec3 (1, 0, 0), Vec3 (-1, 0, 0),
+                                  Vec3 (0, 0, 1), Vec3 (0, 0, -1)};
+            for (int i = 0; i < count; i++)
+            {
+                const Vec3 jitter (frandom2 (-0.4f, 0.4f), 0,
+                                   frandom2 (-0.4f, 0.4f));
+                positions[i] = Vec3 ((i % side) * spacing - (size / 2), 0,
+                                     (i / side) * spacing - (size / 2));
+                positions[i] += jitter;
+                headings[i] = ways[i % 4];
+            }
+
+            float agentsPerSecond[2];
+            int overlaps[2];
+            for (int reciprocal = 0; reciprocal < 2; reciprocal++)
+            {
+                // bins about the size of a neighbor query
+                const float div = size / 10;
+                const float extent = size + 20;
+                typedef LQProximityDatabase<AbstractVehicle*> LQPDAV;
+                LQPDAV database (Vec3::zero,
+                                 Vec3 (extent, extent, extent),
+                                 Vec3 (div, 1, div));
+                ObjectPool<CrowdBenchmarkAgent> pool (1024);
+                std::vector<CrowdBenchmarkAgent*> agents (count);
+                for (int i = 0; i < count; i++)
+                    agents[i] = pool.spawn (database,
+                                            positions[i],
+                                            headings[i]);
+
+                const double start = app.clock.realTimeSinceFirstClockUpdate ();
+                for (int f = 0; f < frames; f++)
+                {
+                    for (int i = 0; i < count; i++)
+                        agents[i]->determineSteering (reciprocal != 0,
+                                                      elapsedTime);
+                    for (int i = 0; i < count; i++)
+                        agents[i]->update (elapsedTime);
+                }
+                const double end = app.clock.realTimeSinceFirstClockUpdate ();
+                const float seconds = (float) (end - start);
+                agentsPerSecond[reciprocal] =
+                    (count * frames) / maxXXX (seconds, 0.000001f);
+
+                overlaps[reciprocal] = 0;
+                for (int i = 0; i < count; i++)
+                {
+                    overlaps[reciprocal] += agents[i]->countOverlaps ();
+                    pool.despawn (agents[i]);
+                }
+                overlaps[reciprocal] /= 2;
+            }
+
+            std::ostringstream message;
+            message << "  " << std::setw (6) << count << " agents: "
+                    << (int) agentsPerSecond[0] << " (" << overlaps[0]
+                    << ") / " << (int) agentsPerSecond[1] << " ("
+                    << overlaps[1] << ")" << std::ends;
+            app.printMessage (message);
+        }
+
+        if (annotation) app.setAnnotationOn ();
+    }
+
+
     const AVGroup& allVehicles (void) {return (const AVGroup&) crowd;}
 
     // crowd: a group (STL vector) of all Pedestrians
@@ -696,6 +1157,16 @@ public:
     int population;
     // which of the various proximity databases is currently in use
     int cyclePD;
+
+    // level of detail: which Pedestrians update each frame (F8)
+    UpdateScheduler scheduler;
+
+    // which Pedestrians are asleep (F9), and scratch space for waking them
+    ActivitySet<Pedestrian> activity;
+    AVGroup nearby;
+
+    // storage for the Pedestrians, reused as they come and go
+    ObjectPool<Pedestrian> pedestrianPool;
 };
 
 
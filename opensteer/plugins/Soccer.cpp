@@ -154,7 +154,8 @@ public:
         setMaxSpeed (10);         // velocity is clipped to this magnitude
 
         // Place me on my part of the field, looking at oponnents goal
-        setPosition(b_ImTeamA ? frandom01()*20 : -frandom01()*20, 0, (frandom01()-0.5)*20);
+        RandomStream& r = randomStream;
+        setPosition(b_ImTeamA ? r.frandom01()*20 : -r.frandom01()*20, 0, (r.frandom01()-0.5)*20);
         if(m_MyID < 9)
             {
             if(b_ImTeamA)
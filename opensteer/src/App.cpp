@@ -44,6 +44,7 @@
 
 #include "OpenSteer/SteerLibrary.h"
 #include "OpenSteer/App.h"
+#include "OpenSteer/Profiler.h"
 
 #include <algorithm>
 #include <string>
@@ -137,12 +138,25 @@ OpenSteer::App::updateSimulationAndRedraw (void)
     //  should be in displayFunc, or somehow account for time outside this
     //  routine)
     initPhaseTimers ();
-    // run selected PlugIn (with simulation's current time and step size)
-    updateSelectedPlugIn (clock.getTotalSimulationTime (),
-                          clock.getElapsedSimulationTime ());
+    // run selected PlugIn (with simulation's current time and step size),
+    // in fixed step mode once for each step due this frame
+    if (clock.getFixedStepMode ())
+    {
+        for (int i = 0; i < clock.getStepsThisFrame (); i++)
+            updateSelectedPlugIn (clock.getStepTime (i),
+                                  clock.getFixedStepSize ());
+    }
+    else
+    {
+        updateSelectedPlugIn (clock.getTotalSimulationTime (),
+                              clock.getElapsedSimulationTime ());
+    }
     // redraw selected PlugIn (based on real time)
     redrawSelectedPlugIn (clock.getTotalRealTime (),
                           clock.getElapsedRealTime ());
+
+    // gather the profiler zones recorded during this frame
+    Profiler::endFrame ();
 }
 
 
@@ -236,6 +250,7 @@ void
 OpenSteer::App::updateSelectedPlugIn (const float currentTime,
                                                 const float elapsedTime)
 {
+    OPENSTEER_PROFILE_ZONE ("update");
     // switch to Update phase
     pushPhase (updatePhase);
     // service queued reset request, if any
@@ -260,6 +275,7 @@ OpenSteer::App::updateSelectedPlugIn (const float currentTime,
 void 
 OpenSteer::App::redrawSelectedPlugIn (const float currentTime, const float elapsedTime)
 {
+    OPENSTEER_PROFILE_ZONE ("redraw");
     // switch to Draw phase
     pushPhase (drawPhase);
     // invoke selected PlugIn's Draw method
@@ -707,7 +723,7 @@ OpenSteer::App::initPhaseTimers (void)
 void 
 OpenSteer::App::updatePhaseTimers (void)
 {
-    const float currentRealTime = clock.realTimeSinceFirstClockUpdate();
+    const double currentRealTime = clock.realTimeSinceFirstClockUpdate();
     phaseTimers[phase] += currentRealTime - phaseTimerBase;
     phaseTimerBase = currentRealTime;
 }
@@ -62,7 +62,7 @@
 #ifdef _WIN32
 # include <windows.h>
 #else
-# include <sys/time.h>
+# include <time.h>
 #endif
 
 
@@ -103,13 +103,27 @@ OpenSteer::Clock::Clock (void)
     // "manually" advance clock by this amount on next update
     newAdvanceTime = 0;
 
-    // "Calendar time" when this clock was first updated
+    // sleep until this long before each frame time, then spin (sleeps on
+    // Windows are in whole milliseconds and often later)
 #ifdef _WIN32
-    basePerformanceCounter = 0;  // from QueryPerformanceCounter on Windows
+    spinTime = 0.002f;
 #else
-    baseRealTimeSec = 0;         // from gettimeofday on Linux and Mac OS X
-    baseRealTimeUsec = 0;
+    spinTime = 0.0005f;
 #endif
+    resetWakeJitter ();
+
+    // fixed step mode is off, 60 steps per second when on
+    fixedStepMode = false;
+    fixedStepRate = 60;
+    maxStepsPerFrame = 5;
+    stepAccumulator = 0;
+    fixedStepTime = 0;
+    stepsThisFrame = 0;
+    droppedSteps = 0;
+
+    // monotonic time when this clock was first updated
+    baseRealTimeSet = false;
+    baseRealTime = 0;
 
     // clock keeps track of "smoothed" running average of recent frame rates.
     // When a fixed frame rate is used, a running average of "CPU load" is
@@ -140,27 +154,28 @@ OpenSteer::Clock::update (void)
     frameRateSync ();
 
     // save previous real time to measure elapsed time
-    const float previousRealTime = totalRealTime;
+    const double previousRealTime = totalRealTime;
 
     // real "wall clock" time since this application was launched
     totalRealTime = realTimeSinceFirstClockUpdate ();
 
     // time since last clock update
-    elapsedRealTime = totalRealTime - previousRealTime;
+    const double realInterval = totalRealTime - previousRealTime;
+    elapsedRealTime = (float) realInterval;
 
     // accumulate paused time
-    if (paused) totalPausedTime += elapsedRealTime;
+    if (paused) totalPausedTime += realInterval;
 
     // save previous simulation time to measure elapsed time
-    const float previousSimulationTime = totalSimulationTime;
+    const double previousSimulationTime = totalSimulationTime;
 
     // update total simulation time
     if (getAnimationMode ())
     {
         // for "animation mode" use fixed frame time, ignore real time
-        const float frameDuration = 1.0f / getFixedFrameRate ();
+        const double frameDuration = 1.0 / getFixedFrameRate ();
         totalSimulationTime += paused ? newAdvanceTime : frameDuration;
-        if (!paused) newAdvanceTime += frameDuration - elapsedRealTime;
+        if (!paused) newAdvanceTime += frameDuration - realInterval;
     }
     else
     {
@@ -175,21 +190,86 @@ OpenSteer::Clock::update (void)
     totalAdvanceTime += newAdvanceTime;
 
     // how much time has elapsed since the last simulation step?
-    elapsedSimulationTime = (paused ?
-                             newAdvanceTime :
-                             (totalSimulationTime - previousSimulationTime));
+    const double simulationInterval = (paused ?
+                                       newAdvanceTime :
+                                       (totalSimulationTime -
+                                        previousSimulationTime));
+    elapsedSimulationTime = (float) simulationInterval;
 
     // reset advance amount
     newAdvanceTime = 0;
+
+    // divide the time that has passed into fixed steps
+    if (fixedStepMode) takeFixedSteps ();
 }
 
 
 // ----------------------------------------------------------------------------
-// "wait" until next frame time (actually spin around this tight loop)
-//
-//
-// (xxx there are probably a smarter ways to do this (using events or
-// thread waits (eg usleep)) but they are likely to be unportable. xxx)
+// fixed step mode: add this frame's simulation time to the accumulator and
+// take whole steps from it, at most maxStepsPerFrame
+
+
+void 
+OpenSteer::Clock::takeFixedSteps (void)
+{
+    const double stepSize = 1.0 / fixedStepRate;
+    stepAccumulator += elapsedSimulationTime;
+    stepsThisFrame = (int) (stepAccumulator / stepSize);
+
+    // more steps due than allowed: drop the excess
+    if (stepsThisFrame > maxStepsPerFrame)
+    {
+        const int excess = stepsThisFrame - maxStepsPerFrame;
+        stepAccumulator -= excess * stepSize;
+        droppedSteps += excess;
+        stepsThisFrame = maxStepsPerFrame;
+    }
+
+    stepAccumulator -= stepsThisFrame * stepSize;
+    fixedStepTime += stepsThisFrame * stepSize;
+}
+
+
+bool 
+OpenSteer::Clock::setFixedStepMode (bool fsm)
+{
+    // steps start from the current simulation time
+    stepAccumulator = 0;
+    fixedStepTime = totalSimulationTime;
+    stepsThisFrame = 0;
+    return fixedStepMode = fsm;
+}
+
+
+// ----------------------------------------------------------------------------
+// "wait" until next frame time: give up the processor until shortly before
+// it, then spin the rest of the way
+
+
+namespace {
+
+    // sleep for (about) this many seconds, perhaps longer
+    void 
+    sleepFor (const float seconds)
+    {
+        if (seconds <= 0) return;
+#ifdef _WIN32
+        Sleep ((DWORD) (seconds * 1000));
+#else
+        timespec duration;
+        duration.tv_sec = (time_t) seconds;
+        duration.tv_nsec = (long) ((seconds - duration.tv_sec) * 1e9f);
+# if defined (__APPLE__)
+        nanosleep (&duration, NULL);
+# else
+        // (an interrupted sleep returns early, which is no harm: the
+        // caller spins until the time it wants)
+        clock_nanosleep (CLOCK_MONOTONIC, 0, &duration, NULL);
+# endif
+#endif
+    }
+
+} // anonymous namespace
 
 
 void 
@@ -200,16 +280,27 @@ OpenSteer::Clock::frameRateSync (void)
     if ((! getAnimationMode ()) && (! getVariableFrameRateMode ()))
     {
         // find next (real time) frame start time
-        const float targetStepSize = 1.0f / getFixedFrameRate ();
-        const float now = realTimeSinceFirstClockUpdate ();
-        const int lastFrameCount = (int) (now / targetStepSize);
-        const float nextFrameTime = (lastFrameCount + 1) * targetStepSize;
+        const double targetStepSize = 1.0 / getFixedFrameRate ();
+        const double now = realTimeSinceFirstClockUpdate ();
+        const double lastFrameCount = floor (now / targetStepSize);
+        const double nextFrameTime = (lastFrameCount + 1) * targetStepSize;
 
         // record usage ("busy time", "non-wait time") for OpenSteerDemo app
-        elapsedNonWaitRealTime = now - totalRealTime;
-
-        // wait until next frame time
-        do {} while (realTimeSinceFirstClockUpdate () < nextFrameTime); 
+        elapsedNonWaitRealTime = (float) (now - totalRealTime);
+
+        // sleep through most of the wait, then spin until next frame time
+        sleepFor ((float) (nextFrameTime - spinTime - now));
+        double wake;
+        do
+        {
+            wake = realTimeSinceFirstClockUpdate ();
+        }
+        while (wake < nextFrameTime);
+
+        // keep track of how late we woke up
+        wakeJitter = (float) (wake - nextFrameTime);
+        blendIntoAccumulator (0.05f, wakeJitter, smoothedWakeJitter);
+        maxWakeJitter = maxXXX (maxWakeJitter, wakeJitter);
     }
 }
 
@@ -222,10 +313,12 @@ OpenSteer::Clock::frameRateSync (void)
 float 
 OpenSteer::Clock::advanceSimulationTimeOneFrame (void)
 {
-    // decide on what frame time is (use fixed rate, average for variable rate)
-    const float fps = (getVariableFrameRateMode () ?
-                       getSmoothedFPS () :
-                       getFixedFrameRate ());
+    // decide on what frame time is (use fixed rate, average for variable rate,
+    // exactly one step in fixed step mode)
+    const float fps = (getFixedStepMode () ? getFixedStepRate () :
+                       (getVariableFrameRateMode () ?
+                        getSmoothedFPS () :
+                        getFixedFrameRate ()));
     const float frameTime = 1 / fps;
 
     // bump advance time
@@ -249,57 +342,74 @@ OpenSteer::Clock::advanceSimulationTime (const float seconds)
 namespace {
 
 // ----------------------------------------------------------------------------
-// Returns the number of seconds of real time (represented as a float) since
-// the clock was first updated.
+// Returns a monotonic time in nanoseconds (from an arbitrary starting point).
 //
 // XXX Need to revisit conditionalization on operating system.
 
 
 
-    float 
+    int64_t 
     clockErrorExit (void)
     {
         OpenSteer::App::get_singleton()->errorExit ("Problem reading system clock.\n");
-        return 0.0f;
+        return 0;
+    }
+
+    int64_t 
+    monotonicNanoseconds (void)
+#ifdef _WIN32
+    {
+        // get time from Windows
+        LONGLONG counter, frequency;
+        bool clockOK =
+            (QueryPerformanceCounter ((LARGE_INTEGER *)&counter)  &&
+             QueryPerformanceFrequency ((LARGE_INTEGER *)&frequency));
+        if (!clockOK) return clockErrorExit ();
+
+        // whole seconds and the remainder separately, to avoid overflow
+        const int64_t seconds = counter / frequency;
+        const int64_t remainder = counter % frequency;
+        return (seconds * 1000000000) + ((remainder * 1000000000) / frequency);
     }
+#else
+    {
+        // get time from Linux (Unix, Mac OS X, ...)
+        timespec t;
+        if (clock_gettime (CLOCK_MONOTONIC, &t) != 0) return clockErrorExit ();
+        return (((int64_t) t.tv_sec) * 1000000000) + t.tv_nsec;
+    }
+#endif
 
 } // anonymous namespace
 
-float 
-OpenSteer::Clock::realTimeSinceFirstClockUpdate (void)
-#ifdef _WIN32
-{
-    // get time from Windows
-    LONGLONG counter, frequency;
-    bool clockOK = (QueryPerformanceCounter ((LARGE_INTEGER *)&counter)  &&
-                    QueryPerformanceFrequency ((LARGE_INTEGER *)&frequency));
-    if (!clockOK) return clockErrorExit ();
 
-    // ensure the base counter is recorded once after launch
-    if (basePerformanceCounter == 0) basePerformanceCounter = counter;
+// ----------------------------------------------------------------------------
+// Returns the number of seconds (nanoseconds) of real time since the clock
+// was first updated.
 
-    // real "wall clock" time since launch
-    const LONGLONG counterDifference = counter - basePerformanceCounter;
-    return ((float) counterDifference) / ((float)frequency);
-}
-#else
+
+int64_t 
+OpenSteer::Clock::realTimeNanosecondsSinceFirstClockUpdate (void)
 {
-    // get time from Linux (Unix, Mac OS X, ...)
-    timeval t;
-    if (gettimeofday (&t, 0) != 0) return clockErrorExit ();
+    const int64_t now = monotonicNanoseconds ();
 
     // ensure the base time is recorded once after launch
-    if (baseRealTimeSec == 0)
+    if (! baseRealTimeSet)
     {
-        baseRealTimeSec = t.tv_sec;
-        baseRealTimeUsec = t.tv_usec;
+        baseRealTime = now;
+        baseRealTimeSet = true;
     }
 
     // real "wall clock" time since launch
-    return (( t.tv_sec  - baseRealTimeSec) +
-            ((t.tv_usec - baseRealTimeUsec) / 1000000.0f));
+    return now - baseRealTime;
+}
+
+
+double 
+OpenSteer::Clock::realTimeSinceFirstClockUpdate (void)
+{
+    return realTimeNanosecondsSinceFirstClockUpdate () * 1e-9;
 }
-#endif
 
 
 // ----------------------------------------------------------------------------
@@ -0,0 +1,386 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// FlowField: grid of directions toward a goal, for mass crowd navigation.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+#include "OpenSteer/FlowField.h"
+#include "OpenSteer/Utilities.h"
+
+
+namespace {
+
+    // the eight neighbors of a cell: orthogonal ones first
+    const int neighborCount = 8;
+    const int neighborI[neighborCount] = {+1, -1,  0,  0, +1, +1, -1, -1};
+    const int neighborJ[neighborCount] = { 0,  0, +1, -1, +1, -1, +1, -1};
+
+    // open list entry: distance to goal and cell
+    typedef std::pair<float, int> OpenEntry;
+    typedef std::priority_queue<OpenEntry,
+                                std::vector<OpenEntry>,
+                                std::greater<OpenEntry> > OpenList;
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// constructor and destructor
+
+
+OpenSteer::FlowField::FlowField (const Vec3& c, float x, float z, int r)
+    : center (c),
+      xSize (x),
+      zSize (z),
+      resolution (r),
+      goalCell (-1),
+      blocked (r * r, 0),
+      distance (r * r, FLT_MAX),
+      next (r * r, -1),
+      direction (r * r, Vec3::zero)
+{
+}
+
+
+OpenSteer::FlowField::~FlowField ()
+{
+}
+
+
+// ----------------------------------------------------------------------------
+// cell addressing, same layout as MapDrive's TerrainMap
+
+
+bool
+OpenSteer::FlowField::cellIndexAt (const Vec3& point, int& i, int& j) const
+{
+    const float hxs = xSize/2;
+    const float hzs = zSize/2;
+    const float x = point.x - center.x;
+    const float z = point.z - center.z;
+
+    if ((x > +hxs) || (x < -hxs) || (z > +hzs) || (z < -hzs)) return false;
+
+    const float r = (float) resolution;
+    i = std::min ((int) remapInterval (x, -hxs, hxs, 0.0f, r), resolution - 1);
+    j = std::min ((int) remapInterval (z, -hzs, hzs, 0.0f, r), resolution - 1);
+    return true;
+}
+
+
+OpenSteer::Vec3
+OpenSteer::FlowField::cellCenter (int i, int j) const
+{
+    const float xs = xSize / (float) resolution;
+    const float zs = zSize / (float) resolution;
+    return center + Vec3 (((i + 0.5f) * xs) - (xSize / 2),
+                          0,
+                          ((j + 0.5f) * zs) - (zSize / 2));
+}
+
+
+// ----------------------------------------------------------------------------
+// editing
+
+
+void
+OpenSteer::FlowField::setBlocked (int i, int j, bool b)
+{
+    const int cell = cellIndex (i, j);
+    if ((blocked[cell] != 0) == b) return;
+    blocked[cell] = b;
+    changedCells.push_back (cell);
+}
+
+
+void
+OpenSteer::FlowField::setBlocked (const Vec3& point, bool b)
+{
+    int i, j;
+    if (cellIndexAt (point, i, j)) setBlocked (i, j, b);
+}
+
+
+void
+OpenSteer::FlowField::setGoal (const Vec3& g)
+{
+    goal = g;
+    int i, j;
+    goalCell = cellIndexAt (goal, i, j) ? cellIndex (i, j) : -1;
+    changedCells.clear ();
+    recompute ();
+}
+
+
+// ----------------------------------------------------------------------------
+// Dijkstra over the grid
+
+
+void
+OpenSteer::FlowField::link (int cell, int to, float d)
+{
+    const int di = (to % resolution) - (cell % resolution);
+    const int dj = (to / resolution) - (cell / resolution);
+    const float xs = xSize / (float) resolution;
+    const float zs = zSize / (float) resolution;
+
+    distance[cell] = d;
+    next[cell] = to;
+    direction[cell] = Vec3 (di * xs, 0, dj * zs).normalize ();
+}
+
+
+int
+OpenSteer::FlowField::propagate (std::vector<int>& seeds)
+{
+    const float xs = xSize / (float) resolution;
+    const float zs = zSize / (float) resolution;
+    const float diagonal = sqrtXXX ((xs * xs) + (zs * zs));
+
+    OpenList open;
+    for (size_t s = 0; s < seeds.size (); s++)
+        open.push (OpenEntry (distance[seeds[s]], seeds[s]));
+
+    int settled = 0;
+    while (! open.empty ())
+    {
+        const float d = open.top().first;
+        const int cell = open.top().second;
+        open.pop ();
+        if (d > distance[cell]) continue; // stale entry
+        settled++;
+
+        const int ci = cell % resolution;
+        const int cj = cell / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = cellIndex (i, j);
+            if (blocked[n]) continue;
+
+            // diagonal steps may not cut across a blocked corner
+            const bool isDiagonal = (k >= 4);
+            if (isDiagonal &&
+                (blocked[cellIndex (i, cj)] || blocked[cellIndex (ci, j)]))
+                continue;
+
+            const float step = isDiagonal ? diagonal : ((k < 2) ? xs : zs);
+            const float nd = d + step;
+            if (nd < distance[n])
+            {
+                link (n, cell, nd);
+                open.push (OpenEntry (nd, n));
+            }
+        }
+    }
+    return settled;
+}
+
+
+void
+OpenSteer::FlowField::recompute (void)
+{
+    std::fill (distance.begin(), distance.end(), FLT_MAX);
+    std::fill (next.begin(), next.end(), -1);
+    std::fill (direction.begin(), direction.end(), Vec3::zero);
+
+    if ((goalCell < 0) || blocked[goalCell]) return;
+
+    distance[goalCell] = 0;
+    std::vector<int> seeds (1, goalCell);
+    propagate (seeds);
+}
+
+
+// ----------------------------------------------------------------------------
+// incremental repair.  Blocking a cell can only lengthen routes, and only
+// those of the cells whose route passed through it (or cut diagonally past
+// its corner): those cells are cleared, then refilled from the intact cells
+// around them.  Opening a cell can only shorten routes, so relaxing from
+// its neighbors is enough.
+
+
+int
+OpenSteer::FlowField::update (void)
+{
+    if (changedCells.empty ()) return 0;
+
+    // a change at the goal itself invalidates everything
+    for (size_t c = 0; c < changedCells.size (); c++)
+    {
+        if (changedCells[c] == goalCell)
+        {
+            changedCells.clear ();
+            recompute ();
+            return resolution * resolution;
+        }
+    }
+
+    // clear the routes which passed through newly blocked cells
+    std::vector<int> cleared;
+    std::vector<int> stack;
+    for (size_t c = 0; c < changedCells.size (); c++)
+    {
+        const int cell = changedCells[c];
+        if (! blocked[cell]) continue;
+        stack.push_back (cell);
+
+        // neighbors whose diagonal step cut past this cell's corner
+        const int ci = cell % resolution;
+        const int cj = cell / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = cellIndex (i, j);
+            const int to = next[n];
+            if ((to < 0) || (to == cell)) continue;
+            const int ti = to % resolution;
+            const int tj = to / resolution;
+            const bool diagonalStep = (ti != i) && (tj != j);
+            if (diagonalStep &&
+                (((ti == ci) && (j == cj)) || ((i == ci) && (tj == cj))))
+                stack.push_back (n);
+        }
+    }
+    while (! stack.empty ())
+    {
+        const int cell = stack.back ();
+        stack.pop_back ();
+        if ((distance[cell] == FLT_MAX) && (next[cell] < 0)) continue;
+
+        // cells routed through this one are cleared too
+        const int ci = cell % resolution;
+        const int cj = cell / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = cellIndex (i, j);
+            if (next[n] == cell) stack.push_back (n);
+        }
+
+        distance[cell] = FLT_MAX;
+        next[cell] = -1;
+        direction[cell] = Vec3::zero;
+        cleared.push_back (cell);
+    }
+
+    // refill from intact neighbors of cleared cells and of opened cells
+    std::vector<int> seeds;
+    for (size_t c = 0; c < cleared.size (); c++) stack.push_back (cleared[c]);
+    for (size_t c = 0; c < changedCells.size (); c++)
+        if (! blocked[changedCells[c]]) stack.push_back (changedCells[c]);
+    for (size_t c = 0; c < stack.size (); c++)
+    {
+        const int ci = stack[c] % resolution;
+        const int cj = stack[c] / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = cellIndex (i, j);
+            if (distance[n] < FLT_MAX) seeds.push_back (n);
+        }
+    }
+
+    changedCells.clear ();
+    return propagate (seeds);
+}
+
+
+// ----------------------------------------------------------------------------
+// sampling: bilinear blend of the directions of the four cells whose
+// centers surround the point.  Within the goal cell, head for the goal.
+
+
+OpenSteer::Vec3
+OpenSteer::FlowField::sampleDirection (const Vec3& point) const
+{
+    int ci, cj;
+    if (! cellIndexAt (point, ci, cj)) return Vec3::zero;
+    if (cellIndex (ci, cj) == goalCell)
+    {
+        const Vec3 toGoal = (goal - point).setYtoZero ();
+        return toGoal.normalize ();
+    }
+
+    // continuous cell coordinates relative to cell centers
+    const float u = (((point.x - center.x) + (xSize / 2)) *
+                     resolution / xSize) - 0.5f;
+    const float v = (((point.z - center.z) + (zSize / 2)) *
+                     resolution / zSize) - 0.5f;
+    const int i0 = (int) floorXXX (u);
+    const int j0 = (int) floorXXX (v);
+    const float fu = u - i0;
+    const float fv = v - j0;
+
+    Vec3 sum;
+    for (int dj = 0; dj <= 1; dj++)
+    {
+        for (int di = 0; di <= 1; di++)
+        {
+            const int i = i0 + di;
+            const int j = j0 + dj;
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const float w = (di ? fu : 1 - fu) * (dj ? fv : 1 - fv);
+            sum += direction[cellIndex (i, j)] * w;
+        }
+    }
+
+    // fall back on the containing cell if the blend cancels out
+    if (sum.lengthSquared () < 1e-6f) return direction[cellIndex (ci, cj)];
+    return sum.normalize ();
+}
+
+
+float
+OpenSteer::FlowField::sampleDistance (const Vec3& point) const
+{
+    int i, j;
+    if (! cellIndexAt (point, i, j)) return FLT_MAX;
+    return distance[cellIndex (i, j)];
+}
@@ -0,0 +1,391 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// IndexedObstacleGroup: an ObstacleGroup with a bounding volume hierarchy.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include "OpenSteer/IndexedObstacleGroup.h"
+#include "OpenSteer/Utilities.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+namespace {
+
+    // leaves hold at most this many items
+    const int maxItemsPerLeaf = 4;
+
+    // the tree is rebuilt when more than this many obstacles (or more
+    // than a quarter of the indexed ones) are pending
+    const size_t minPendingBeforeRebuild = 16;
+
+    // BVH depth is bounded by the median splits: 2^64 items is plenty
+    const int maxTreeDepth = 64;
+
+
+    // box overlap test, for findInBox
+    class BoxOverlapTest
+    {
+    public:
+        BoxOverlapTest (const OpenSteer::Vec3& mn, const OpenSteer::Vec3& mx)
+            : boxMin (mn), boxMax (mx) {}
+
+        bool operator() (const OpenSteer::Vec3& mn,
+                         const OpenSteer::Vec3& mx) const
+        {
+            return ((mn.x <= boxMax.x) && (mx.x >= boxMin.x) &&
+                    (mn.y <= boxMax.y) && (mx.y >= boxMin.y) &&
+                    (mn.z <= boxMax.z) && (mx.z >= boxMin.z));
+        }
+
+    private:
+        const OpenSteer::Vec3 boxMin;
+        const OpenSteer::Vec3 boxMax;
+    };
+
+
+    // does a segment pass through a box grown by "radius" on every side?
+    // (slab test: clip the segment's parameter range to each axis' slab)
+    class CorridorTest
+    {
+    public:
+        CorridorTest (const OpenSteer::Vec3& s,
+                      const OpenSteer::Vec3& e,
+                      const float r)
+            : start (s), delta (e - s), radius (r) {}
+
+        bool operator() (const OpenSteer::Vec3& mn,
+                         const OpenSteer::Vec3& mx) const
+        {
+            float t0 = 0;
+            float t1 = 1;
+            return (clipToSlab (start.x, delta.x, mn.x, mx.x, t0, t1) &&
+                    clipToSlab (start.y, delta.y, mn.y, mx.y, t0, t1) &&
+                    clipToSlab (start.z, delta.z, mn.z, mx.z, t0, t1));
+        }
+
+    private:
+        bool clipToSlab (const float s, const float d,
+                         const float mn, const float mx,
+                         float& t0, float& t1) const
+        {
+            const float lo = mn - radius;
+            const float hi = mx + radius;
+            if (d == 0) return (s >= lo) && (s <= hi);
+            float ta = (lo - s) / d;
+            float tb = (hi - s) / d;
+            if (ta > tb) std::swap (ta, tb);
+            t0 = OpenSteer::maxXXX (t0, ta);
+            t1 = OpenSteer::minXXX (t1, tb);
+            return t0 <= t1;
+        }
+
+        const OpenSteer::Vec3 start;
+        const OpenSteer::Vec3 delta;
+        const float radius;
+    };
+
+
+    // coordinate of a point along an axis (0, 1 or 2 for X, Y or Z)
+    float component (const OpenSteer::Vec3& v, const int axis)
+    {
+        return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z);
+    }
+
+
+    // extent of a box along an axis, for picking the axis to split on:
+    // -1 if the box is unbounded along it (PolygonObstacle is an infinite
+    // prism along Y), whose centers would all be the same
+    float splitExtent (const float boxMin, const float boxMax)
+    {
+        if ((boxMin <= -FLT_MAX) || (boxMax >= FLT_MAX)) return -1;
+        return boxMax - boxMin;
+    }
+
+
+    // the longest bounded axis of a box (0, 1 or 2 for X, Y or Z), or -1
+    // if it is unbounded along all three
+    int longestBoundedAxis (const OpenSteer::Vec3& boxMin,
+                            const OpenSteer::Vec3& boxMax)
+    {
+        const float x = splitExtent (boxMin.x, boxMax.x);
+        const float y = splitExtent (boxMin.y, boxMax.y);
+        const float z = splitExtent (boxMin.z, boxMax.z);
+        if ((x < 0) && (y < 0) && (z < 0)) return -1;
+        return ((x >= y) && (x >= z)) ? 0 : ((y >= z) ? 1 : 2);
+    }
+
+
+    // orders items by the center of their boxes along one axis
+    class CenterLess
+    {
+    public:
+        CenterLess (const int a) : axis (a) {}
+
+        template <class Item>
+        bool operator() (const Item& a, const Item& b) const
+        {
+            return center (a) < center (b);
+        }
+
+    private:
+        template <class Item>
+        float center (const Item& item) const
+        {
+            return component (item.boxMin + item.boxMax, axis);
+        }
+
+        const int axis;
+    };
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// constructors
+
+
+OpenSteer::IndexedObstacleGroup::IndexedObstacleGroup (void)
+{
+}
+
+
+OpenSteer::IndexedObstacleGroup::IndexedObstacleGroup
+(const ObstacleGroup& obstacles)
+{
+    assign (obstacles);
+}
+
+
+// ----------------------------------------------------------------------------
+// changing the set of obstacles
+
+
+void
+OpenSteer::IndexedObstacleGroup::assign (const ObstacleGroup& obstacles)
+{
+    all = obstacles;
+    rebuild ();
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::add (Obstacle* obstacle)
+{
+    all.push_back (obstacle);
+    addItem (obstacle);
+
+    // keep the list of pending (unindexed) obstacles short
+    if ((pending.size () > minPendingBeforeRebuild) &&
+        (pending.size () * 4 > items.size ()))
+        rebuild ();
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::remove (Obstacle* obstacle)
+{
+    const ObstacleGroup::iterator i = std::find (all.begin (), all.end (),
+                                                 obstacle);
+    if (i == all.end ()) return;
+    all.erase (i);
+    rebuild ();
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::clear (void)
+{
+    all.clear ();
+    rebuild ();
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::addItem (Obstacle* obstacle)
+{
+    Item item;
+    item.obstacle = obstacle;
+    if (obstacle->getBounds (item.boxMin, item.boxMax))
+        pending.push_back (item);
+    else
+        unbounded.push_back (obstacle);
+}
+
+
+// ----------------------------------------------------------------------------
+// build the tree: each node's items are split at the median of their box
+// centers along the longest axis of the node's box
+
+
+void
+OpenSteer::IndexedObstacleGroup::rebuild (void)
+{
+    items.clear ();
+    nodes.clear ();
+    pending.clear ();
+    unbounded.clear ();
+
+    for (ObstacleIterator o = all.begin (); o != all.end (); o++)
+        addItem (*o);
+
+    items.swap (pending);
+    if (! items.empty ())
+    {
+        nodes.reserve ((2 * items.size ()) / maxItemsPerLeaf + 1);
+        buildNode (0, (int) items.size ());
+    }
+}
+
+
+int
+OpenSteer::IndexedObstacleGroup::buildNode (int first, int last)
+{
+    const int index = (int) nodes.size ();
+    nodes.push_back (Node ());
+
+    Vec3 boxMin = items[first].boxMin;
+    Vec3 boxMax = items[first].boxMax;
+    for (int i = first + 1; i < last; i++)
+    {
+        const Item& item = items[i];
+        boxMin.set (minXXX (boxMin.x, item.boxMin.x),
+                    minXXX (boxMin.y, item.boxMin.y),
+                    minXXX (boxMin.z, item.boxMin.z));
+        boxMax.set (maxXXX (boxMax.x, item.boxMax.x),
+                    maxXXX (boxMax.y, item.boxMax.y),
+                    maxXXX (boxMax.z, item.boxMax.z));
+    }
+
+    int count = last - first;
+    int second = 0;
+    const int axis = longestBoundedAxis (boxMin, boxMax);
+    if ((count > maxItemsPerLeaf) && (axis != -1))
+    {
+        // never split along an unbounded axis (so a group of polygons
+        // splits on X and Z)
+        assert (splitExtent (component (boxMin, axis),
+                             component (boxMax, axis)) >= 0);
+        const int middle = first + (count / 2);
+        std::nth_element (items.begin () + first,
+                          items.begin () + middle,
+                          items.begin () + last,
+                          CenterLess (axis));
+        buildNode (first, middle);
+        second = buildNode (middle, last);
+        count = 0;
+    }
+
+    // (nodes may have been reallocated by the recursive calls)
+    Node& node = nodes[index];
+    node.boxMin = boxMin;
+    node.boxMax = boxMax;
+    node.first = first;
+    node.count = count;
+    node.second = second;
+    return index;
+}
+
+
+// ----------------------------------------------------------------------------
+// queries
+
+
+template <class BoxTest>
+void
+OpenSteer::IndexedObstacleGroup::find (const BoxTest& test,
+                                       ObstacleGroup& result) const
+{
+    // obstacles without bounds always qualify
+    result.insert (result.end (), unbounded.begin (), unbounded.end ());
+
+    // walk the tree depth first
+    if (! nodes.empty ())
+    {
+        int stack[maxTreeDepth];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node& node = nodes[stack[--top]];
+            if (! test (node.boxMin, node.boxMax)) continue;
+            if (node.count == 0)
+            {
+                stack[top++] = node.second;
+                stack[top++] = (int) (&node - &nodes[0]) + 1;
+            }
+            else
+            {
+                const int end = node.first + node.count;
+                for (int i = node.first; i < end; i++)
+                {
+                    const Item& item = items[i];
+                    if (test (item.boxMin, item.boxMax))
+                        result.push_back (item.obstacle);
+                }
+            }
+        }
+    }
+
+    // then the obstacles added since the tree was built
+    for (size_t i = 0; i < pending.size (); i++)
+    {
+        const Item& item = pending[i];
+        if (test (item.boxMin, item.boxMax)) result.push_back (item.obstacle);
+    }
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::findInBox (const Vec3& boxMin,
+                                            const Vec3& boxMax,
+                                            ObstacleGroup& result) const
+{
+    find (BoxOverlapTest (boxMin, boxMax), result);
+}
+
+
+void
+OpenSteer::IndexedObstacleGroup::findInCorridor (const Vec3& start,
+                                                 const Vec3& end,
+                                                 const float radius,
+                                                 ObstacleGroup& result) const
+{
+    find (CorridorTest (start, end, radius), result);
+}
+
+
+// ----------------------------------------------------------------------------
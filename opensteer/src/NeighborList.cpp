@@ -0,0 +1,146 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+//
+// NeighborList: Verlet neighbor lists, reusing proximity queries across
+// frames.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cassert>
+#include "OpenSteer/NeighborList.h"
+#include "OpenSteer/Profiler.h"
+#include "OpenSteer/Utilities.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+OpenSteer::NeighborListCache::NeighborListCache (const float skin)
+    : skin (skin),
+      generation (0),
+      stale (true),
+      maxMoved (0),
+      maxMovedSquared (0),
+      maxMovedWhenBuilt (0),
+      maxStepSquared (0),
+      rebuilds (0),
+      queries (0)
+{
+}
+
+
+void
+OpenSteer::NeighborListCache::beginFrame (void)
+{
+    // (allowing for agents moving as far this frame as in the last, so
+    // lists are not rebuilt once late in this frame and again in the next)
+    const float lastStep = sqrtXXX (maxStepSquared);
+    maxStepSquared = 0;
+    if (stale || (maxMovedWhenBuilt + maxMoved + lastStep > skin / 2))
+    {
+        generation++;
+        stale = false;
+        maxMoved = 0;
+        maxMovedSquared = 0;
+        maxMovedWhenBuilt = 0;
+    }
+    rebuilds = 0;
+    queries = 0;
+}
+
+
+void
+OpenSteer::NeighborListCache::findNeighbors (NeighborList& list,
+                                             Token& token,
+                                             const Vec3& position,
+                                             const float radius,
+                                             AVGroup& results)
+{
+    queries++;
+    if ((list.generation != generation) ||
+        (radius > list.reach - skin) ||
+        (list.movedWhenBuilt + maxMoved > skin / 2))
+    {
+        OPENSTEER_PROFILE_COUNT ("neighbor lists rebuilt", 1);
+        list.candidates.clear ();
+        list.reach = radius + skin;
+        token.findNeighbors (position, list.reach, list.candidates);
+        list.generation = generation;
+        list.movedWhenBuilt = maxMoved;
+        if (maxMoved > maxMovedWhenBuilt) maxMovedWhenBuilt = maxMoved;
+        rebuilds++;
+    }
+
+    const float r2 = radius * radius;
+    const AVGroup& candidates = list.candidates;
+    for (AVIterator i = candidates.begin(); i != candidates.end(); i++)
+    {
+        const Vec3 offset = (**i).position() - position;
+        if (offset.lengthSquared () < r2) results.push_back (*i);
+    }
+
+#ifdef OPENSTEER_CHECK_NEIGHBOR_LISTS
+    // check against a query of the database: every agent it finds within
+    // the radius must be among the candidates
+    AVGroup queried;
+    token.findNeighbors (position, radius, queried);
+    for (AVIterator i = queried.begin(); i != queried.end(); i++)
+    {
+        const Vec3 offset = (**i).position() - position;
+        assert ((offset.lengthSquared () >= r2) ||
+                (std::find (candidates.begin(), candidates.end(), *i) !=
+                 candidates.end()));
+    }
+#endif
+}
+
+
+void
+OpenSteer::NeighborListCache::noteMoved (NeighborList& list,
+                                         const Vec3& oldPosition,
+                                         const Vec3& newPosition)
+{
+    if (list.anchorGeneration != generation)
+    {
+        list.anchor = oldPosition;
+        list.anchorGeneration = generation;
+    }
+    const float step = (newPosition - oldPosition).lengthSquared ();
+    if (step > maxStepSquared) maxStepSquared = step;
+    const float moved = (newPosition - list.anchor).lengthSquared ();
+    if (moved > maxMovedSquared)
+    {
+        maxMovedSquared = moved;
+        maxMoved = sqrtXXX (moved);
+    }
+}
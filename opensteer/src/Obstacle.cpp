@@ -0,0 +1,726 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// Obstacle shapes: path intersection tests, one at a time and in batches.
+//
+// Each shape's test is a small kernel on plain floats which returns the
+// distance along the path to the first contact, or a negative number when
+// there is none.  The scalar methods call it once and then work out the
+// contact point and normal; the batch versions gather a number of
+// obstacles into arrays (one array per parameter) and run the kernel over
+// all lanes in a branch-free loop, which compilers turn into SIMD code.
+// Kernels compute every candidate result and select among them: square
+// roots of negative numbers give NaN in lanes which are then masked off
+// (so they vectorize when sqrt need not set errno, see SCsub).
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include "OpenSteer/Obstacle.h"
+#include "OpenSteer/Utilities.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+namespace {
+
+    using namespace OpenSteer;
+
+    // obstacles per batch kernel run, and per batch of a shape collected
+    // by findNearestPathIntersection
+    enum {lanes = 8, batchSize = 32};
+
+
+    // path of the sphere grown by the vehicle's radius: where the path
+    // enters it, or leaves it when it starts inside (as the original
+    // SteerLibraryMixin::findNextIntersectionWithSphere)
+    inline float sphereContact (const float px, const float py, const float pz,
+                                const float fx, const float fy, const float fz,
+                                const float cx, const float cy, const float cz,
+                                const float radius)
+    {
+        const float lx = cx - px;
+        const float ly = cy - py;
+        const float lz = cz - pz;
+        const float along = (lx * fx) + (ly * fy) + (lz * fz);
+        const float c = (lx * lx) + (ly * ly) + (lz * lz) - (radius * radius);
+        const float d = (along * along) - c;
+        const float s = sqrtXXX (d);
+        const float far = along + s;
+        const float near = along - s;
+        const float t = (near > 0) ? near : far;
+        return ((d >= 0) && (far >= 0)) ? t : -1;
+    }
+
+
+    // path of a box grown by the vehicle's radius, in the box's local
+    // space (o: path start, d: direction, h: grown half size): slab test,
+    // zero if the path starts inside
+    inline float boxContact (const float ox, const float oy, const float oz,
+                             const float dx, const float dy, const float dz,
+                             const float hx, const float hy, const float hz)
+    {
+        // parameter range of the path within each axis' slab (all or
+        // nothing for a path parallel to the slab)
+        const float big = FLT_MAX;
+        const float ix = 1 / ((dx != 0) ? dx : 1);
+        const float iy = 1 / ((dy != 0) ? dy : 1);
+        const float iz = 1 / ((dz != 0) ? dz : 1);
+        const float ax = (-hx - ox) * ix, bx = (hx - ox) * ix;
+        const float ay = (-hy - oy) * iy, by = (hy - oy) * iy;
+        const float az = (-hz - oz) * iz, bz = (hz - oz) * iz;
+        const bool inX = absXXX (ox) <= hx;
+        const bool inY = absXXX (oy) <= hy;
+        const bool inZ = absXXX (oz) <= hz;
+        const float nx = (dx != 0) ? minXXX (ax, bx) : (inX ? -big : big);
+        const float ny = (dy != 0) ? minXXX (ay, by) : (inY ? -big : big);
+        const float nz = (dz != 0) ? minXXX (az, bz) : (inZ ? -big : big);
+        const float fx = (dx != 0) ? maxXXX (ax, bx) : (inX ? big : -big);
+        const float fy = (dy != 0) ? maxXXX (ay, by) : (inY ? big : -big);
+        const float fz = (dz != 0) ? maxXXX (az, bz) : (inZ ? big : -big);
+        const float near = maxXXX (nx, maxXXX (ny, nz));
+        const float far = minXXX (fx, minXXX (fy, fz));
+        return ((near <= far) && (far >= 0)) ? maxXXX (near, 0) : -1;
+    }
+
+
+    // path of a capsule (segment a-b, radius already grown by the
+    // vehicle's): the first contact with its cylindrical body or either
+    // end sphere, zero if the path starts inside
+    inline float capsuleContact (const float px, const float py, const float pz,
+                                 const float fx, const float fy, const float fz,
+                                 const float ax, const float ay, const float az,
+                                 const float bx, const float by, const float bz,
+                                 const float radius)
+    {
+        const float abx = bx - ax, aby = by - ay, abz = bz - az;
+        const float apx = px - ax, apy = py - ay, apz = pz - az;
+        const float abab = (abx * abx) + (aby * aby) + (abz * abz);
+        const float abf  = (abx * fx) + (aby * fy) + (abz * fz);
+        const float abap = (abx * apx) + (aby * apy) + (abz * apz);
+        const float fap  = (fx * apx) + (fy * apy) + (fz * apz);
+        const float apap = (apx * apx) + (apy * apy) + (apz * apz);
+        const float rr = radius * radius;
+
+        // already within the capsule?
+        const float h = clip (abap / ((abab > 0) ? abab : 1), 0.0f, 1.0f);
+        const float qx = apx - (abx * h);
+        const float qy = apy - (aby * h);
+        const float qz = apz - (abz * h);
+        const bool inside = ((qx * qx) + (qy * qy) + (qz * qz)) <= rr;
+
+        // infinite cylinder around the axis, entered between the ends
+        // (conditions are combined with "&" so there are no branches)
+        const float a = abab - (abf * abf);
+        const float b = (abab * fap) - (abap * abf);
+        const float c = (abab * apap) - (abap * abap) - (rr * abab);
+        const float d = (b * b) - (a * c);
+        const bool axial = a <= (abab * 1e-6f);
+        const float tBody = (-b - sqrtXXX (d)) / (axial ? 1 : a);
+        const float y = abap + (tBody * abf);
+        const bool body = ((! axial) & (d >= 0) & (tBody >= 0) &
+                           (y > 0) & (y < abab));
+
+        // end spheres
+        const float dA = (fap * fap) - (apap - rr);
+        const float tA = -fap - sqrtXXX (dA);
+        const bool capA = (dA >= 0) & (tA >= 0);
+        const float fbp = fap - abf;
+        const float bpbp = apap - (2 * abap) + abab;
+        const float dB = (fbp * fbp) - (bpbp - rr);
+        const float tB = -fbp - sqrtXXX (dB);
+        const bool capB = (dB >= 0) & (tB >= 0);
+
+        const float big = FLT_MAX;
+        const float t = minXXX (body ? tBody : big,
+                                minXXX (capA ? tA : big, capB ? tB : big));
+        return inside ? 0 : ((t < big) ? t : -1);
+    }
+
+
+    // closest point to "point" on the segment from a to b
+    Vec3 closestPointOnSegment (const Vec3& point, const Vec3& a, const Vec3& b)
+    {
+        const Vec3 ab = b - a;
+        const float abab = ab.dot (ab);
+        if (abab == 0) return a;
+        return a + (ab * clip ((point - a).dot (ab) / abab, 0.0f, 1.0f));
+    }
+
+
+    // fill in an intersection found at distance t along a vehicle's path
+    void setContact (Obstacle::PathIntersection& intersection,
+                     const Obstacle* obstacle,
+                     const AbstractVehicle& v,
+                     const float t)
+    {
+        intersection.intersect = true;
+        intersection.distance = t;
+        intersection.surfacePoint = v.position () + (v.forward () * t);
+        intersection.obstacle = obstacle;
+    }
+
+
+    // keep the nearer of two intersections
+    void keepNearer (Obstacle::PathIntersection& nearest,
+                     const Obstacle::PathIntersection& next)
+    {
+        if (next.intersect &&
+            ((! nearest.intersect) || (next.distance < nearest.distance)))
+            nearest = next;
+    }
+
+
+    // run a shape's batch test on the collected obstacles and keep the
+    // nearest (getting its details from the scalar test)
+    template <class Shape>
+    void testBatch (const AbstractVehicle& v,
+                    const Shape* batch[],
+                    int& count,
+                    Obstacle::PathIntersection& nearest)
+    {
+        if (count == 0) return;
+        float distance;
+        const int i = Shape::findNearestIntersection (v, batch, count, distance);
+        if ((i >= 0) && ((! nearest.intersect) || (distance < nearest.distance)))
+        {
+            Obstacle::PathIntersection next;
+            batch[i]->findIntersectionWithVehiclePath (v, next);
+            keepNearer (nearest, next);
+        }
+        count = 0;
+    }
+
+
+    // pick the nearest of one batch kernel run (lanes [0, n) are real)
+    void nearestLane (const float t[], const int n, const int first,
+                      int& nearest, float& distance)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            if ((t[k] >= 0) && ((nearest < 0) || (t[k] < distance)))
+            {
+                nearest = first + k;
+                distance = t[k];
+            }
+        }
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// steering to avoid a contact: the lateral part of the surface normal
+
+
+OpenSteer::Vec3
+OpenSteer::Obstacle::PathIntersection::steerToAvoid
+(const AbstractVehicle& v, const float minDistanceToCollision) const
+{
+    if (intersect && (distance < minDistanceToCollision))
+        return surfaceNormal.perpendicularComponent (v.forward ());
+    else
+        return Vec3::zero;
+}
+
+
+// ----------------------------------------------------------------------------
+// nearest intersection with a group of obstacles
+
+
+void
+OpenSteer::findNearestPathIntersection (const ObstacleGroup& obstacles,
+                                        const AbstractVehicle& v,
+                                        Obstacle::PathIntersection& nearest)
+{
+    nearest = Obstacle::PathIntersection ();
+
+    const SphericalObstacle* spheres[batchSize];
+    const BoxObstacle* boxes[batchSize];
+    const CapsuleObstacle* capsules[batchSize];
+    int sphereCount = 0;
+    int boxCount = 0;
+    int capsuleCount = 0;
+
+    for (ObstacleIterator o = obstacles.begin(); o != obstacles.end(); o++)
+    {
+        switch ((**o).getShapeType ())
+        {
+        case Obstacle::sphereShape:
+            spheres[sphereCount++] = static_cast<SphericalObstacle*> (*o);
+            if (sphereCount == batchSize)
+                testBatch (v, spheres, sphereCount, nearest);
+            break;
+        case Obstacle::boxShape:
+            boxes[boxCount++] = static_cast<BoxObstacle*> (*o);
+            if (boxCount == batchSize)
+                testBatch (v, boxes, boxCount, nearest);
+            break;
+        case Obstacle::capsuleShape:
+            capsules[capsuleCount++] = static_cast<CapsuleObstacle*> (*o);
+            if (capsuleCount == batchSize)
+                testBatch (v, capsules, capsuleCount, nearest);
+            break;
+        default:
+            {
+                Obstacle::PathIntersection next;
+                (**o).findIntersectionWithVehiclePath (v, next);
+                keepNearer (nearest, next);
+            }
+            break;
+        }
+    }
+
+    testBatch (v, spheres, sphereCount, nearest);
+    testBatch (v, boxes, boxCount, nearest);
+    testBatch (v, capsules, capsuleCount, nearest);
+}
+
+
+// ----------------------------------------------------------------------------
+// SphericalObstacle
+
+
+void
+OpenSteer::SphericalObstacle::findIntersectionWithVehiclePath
+(const AbstractVehicle& v, PathIntersection& intersection) const
+{
+    intersection = PathIntersection ();
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float t = sphereContact (p.x, p.y, p.z, f.x, f.y, f.z,
+                                   center.x, center.y, center.z,
+                                   radius + v.radius ());
+    if (t < 0) return;
+    setContact (intersection, this, v, t);
+    intersection.surfaceNormal =
+        (intersection.surfacePoint - center).normalize ();
+}
+
+
+int
+OpenSteer::SphericalObstacle::findNearestIntersection
+(const AbstractVehicle& v,
+ const SphericalObstacle* const o[],
+ const int count,
+ float& distance)
+{
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float r = v.radius ();
+    int nearest = -1;
+    distance = 0;
+
+    for (int first = 0; first < count; first += lanes)
+    {
+        // gather (padding unused lanes with a copy of the first)
+        const int n = minXXX (lanes, count - first);
+        float cx[lanes], cy[lanes], cz[lanes], radius[lanes], t[lanes];
+        for (int k = 0; k < lanes; k++)
+        {
+            const SphericalObstacle& s = *o[first + ((k < n) ? k : 0)];
+            cx[k] = s.center.x;
+            cy[k] = s.center.y;
+            cz[k] = s.center.z;
+            radius[k] = s.radius + r;
+        }
+
+        for (int k = 0; k < lanes; k++)
+            t[k] = sphereContact (p.x, p.y, p.z, f.x, f.y, f.z,
+                                  cx[k], cy[k], cz[k], radius[k]);
+
+        nearestLane (t, n, first, nearest, distance);
+    }
+    return nearest;
+}
+
+
+// ----------------------------------------------------------------------------
+// BoxObstacle
+
+
+OpenSteer::BoxObstacle::BoxObstacle (const Vec3& c, const Vec3& h)
+    : center (c),
+      halfSize (h),
+      side (1, 0, 0),
+      up (0, 1, 0),
+      forward (0, 0, 1),
+      _seenFrom (outside)
+{
+}
+
+
+OpenSteer::BoxObstacle::BoxObstacle (const Vec3& c, const Vec3& h,
+                                     const Vec3& s, const Vec3& u,
+                                     const Vec3& f)
+    : center (c),
+      halfSize (h),
+      side (s),
+      up (u),
+      forward (f),
+      _seenFrom (outside)
+{
+}
+
+
+bool
+OpenSteer::BoxObstacle::getBounds (Vec3& boxMin, Vec3& boxMax) const
+{
+    // extent along each world axis of the oriented box
+    const Vec3 e (absXXX (side.x) * halfSize.x +
+                  absXXX (up.x) * halfSize.y +
+                  absXXX (forward.x) * halfSize.z,
+                  absXXX (side.y) * halfSize.x +
+                  absXXX (up.y) * halfSize.y +
+                  absXXX (forward.y) * halfSize.z,
+                  absXXX (side.z) * halfSize.x +
+                  absXXX (up.z) * halfSize.y +
+                  absXXX (forward.z) * halfSize.z);
+    boxMin = center - e;
+    boxMax = center + e;
+    return true;
+}
+
+
+void
+OpenSteer::BoxObstacle::findIntersectionWithVehiclePath
+(const AbstractVehicle& v, PathIntersection& intersection) const
+{
+    intersection = PathIntersection ();
+    const Vec3 offset = v.position () - center;
+    const Vec3 f = v.forward ();
+    const float r = v.radius ();
+    const Vec3 o (offset.dot (side), offset.dot (up), offset.dot (forward));
+    const Vec3 d (f.dot (side), f.dot (up), f.dot (forward));
+    const Vec3 h (halfSize.x + r, halfSize.y + r, halfSize.z + r);
+    const float t = boxContact (o.x, o.y, o.z, d.x, d.y, d.z, h.x, h.y, h.z);
+    if (t < 0) return;
+    setContact (intersection, this, v, t);
+
+    // normal of the face the contact is on (the axis along which the
+    // contact point is relatively farthest out)
+    const Vec3 q = o + (d * t);
+    const float qx = absXXX (q.x) / h.x;
+    const float qy = absXXX (q.y) / h.y;
+    const float qz = absXXX (q.z) / h.z;
+    const Vec3 axis = (((qx >= qy) && (qx >= qz)) ? side * q.x :
+                       ((qy >= qz) ? up * q.y : forward * q.z));
+    intersection.surfaceNormal = axis.normalize ();
+}
+
+
+OpenSteer::Vec3
+OpenSteer::BoxObstacle::steerToAvoid (const AbstractVehicle& v,
+                                      const float minTimeToCollision) const
+{
+    PathIntersection intersection;
+    findIntersectionWithVehiclePath (v, intersection);
+    return intersection.steerToAvoid (v, minTimeToCollision * v.speed ());
+}
+
+
+int
+OpenSteer::BoxObstacle::findNearestIntersection (const AbstractVehicle& v,
+                                                 const BoxObstacle* const o[],
+                                                 const int count,
+                                                 float& distance)
+{
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float r = v.radius ();
+    int nearest = -1;
+    distance = 0;
+
+    for (int first = 0; first < count; first += lanes)
+    {
+        // gather each box's view of the path, in its local space
+        const int n = minXXX (lanes, count - first);
+        float ox[lanes], oy[lanes], oz[lanes];
+        float dx[lanes], dy[lanes], dz[lanes];
+        float hx[lanes], hy[lanes], hz[lanes], t[lanes];
+        for (int k = 0; k < lanes; k++)
+        {
+            const BoxObstacle& b = *o[first + ((k < n) ? k : 0)];
+            const Vec3 offset = p - b.center;
+            ox[k] = offset.dot (b.side);
+            oy[k] = offset.dot (b.up);
+            oz[k] = offset.dot (b.forward);
+            dx[k] = f.dot (b.side);
+            dy[k] = f.dot (b.up);
+            dz[k] = f.dot (b.forward);
+            hx[k] = b.halfSize.x + r;
+            hy[k] = b.halfSize.y + r;
+            hz[k] = b.halfSize.z + r;
+        }
+
+        for (int k = 0; k < lanes; k++)
+            t[k] = boxContact (ox[k], oy[k], oz[k],
+                               dx[k], dy[k], dz[k],
+                               hx[k], hy[k], hz[k]);
+
+        nearestLane (t, n, first, nearest, distance);
+    }
+    return nearest;
+}
+
+
+// ----------------------------------------------------------------------------
+// PlaneObstacle
+
+
+void
+OpenSteer::PlaneObstacle::findIntersectionWithVehiclePath
+(const AbstractVehicle& v, PathIntersection& intersection) const
+{
+    intersection = PathIntersection ();
+
+    // signed distance of the vehicle from the plane, is that side visible?
+    const float s = (v.position () - point).dot (normal);
+    if ((s > 0) && (seenFrom () == inside)) return;
+    if ((s < 0) && (seenFrom () == outside)) return;
+
+    // speed toward the plane (per unit of distance along the path)
+    const float sign = (s >= 0) ? 1.0f : -1.0f;
+    const float closing = -(v.forward ().dot (normal)) * sign;
+    if (closing <= 0) return;
+
+    const float gap = absXXX (s) - v.radius ();
+    setContact (intersection, this, v, maxXXX (gap, 0) / closing);
+    intersection.surfaceNormal = normal * sign;
+}
+
+
+OpenSteer::Vec3
+OpenSteer::PlaneObstacle::steerToAvoid (const AbstractVehicle& v,
+                                        const float minTimeToCollision) const
+{
+    PathIntersection intersection;
+    findIntersectionWithVehiclePath (v, intersection);
+    return intersection.steerToAvoid (v, minTimeToCollision * v.speed ());
+}
+
+
+// ----------------------------------------------------------------------------
+// CapsuleObstacle
+
+
+bool
+OpenSteer::CapsuleObstacle::getBounds (Vec3& boxMin, Vec3& boxMax) const
+{
+    boxMin.set (minXXX (start.x, end.x) - radius,
+                minXXX (start.y, end.y) - radius,
+                minXXX (start.z, end.z) - radius);
+    boxMax.set (maxXXX (start.x, end.x) + radius,
+                maxXXX (start.y, end.y) + radius,
+                maxXXX (start.z, end.z) + radius);
+    return true;
+}
+
+
+void
+OpenSteer::CapsuleObstacle::findIntersectionWithVehiclePath
+(const AbstractVehicle& v, PathIntersection& intersection) const
+{
+    intersection = PathIntersection ();
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float t = capsuleContact (p.x, p.y, p.z, f.x, f.y, f.z,
+                                    start.x, start.y, start.z,
+                                    end.x, end.y, end.z,
+                                    radius + v.radius ());
+    if (t < 0) return;
+    setContact (intersection, this, v, t);
+    const Vec3& q = intersection.surfacePoint;
+    intersection.surfaceNormal =
+        (q - closestPointOnSegment (q, start, end)).normalize ();
+}
+
+
+OpenSteer::Vec3
+OpenSteer::CapsuleObstacle::steerToAvoid (const AbstractVehicle& v,
+                                          const float minTimeToCollision) const
+{
+    PathIntersection intersection;
+    findIntersectionWithVehiclePath (v, intersection);
+    return intersection.steerToAvoid (v, minTimeToCollision * v.speed ());
+}
+
+
+int
+OpenSteer::CapsuleObstacle::findNearestIntersection
+(const AbstractVehicle& v,
+ const CapsuleObstacle* const o[],
+ const int count,
+ float& distance)
+{
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float r = v.radius ();
+    int nearest = -1;
+    distance = 0;
+
+    for (int first = 0; first < count; first += lanes)
+    {
+        const int n = minXXX (lanes, count - first);
+        float ax[lanes], ay[lanes], az[lanes];
+        float bx[lanes], by[lanes], bz[lanes], radius[lanes], t[lanes];
+        for (int k = 0; k < lanes; k++)
+        {
+            const CapsuleObstacle& c = *o[first + ((k < n) ? k : 0)];
+            ax[k] = c.start.x;
+            ay[k] = c.start.y;
+            az[k] = c.start.z;
+            bx[k] = c.end.x;
+            by[k] = c.end.y;
+            bz[k] = c.end.z;
+            radius[k] = c.radius + r;
+        }
+
+        for (int k = 0; k < lanes; k++)
+            t[k] = capsuleContact (p.x, p.y, p.z, f.x, f.y, f.z,
+                                   ax[k], ay[k], az[k],
+                                   bx[k], by[k], bz[k], radius[k]);
+
+        nearestLane (t, n, first, nearest, distance);
+    }
+    return nearest;
+}
+
+
+// ----------------------------------------------------------------------------
+// PolygonObstacle: each edge, grown by the vehicle's radius, is a capsule
+// lying in the XZ plane, tested against the path projected onto the plane
+
+
+bool
+OpenSteer::PolygonObstacle::getBounds (Vec3& boxMin, Vec3& boxMax) const
+{
+    if (corners.empty ()) return false;
+    boxMin.set (corners[0].x, -FLT_MAX, corners[0].z);
+    boxMax.set (corners[0].x, FLT_MAX, corners[0].z);
+    for (size_t i = 1; i < corners.size (); i++)
+    {
+        boxMin.x = minXXX (boxMin.x, corners[i].x);
+        boxMin.z = minXXX (boxMin.z, corners[i].z);
+        boxMax.x = maxXXX (boxMax.x, corners[i].x);
+        boxMax.z = maxXXX (boxMax.z, corners[i].z);
+    }
+    return true;
+}
+
+
+bool
+OpenSteer::PolygonObstacle::contains (const Vec3& point) const
+{
+    // even-odd rule: count edges crossed by a ray along +X
+    bool in = false;
+    const size_t n = corners.size ();
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        const Vec3& a = corners[i];
+        const Vec3& b = corners[j];
+        if (((a.z > point.z) != (b.z > point.z)) &&
+            (point.x < a.x + ((b.x - a.x) * (point.z - a.z) / (b.z - a.z))))
+            in = !in;
+    }
+    return in;
+}
+
+
+void
+OpenSteer::PolygonObstacle::findIntersectionWithVehiclePath
+(const AbstractVehicle& v, PathIntersection& intersection) const
+{
+    intersection = PathIntersection ();
+    const size_t n = corners.size ();
+    if (n < 2) return;
+
+    // path projected onto the XZ plane: distances along it are scaled by
+    // "flat" relative to distances along the path itself
+    const Vec3 p = v.position ();
+    const Vec3 f = v.forward ();
+    const float flat = sqrtXXX ((f.x * f.x) + (f.z * f.z));
+    const float dx = (flat > 0) ? f.x / flat : 0;
+    const float dz = (flat > 0) ? f.z / flat : 0;
+    const float r = v.radius ();
+
+    float nearest = contains (p) ? 0 : -1;
+    for (size_t i = 0, j = n - 1; (i < n) && (nearest != 0); j = i++)
+    {
+        const Vec3& a = corners[j];
+        const Vec3& b = corners[i];
+        const Vec3 flatP (p.x, 0, p.z);
+        const float t = ((flat > 0) ?
+                         capsuleContact (p.x, 0, p.z, dx, 0, dz,
+                                         a.x, 0, a.z, b.x, 0, b.z, r) :
+                         ((Vec3::distance (flatP,
+                                           closestPointOnSegment
+                                           (flatP,
+                                            Vec3 (a.x, 0, a.z),
+                                            Vec3 (b.x, 0, b.z))) <= r) ?
+                          0 : -1));
+        if ((t >= 0) && ((nearest < 0) || (t < nearest))) nearest = t;
+    }
+    if (nearest < 0) return;
+
+    setContact (intersection, this, v, (flat > 0) ? nearest / flat : 0);
+
+    // normal: away from the edge nearest the contact (outward if the
+    // contact is inside the polygon)
+    const Vec3 q (intersection.surfacePoint.x, 0, intersection.surfacePoint.z);
+    Vec3 away;
+    float awayDistance = FLT_MAX;
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        const Vec3 onEdge =
+            closestPointOnSegment (q,
+                                   Vec3 (corners[j].x, 0, corners[j].z),
+                                   Vec3 (corners[i].x, 0, corners[i].z));
+        const float d = Vec3::distance (q, onEdge);
+        if (d < awayDistance)
+        {
+            awayDistance = d;
+            away = q - onEdge;
+        }
+    }
+    const float sign = contains (q) ? -1.0f : 1.0f;
+    intersection.surfaceNormal = (away * sign).normalize ();
+}
+
+
+OpenSteer::Vec3
+OpenSteer::PolygonObstacle::steerToAvoid (const AbstractVehicle& v,
+                                          const float minTimeToCollision) const
+{
+    PathIntersection intersection;
+    findIntersectionWithVehiclePath (v, intersection);
+    return intersection.steerToAvoid (v, minTimeToCollision * v.speed ());
+}
@@ -0,0 +1,1080 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// OccupancyGrid: bit-packed binary map with word-parallel scans.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cfloat>
+#include <queue>
+#include "OpenSteer/OccupancyGrid.h"
+#include "OpenSteer/Profiler.h"
+#include "OpenSteer/Utilities.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+namespace {
+
+    typedef OpenSteer::OccupancyGrid::Word Word;
+
+    // number of set bits in a word
+    inline int popCount (Word w)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll (w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        return (int) __popcnt64 (w);
+#else
+        int count = 0;
+        for (; w; w &= w - 1) count++;
+        return count;
+#endif
+    }
+
+    // index of the lowest set bit of a (non-zero) word
+    inline int countTrailingZeros (Word w)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll (w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64 (&index, w);
+        return (int) index;
+#else
+        int count = 0;
+        for (; ! (w & 1); w >>= 1) count++;
+        return count;
+#endif
+    }
+
+    // the eight neighbors of a cell
+    const int neighborCount = 8;
+    const int neighborI[neighborCount] = {+1, -1,  0,  0, +1, +1, -1, -1};
+    const int neighborJ[neighborCount] = { 0,  0, +1, -1, +1, -1, +1, -1};
+
+    // open list for distance field propagation: nearest first
+    typedef std::pair<float, int> OpenEntry;
+    typedef std::priority_queue<OpenEntry,
+                                std::vector<OpenEntry>,
+                                std::greater<OpenEntry> > OpenList;
+
+    // clamp a cell index to a range
+    inline int clampCell (int i, int low, int high)
+    {
+        return std::max (low, std::min (i, high));
+    }
+
+    // segment parameter at which a segment starting at grid coordinate
+    // "origin" and moving by "delta" leaves cell "cell" (along one axis)
+    inline float boundaryCrossing (int cell, float origin, float delta)
+    {
+        if (delta == 0) return FLT_MAX;
+        return ((cell + ((delta > 0) ? 1 : 0)) - origin) / delta;
+    }
+
+    // mask of bits "first" through "last" (inclusive) of a word
+    inline Word spanMask (int first, int last)
+    {
+        const Word all = ~((Word) 0);
+        return (all << first) & (all >> (63 - last));
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// constructor and destructor
+
+
+OpenSteer::OccupancyGrid::OccupancyGrid (const Vec3& c,
+                                         float x,
+                                         float z,
+                                         int r)
+    : center (c),
+      xSize (x),
+      zSize (z),
+      resolution (r),
+      outsideValue (false),
+      wordsPerRow ((r + bitsPerWord - 1) / bitsPerWord),
+      distanceFieldEnabled (false),
+      rebuild (false),
+      nearestSite (NULL),
+      clearance (NULL)
+{
+    initialize (NULL);
+}
+
+
+OpenSteer::OccupancyGrid::OccupancyGrid (const Vec3& c,
+                                         float x,
+                                         float z,
+                                         int r,
+                                         const Storage& storage)
+    : center (c),
+      xSize (x),
+      zSize (z),
+      resolution (r),
+      outsideValue (false),
+      wordsPerRow ((r + bitsPerWord - 1) / bitsPerWord),
+      distanceFieldEnabled (false),
+      rebuild (false),
+      nearestSite (NULL),
+      clearance (NULL)
+{
+    initialize (&storage);
+}
+
+
+// set up the cells and pyramid levels, in our own or external storage
+
+
+void
+OpenSteer::OccupancyGrid::initialize (const Storage* storage)
+{
+    if (storage == NULL)
+    {
+        ownedCells.resize (cellWordCount (resolution), 0);
+        ownedPyramid.resize (pyramidWordCount (resolution), 0);
+        cells = &ownedCells[0];
+        pyramid = ownedPyramid.empty () ? NULL : &ownedPyramid[0];
+    }
+    else
+    {
+        cells = storage->cells;
+        pyramid = storage->pyramid;
+        if ((storage->nearestSites != NULL) && (storage->clearances != NULL))
+        {
+            distanceFieldEnabled = true;
+            nearestSite = storage->nearestSites;
+            clearance = storage->clearances;
+        }
+    }
+
+    // coarser pyramid levels follow one another, down to a single cell
+    Word* levelWords = pyramid;
+    for (int lr = resolution; lr > 1;)
+    {
+        lr = (lr + 1) / 2;
+        PyramidLevel level;
+        level.resolution = lr;
+        level.wordsPerRow = (lr + bitsPerWord - 1) / bitsPerWord;
+        level.words = levelWords;
+        levelWords += level.wordsPerRow * lr;
+        levels.push_back (level);
+    }
+}
+
+
+size_t
+OpenSteer::OccupancyGrid::cellWordCount (int r)
+{
+    return (size_t) ((r + bitsPerWord - 1) / bitsPerWord) * r;
+}
+
+
+size_t
+OpenSteer::OccupancyGrid::pyramidWordCount (int r)
+{
+    size_t count = 0;
+    for (int lr = r; lr > 1;)
+    {
+        lr = (lr + 1) / 2;
+        count += cellWordCount (lr);
+    }
+    return count;
+}
+
+
+OpenSteer::OccupancyGrid::~OccupancyGrid ()
+{
+}
+
+
+void
+OpenSteer::OccupancyGrid::clear (void)
+{
+    std::fill (cells, cells + cellWordCount (resolution), 0);
+    std::fill (pyramid, pyramid + pyramidWordCount (resolution), 0);
+    if (distanceFieldEnabled)
+    {
+        changedCells.clear ();
+        rebuild = true;
+    }
+}
+
+
+void
+OpenSteer::OccupancyGrid::readRows (const Word* source)
+{
+    std::copy (source, source + cellWordCount (resolution), cells);
+    rebuildPyramid ();
+    if (distanceFieldEnabled)
+    {
+        changedCells.clear ();
+        rebuild = true;
+    }
+}
+
+
+float
+OpenSteer::OccupancyGrid::minSpacing (void) const
+{
+    return minXXX (xSize, zSize) / (float) resolution;
+}
+
+
+// ----------------------------------------------------------------------------
+// occupancy pyramid upkeep.  Setting a cell sets its blocks at every level
+// (stopping at the first already set).  Clearing one clears its block at
+// the next level only if the rest of the 2x2 block is clear too, and so on
+// up the pyramid.
+
+
+void
+OpenSteer::OccupancyGrid::cellChanged (int i, int j, bool value)
+{
+    if (distanceFieldEnabled) changedCells.push_back (i + (j * resolution));
+
+    for (int k = 1; k < getPyramidLevelCount (); k++)
+    {
+        const int bi = i >> 1;
+        const int bj = j >> 1;
+        if (getPyramidBit (k, bi, bj) == value) break;
+        if (! value)
+        {
+            // any other cell of the 2x2 block below still set?
+            const int below = (k == 1) ? resolution : levels[k - 2].resolution;
+            const int ci = bi << 1;
+            const int cj = bj << 1;
+            bool any = false;
+            for (int n = 0; n < 4; n++)
+            {
+                const int si = ci + (n & 1);
+                const int sj = cj + (n >> 1);
+                if ((si < below) && (sj < below) &&
+                    getPyramidBit (k - 1, si, sj))
+                    any = true;
+            }
+            if (any) break;
+        }
+        setPyramidBit (k, bi, bj, value);
+        i = bi;
+        j = bj;
+    }
+}
+
+
+void
+OpenSteer::OccupancyGrid::setPyramidBit (int level, int i, int j, bool value)
+{
+    PyramidLevel& l = levels[level - 1];
+    Word& w = l.words[(j * l.wordsPerRow) + (i / bitsPerWord)];
+    const Word mask = ((Word) 1) << (i % bitsPerWord);
+    if (value) w |= mask; else w &= ~mask;
+}
+
+
+void
+OpenSteer::OccupancyGrid::rebuildPyramid (void)
+{
+    int below = resolution;
+    for (int k = 1; k < getPyramidLevelCount (); k++)
+    {
+        PyramidLevel& l = levels[k - 1];
+        std::fill (l.words, l.words + cellWordCount (l.resolution), 0);
+        for (int j = 0; j < below; j++)
+            for (int i = 0; i < below; i++)
+                if (getPyramidBit (k - 1, i, j))
+                    setPyramidBit (k, i >> 1, j >> 1, true);
+        below = l.resolution;
+    }
+}
+
+
+int
+OpenSteer::OccupancyGrid::emptyBlockLevel (int i, int j) const
+{
+    int k = 0;
+    while (((k + 1) < getPyramidLevelCount ()) &&
+           ! getPyramidBit (k + 1, i >> (k + 1), j >> (k + 1)))
+        k++;
+    return k;
+}
+
+
+// ----------------------------------------------------------------------------
+// single cell access by world position
+
+
+bool
+OpenSteer::OccupancyGrid::cellIndexAt (const Vec3& point, int& i, int& j) const
+{
+    const float hxs = xSize/2;
+    const float hzs = zSize/2;
+    const float x = point.x - center.x;
+    const float z = point.z - center.z;
+
+    if ((x > +hxs) || (x < -hxs) || (z > +hzs) || (z < -hzs)) return false;
+
+    const float r = (float) resolution;
+    i = std::min ((int) remapInterval (x, -hxs, hxs, 0.0f, r), resolution - 1);
+    j = std::min ((int) remapInterval (z, -hzs, hzs, 0.0f, r), resolution - 1);
+    return true;
+}
+
+
+bool
+OpenSteer::OccupancyGrid::getValue (const Vec3& point) const
+{
+    int i, j;
+    if (! cellIndexAt (point, i, j)) return outsideValue;
+    return getBit (i, j);
+}
+
+
+// ----------------------------------------------------------------------------
+// row spans: whole words at a time
+
+
+bool
+OpenSteer::OccupancyGrid::anyInRowSpan (int j, int i0, int i1) const
+{
+    if (i0 > i1) return false;
+    if ((j < 0) || (j >= resolution) || (i0 < 0) || (i1 >= resolution))
+    {
+        if (outsideValue) return true;
+        if ((j < 0) || (j >= resolution)) return false;
+        i0 = std::max (i0, 0);
+        i1 = std::min (i1, resolution - 1);
+        if (i0 > i1) return false;
+    }
+
+    const Word* row = rowWords (j);
+    const int w0 = i0 / bitsPerWord;
+    const int w1 = i1 / bitsPerWord;
+    for (int w = w0; w <= w1; w++)
+    {
+        const int first = (w == w0) ? (i0 % bitsPerWord) : 0;
+        const int last = (w == w1) ? (i1 % bitsPerWord) : (bitsPerWord - 1);
+        if (row[w] & spanMask (first, last)) return true;
+    }
+    return false;
+}
+
+
+int
+OpenSteer::OccupancyGrid::countInRowSpan (int j, int i0, int i1) const
+{
+    if (i0 > i1) return 0;
+    if ((j < 0) || (j >= resolution))
+        return outsideValue ? (i1 - i0 + 1) : 0;
+
+    int count = 0;
+    if (outsideValue)
+    {
+        count += std::max (0, std::min (i1, -1) - i0 + 1);
+        count += std::max (0, i1 - std::max (i0, resolution) + 1);
+    }
+    i0 = std::max (i0, 0);
+    i1 = std::min (i1, resolution - 1);
+    if (i0 > i1) return count;
+
+    const Word* row = rowWords (j);
+    const int w0 = i0 / bitsPerWord;
+    const int w1 = i1 / bitsPerWord;
+    for (int w = w0; w <= w1; w++)
+    {
+        const int first = (w == w0) ? (i0 % bitsPerWord) : 0;
+        const int last = (w == w1) ? (i1 % bitsPerWord) : (bitsPerWord - 1);
+        count += popCount (row[w] & spanMask (first, last));
+    }
+    return count;
+}
+
+
+int
+OpenSteer::OccupancyGrid::firstInRowSpan (int j, int i0, int i1) const
+{
+    if ((j < 0) || (j >= resolution)) return -1;
+    i0 = std::max (i0, 0);
+    i1 = std::min (i1, resolution - 1);
+    if (i0 > i1) return -1;
+
+    const Word* row = rowWords (j);
+    const int w0 = i0 / bitsPerWord;
+    const int w1 = i1 / bitsPerWord;
+    for (int w = w0; w <= w1; w++)
+    {
+        const int first = (w == w0) ? (i0 % bitsPerWord) : 0;
+        const int last = (w == w1) ? (i1 % bitsPerWord) : (bitsPerWord - 1);
+        const Word bits = row[w] & spanMask (first, last);
+        if (bits) return (w * bitsPerWord) + countTrailingZeros (bits);
+    }
+    return -1;
+}
+
+
+// ----------------------------------------------------------------------------
+// rectangles: start at the pyramid level where the rectangle covers at most
+// 2x2 blocks, and descend only into blocks which are not empty
+
+
+bool
+OpenSteer::OccupancyGrid::anyInRect (int i0, int j0, int i1, int j1) const
+{
+    if ((i0 > i1) || (j0 > j1)) return false;
+    if ((i0 < 0) || (j0 < 0) || (i1 >= resolution) || (j1 >= resolution))
+    {
+        if (outsideValue) return true;
+        i0 = std::max (i0, 0);
+        j0 = std::max (j0, 0);
+        i1 = std::min (i1, resolution - 1);
+        j1 = std::min (j1, resolution - 1);
+        if ((i0 > i1) || (j0 > j1)) return false;
+    }
+
+    int k = 0;
+    while (((k + 1) < getPyramidLevelCount ()) &&
+           ((((i1 >> k) - (i0 >> k)) > 1) || (((j1 >> k) - (j0 >> k)) > 1)))
+        k++;
+    return anyInBlocks (k, i0 >> k, j0 >> k, i1 >> k, j1 >> k, i0, j0, i1, j1);
+}
+
+
+bool
+OpenSteer::OccupancyGrid::anyInBlocks (int level,
+                                       int bi0, int bj0, int bi1, int bj1,
+                                       int i0, int j0, int i1, int j1) const
+{
+    for (int bj = bj0; bj <= bj1; bj++)
+    {
+        for (int bi = bi0; bi <= bi1; bi++)
+        {
+            if (! getPyramidBit (level, bi, bj)) continue;
+            if (level == 0) return true;
+
+            // a non-empty block entirely inside the rectangle: done
+            const int ci0 = bi << level;
+            const int cj0 = bj << level;
+            const int ci1 = std::min (((bi + 1) << level) - 1, resolution - 1);
+            const int cj1 = std::min (((bj + 1) << level) - 1, resolution - 1);
+            if ((ci0 >= i0) && (cj0 >= j0) && (ci1 <= i1) && (cj1 <= j1))
+                return true;
+
+            // otherwise look at the blocks below which overlap it
+            const int k = level - 1;
+            if (anyInBlocks (k,
+                             std::max (bi << 1, i0 >> k),
+                             std::max (bj << 1, j0 >> k),
+                             std::min ((bi << 1) + 1, i1 >> k),
+                             std::min ((bj << 1) + 1, j1 >> k),
+                             i0, j0, i1, j1))
+                return true;
+        }
+    }
+    return false;
+}
+
+
+bool
+OpenSteer::OccupancyGrid::anyInXZBox (const Vec3& boxMin,
+                                      const Vec3& boxMax) const
+{
+    OPENSTEER_PROFILE_ZONE ("map scan");
+    const float left = center.x - (xSize / 2);
+    const float bottom = center.z - (zSize / 2);
+    return anyInRect ((int) floorXXX ((boxMin.x - left) / cellXSize ()),
+                      (int) floorXXX ((boxMin.z - bottom) / cellZSize ()),
+                      (int) floorXXX ((boxMax.x - left) / cellXSize ()),
+                      (int) floorXXX ((boxMax.z - bottom) / cellZSize ()));
+}
+
+
+// ----------------------------------------------------------------------------
+// convex polygon: if its bounding box is empty so is the polygon, else for
+// each row it crosses, find the X extent of the part of the polygon within
+// that row's strip and test it as one row span
+
+
+bool
+OpenSteer::OccupancyGrid::anyInXZPolygon (const Vec3 corners[],
+                                          int cornerCount) const
+{
+    OPENSTEER_PROFILE_ZONE ("map scan");
+    const float left = center.x - (xSize / 2);
+    const float bottom = center.z - (zSize / 2);
+    const float cx = cellXSize ();
+    const float cz = cellZSize ();
+
+    // bounding box of the polygon
+    Vec3 boxMin (FLT_MAX, 0, FLT_MAX);
+    Vec3 boxMax (-FLT_MAX, 0, -FLT_MAX);
+    for (int c = 0; c < cornerCount; c++)
+    {
+        boxMin.x = minXXX (boxMin.x, corners[c].x);
+        boxMin.z = minXXX (boxMin.z, corners[c].z);
+        boxMax.x = maxXXX (boxMax.x, corners[c].x);
+        boxMax.z = maxXXX (boxMax.z, corners[c].z);
+    }
+    if (! anyInXZBox (boxMin, boxMax)) return false;
+
+    // Z extent of the polygon, in rows
+    const float zMin = boxMin.z;
+    const float zMax = boxMax.z;
+    const int j0 = (int) floorXXX ((zMin - bottom) / cz);
+    const int j1 = (int) floorXXX ((zMax - bottom) / cz);
+    if (outsideValue && ((j0 < 0) || (j1 >= resolution))) return true;
+
+    for (int j = std::max (j0, 0); j <= std::min (j1, resolution - 1); j++)
+    {
+        const float stripLow = maxXXX (bottom + (j * cz), zMin);
+        const float stripHigh = minXXX (bottom + ((j + 1) * cz), zMax);
+
+        // X extent of each polygon edge clipped to this strip
+        float xMin = FLT_MAX;
+        float xMax = -FLT_MAX;
+        for (int c = 0; c < cornerCount; c++)
+        {
+            const Vec3& a = corners[c];
+            const Vec3& b = corners[(c + 1) % cornerCount];
+            const float edgeLow = minXXX (a.z, b.z);
+            const float edgeHigh = maxXXX (a.z, b.z);
+            if ((edgeHigh < stripLow) || (edgeLow > stripHigh)) continue;
+
+            const float dz = b.z - a.z;
+            if (dz == 0)
+            {
+                xMin = minXXX (xMin, minXXX (a.x, b.x));
+                xMax = maxXXX (xMax, maxXXX (a.x, b.x));
+                continue;
+            }
+            const float t0 = clip ((stripLow - a.z) / dz, 0, 1);
+            const float t1 = clip ((stripHigh - a.z) / dz, 0, 1);
+            const float x0 = a.x + ((b.x - a.x) * t0);
+            const float x1 = a.x + ((b.x - a.x) * t1);
+            xMin = minXXX (xMin, minXXX (x0, x1));
+            xMax = maxXXX (xMax, maxXXX (x0, x1));
+        }
+        if (xMin > xMax) continue;
+
+        const int i0 = (int) floorXXX ((xMin - left) / cx);
+        const int i1 = (int) floorXXX ((xMax - left) / cx);
+        if (anyInRowSpan (j, i0, i1)) return true;
+    }
+    return false;
+}
+
+
+// ----------------------------------------------------------------------------
+// segment scan: clip the segment to the grid, then step from cell to cell
+// across whichever cell boundary the segment reaches next (Amanatides and
+// Woo's "fast voxel traversal").  Every cell the segment passes through is
+// visited once, however long or short its stay in that cell, except those
+// leapt over using the distance field or the occupancy pyramid.
+
+
+bool
+OpenSteer::OccupancyGrid::scanXZSegment (const Vec3& from,
+                                         const Vec3& to,
+                                         float& hitDistance) const
+{
+    OPENSTEER_PROFILE_ZONE ("map scan");
+    const float cx = cellXSize ();
+    const float cz = cellZSize ();
+    const float u0 = (from.x - (center.x - (xSize / 2))) / cx;
+    const float v0 = (from.z - (center.z - (zSize / 2))) / cz;
+    const float du = (to.x - from.x) / cx;
+    const float dv = (to.z - from.z) / cz;
+    const float segmentLength = (to - from).setYtoZero().length ();
+    const float r = (float) resolution;
+
+    // clip parameter range [0, 1] to the grid (Liang-Barsky)
+    float tEnter = 0;
+    float tExit = 1;
+    const float p[4] = {-du, du, -dv, dv};
+    const float q[4] = {u0, r - u0, v0, r - v0};
+    for (int k = 0; k < 4; k++)
+    {
+        if (p[k] == 0)
+        {
+            if (q[k] < 0) {tEnter = 1; tExit = 0; break;} // parallel, outside
+        }
+        else
+        {
+            const float t = q[k] / p[k];
+            if (p[k] < 0) tEnter = maxXXX (tEnter, t);
+            else          tExit  = minXXX (tExit, t);
+        }
+    }
+
+    // starting (or lying entirely) outside the grid
+    if ((tEnter > 0) || (tEnter > tExit))
+    {
+        if (outsideValue) {hitDistance = 0; return true;}
+        if (tEnter > tExit) return false;
+    }
+
+    // with a current distance field, leap across open space: from a point
+    // with clearance c the next c of the segment cannot hit anything
+    const bool leap = isDistanceFieldCurrent () && (segmentLength > 0);
+    const float minLeap = minSpacing ();
+
+    // starting cell
+    float tCell = tEnter;
+    int i = clampCell ((int) floorXXX (u0 + (du * tCell)), 0, resolution - 1);
+    int j = clampCell ((int) floorXXX (v0 + (dv * tCell)), 0, resolution - 1);
+
+    // parameter of the next cell boundary crossing along each axis, and
+    // the parameter increment between crossings
+    const int stepI = (du > 0) ? 1 : -1;
+    const int stepJ = (dv > 0) ? 1 : -1;
+    float tMaxI = boundaryCrossing (i, u0, du);
+    float tMaxJ = boundaryCrossing (j, v0, dv);
+    const float tDeltaI = (du != 0) ? 1 / absXXX (du) : FLT_MAX;
+    const float tDeltaJ = (dv != 0) ? 1 / absXXX (dv) : FLT_MAX;
+
+    while (true)
+    {
+        if (getBit (i, j))
+        {
+            hitDistance = tCell * segmentLength;
+            return true;
+        }
+
+        // leap by the clearance of this point
+        const float c = leap ? clearanceAt (interpolate (tCell, from, to)) : 0;
+        if (c > minLeap)
+        {
+            tCell += c / segmentLength;
+            if (tCell >= tExit) break;
+            i = clampCell ((int) floorXXX (u0 + (du * tCell)), 0, resolution-1);
+            j = clampCell ((int) floorXXX (v0 + (dv * tCell)), 0, resolution-1);
+            tMaxI = boundaryCrossing (i, u0, du);
+            tMaxJ = boundaryCrossing (j, v0, dv);
+            continue;
+        }
+
+        // or leap to the far side of the largest empty pyramid block
+        // containing this cell, into the neighboring cell across it
+        const int k = emptyBlockLevel (i, j);
+        if (k > 0)
+        {
+            const int bi0 = (i >> k) << k;
+            const int bj0 = (j >> k) << k;
+            const int bi1 = std::min (bi0 + (1 << k), resolution);
+            const int bj1 = std::min (bj0 + (1 << k), resolution);
+            const float tI = (du != 0) ? (((du > 0) ? bi1 : bi0) - u0) / du : FLT_MAX;
+            const float tJ = (dv != 0) ? (((dv > 0) ? bj1 : bj0) - v0) / dv : FLT_MAX;
+            if (minXXX (tI, tJ) >= tExit) break;
+            if (tI < tJ)
+            {
+                tCell = tI;
+                i = (du > 0) ? bi1 : (bi0 - 1);
+                j = clampCell ((int) floorXXX (v0 + (dv * tCell)), bj0, bj1 - 1);
+            }
+            else
+            {
+                tCell = tJ;
+                j = (dv > 0) ? bj1 : (bj0 - 1);
+                i = clampCell ((int) floorXXX (u0 + (du * tCell)), bi0, bi1 - 1);
+            }
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                break;
+            tMaxI = boundaryCrossing (i, u0, du);
+            tMaxJ = boundaryCrossing (j, v0, dv);
+            continue;
+        }
+
+        // otherwise step into the next cell
+        if (tMaxI < tMaxJ)
+        {
+            if (tMaxI >= tExit) break;
+            tCell = tMaxI;
+            tMaxI += tDeltaI;
+            i += stepI;
+        }
+        else
+        {
+            if (tMaxJ >= tExit) break;
+            tCell = tMaxJ;
+            tMaxJ += tDeltaJ;
+            j += stepJ;
+        }
+        if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+            break;
+    }
+
+    // leaving the grid before reaching "to"
+    if (outsideValue && (tExit < 1))
+    {
+        hitDistance = tExit * segmentLength;
+        return true;
+    }
+    return false;
+}
+
+
+// ----------------------------------------------------------------------------
+// batched arc scans.  Each lane follows one arc: its spoke is rotated by
+// the arc's step (as Vec3::rotateAboutGlobalY does) and scaled, giving a
+// sample point, whose cell index is then found exactly as cellIndexAt
+// would.  The lane loops have a fixed trip count and no branches so they
+// can be vectorized, only the cell fetches are done lane by lane.
+
+
+OpenSteer::Vec3
+OpenSteer::OccupancyGrid::XZArc::samplePoint (int i) const
+{
+    if (i < 0) return center + spoke;
+    const float t = (float) (i + 1) / (float) sampleCount;
+    const float scale = interpolate (t, 1.0f, endScale);
+    return center + (spoke.rotateAboutGlobalY (angleStep * (i + 1)) * scale);
+}
+
+
+void
+OpenSteer::OccupancyGrid::scanXZArcs (const XZArc arcs[],
+                                      int arcCount,
+                                      int firstHit[]) const
+{
+    OPENSTEER_PROFILE_ZONE ("map scan");
+    const int lanes = 16;
+    const float hxs = xSize/2;
+    const float hzs = zSize/2;
+    const float r = (float) resolution;
+    const float lastCell = (float) (resolution - 1);
+
+    int next = 0;
+    while (next < arcCount)
+    {
+        // fill lanes with arcs which have something to find
+        int arc[lanes];
+        float cx[lanes], cz[lanes], sx[lanes], sz[lanes];
+        float sn[lanes], cs[lanes], endScale[lanes], samples[lanes];
+        int sampleCount[lanes];
+        int used = 0;
+        int longest = 0;
+        for (; (next < arcCount) && (used < lanes); next++)
+        {
+            const XZArc& a = arcs[next];
+            firstHit[next] = -1;
+            if (a.sampleCount <= 0) continue;
+
+            // the whole arc lies within its length (plus any change in
+            // radius) of its start: skip it if the map is empty there
+            const float spokeLength = a.spoke.length ();
+            const float reach =
+                spokeLength * ((absXXX (a.angleStep) * a.sampleCount) +
+                               absXXX (a.endScale - 1));
+            const Vec3 start = a.center + a.spoke;
+            const Vec3 box (reach, 0, reach);
+            if (! anyInXZBox (start - box, start + box)) continue;
+
+            arc[used] = next;
+            cx[used] = a.center.x;
+            cz[used] = a.center.z;
+            sx[used] = a.spoke.x;
+            sz[used] = a.spoke.z;
+            sn[used] = sinXXX (a.angleStep);
+            cs[used] = cosXXX (a.angleStep);
+            endScale[used] = a.endScale;
+            samples[used] = (float) a.sampleCount;
+            sampleCount[used] = a.sampleCount;
+            longest = std::max (longest, a.sampleCount);
+            used++;
+        }
+
+        // unused lanes just idle at the origin
+        for (int k = used; k < lanes; k++)
+        {
+            cx[k] = cz[k] = sx[k] = sz[k] = sn[k] = 0;
+            cs[k] = endScale[k] = samples[k] = 1;
+            sampleCount[k] = 0;
+        }
+
+        // step all lanes along their arcs together
+        bool active[lanes];
+        for (int k = 0; k < lanes; k++) active[k] = k < used;
+        int activeCount = used;
+        for (int i = 0; (i < longest) && (activeCount > 0); i++)
+        {
+            int ci[lanes], cj[lanes];
+            bool inside[lanes];
+            const float step = (float) (i + 1);
+            for (int k = 0; k < lanes; k++)
+            {
+                const float x = (sx[k] * cs[k]) + (sz[k] * sn[k]);
+                const float z = (sz[k] * cs[k]) - (sx[k] * sn[k]);
+                sx[k] = x;
+                sz[k] = z;
+                const float scale = 1 + ((endScale[k] - 1) * (step / samples[k]));
+                const float px = (cx[k] + (x * scale)) - center.x;
+                const float pz = (cz[k] + (z * scale)) - center.z;
+                inside[k] = ((px <= +hxs) & (px >= -hxs) &
+                             (pz <= +hzs) & (pz >= -hzs));
+                const float u = r * ((px + hxs) / (hxs + hxs));
+                const float v = r * ((pz + hzs) / (hzs + hzs));
+                ci[k] = (int) clip (u, 0, lastCell);
+                cj[k] = (int) clip (v, 0, lastCell);
+            }
+
+            for (int k = 0; k < used; k++)
+            {
+                if (! active[k]) continue;
+                const bool set = inside[k] ? getBit (ci[k], cj[k]) : outsideValue;
+                if (set) firstHit[arc[k]] = i;
+                if (set || (i + 1 >= sampleCount[k]))
+                {
+                    active[k] = false;
+                    activeCount--;
+                }
+            }
+        }
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// distance field
+
+
+void
+OpenSteer::OccupancyGrid::setDistanceFieldEnabled (bool enable)
+{
+    distanceFieldEnabled = enable;
+    changedCells.clear ();
+    if (enable)
+    {
+        ownedNearestSite.resize (resolution * resolution);
+        ownedClearance.resize (resolution * resolution);
+        nearestSite = &ownedNearestSite[0];
+        clearance = &ownedClearance[0];
+        rebuild = true;
+    }
+    else
+    {
+        // release the memory
+        std::vector<int> ().swap (ownedNearestSite);
+        std::vector<float> ().swap (ownedClearance);
+        nearestSite = NULL;
+        clearance = NULL;
+        rebuild = false;
+    }
+}
+
+
+float
+OpenSteer::OccupancyGrid::clearanceAt (const Vec3& point) const
+{
+    int i, j;
+    if (! isDistanceFieldCurrent () || ! cellIndexAt (point, i, j)) return 0;
+
+    // from a point anywhere in this cell to anywhere in the site's cell is
+    // at most one cell diagonal less than the center to center distance.
+    // Propagating sites between neighbors can overestimate the distance
+    // slightly, allow one more cell for that.
+    const float cx = cellXSize ();
+    const float cz = cellZSize ();
+    const float margin = sqrtXXX ((cx * cx) + (cz * cz)) + minXXX (cx, cz);
+    float c = clearance[i + (j * resolution)] - margin;
+
+    if (outsideValue)
+    {
+        const float x = point.x - center.x;
+        const float z = point.z - center.z;
+        const float edge = minXXX ((xSize / 2) - absXXX (x),
+                                   (zSize / 2) - absXXX (z));
+        c = minXXX (c, edge);
+    }
+    return maxXXX (c, 0);
+}
+
+
+// bring the distance field up to date.  Newly set cells become sites and
+// spread their distance outward.  Cells whose nearest site was cleared are
+// reset, then refilled from the intact cells around them.  Large batches
+// of changes just rebuild the whole field.
+
+
+void
+OpenSteer::OccupancyGrid::updateDistanceField (void)
+{
+    if (! distanceFieldEnabled) return;
+    const int cellCount = resolution * resolution;
+    if (rebuild || ((int) changedCells.size () > (cellCount / 8)))
+    {
+        rebuildDistanceField ();
+        return;
+    }
+    if (changedCells.empty ()) return;
+
+    std::vector<int> seeds;
+    std::vector<int> cleared;
+    std::vector<int> stack;
+    for (size_t c = 0; c < changedCells.size (); c++)
+    {
+        const int cell = changedCells[c];
+        if (getBit (cell % resolution, cell / resolution))
+        {
+            // new site
+            nearestSite[cell] = cell;
+            clearance[cell] = 0;
+            seeds.push_back (cell);
+        }
+        else if (nearestSite[cell] == cell)
+        {
+            // removed site: reset the cells which were nearest to it
+            stack.push_back (cell);
+        }
+    }
+
+    while (! stack.empty ())
+    {
+        const int cell = stack.back ();
+        stack.pop_back ();
+        if (nearestSite[cell] < 0) continue;
+        nearestSite[cell] = -1;
+        clearance[cell] = FLT_MAX;
+        cleared.push_back (cell);
+
+        const int ci = cell % resolution;
+        const int cj = cell / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = i + (j * resolution);
+            const int site = nearestSite[n];
+            if ((site >= 0) &&
+                ! getBit (site % resolution, site / resolution))
+                stack.push_back (n);
+        }
+    }
+
+    // intact neighbors of the reset cells spread into them again
+    for (size_t c = 0; c < cleared.size (); c++)
+    {
+        const int ci = cleared[c] % resolution;
+        const int cj = cleared[c] / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = i + (j * resolution);
+            if (nearestSite[n] >= 0) seeds.push_back (n);
+        }
+    }
+
+    changedCells.clear ();
+    propagateDistanceField (seeds);
+}
+
+
+void
+OpenSteer::OccupancyGrid::rebuildDistanceField (void)
+{
+    std::fill (nearestSite, nearestSite + (resolution * resolution), -1);
+    std::fill (clearance, clearance + (resolution * resolution), FLT_MAX);
+
+    std::vector<int> seeds;
+    for (int j = 0; j < resolution; j++)
+    {
+        int i = firstInRowSpan (j, 0, resolution - 1);
+        while (i >= 0)
+        {
+            const int cell = i + (j * resolution);
+            nearestSite[cell] = cell;
+            clearance[cell] = 0;
+            seeds.push_back (cell);
+            i = firstInRowSpan (j, i + 1, resolution - 1);
+        }
+    }
+
+    changedCells.clear ();
+    rebuild = false;
+    propagateDistanceField (seeds);
+}
+
+
+// spread nearest sites outward from the seed cells, nearest first: each
+// cell offers its site to its neighbors, who take it if it is nearer than
+// the one they have
+
+
+void
+OpenSteer::OccupancyGrid::propagateDistanceField (const std::vector<int>& seeds)
+{
+    const float cx = cellXSize ();
+    const float cz = cellZSize ();
+
+    OpenList open;
+    for (size_t s = 0; s < seeds.size (); s++)
+        open.push (OpenEntry (clearance[seeds[s]], seeds[s]));
+
+    while (! open.empty ())
+    {
+        const float d = open.top().first;
+        const int cell = open.top().second;
+        open.pop ();
+        if (d > clearance[cell]) continue; // stale entry
+
+        const int site = nearestSite[cell];
+        const int si = site % resolution;
+        const int sj = site / resolution;
+        const int ci = cell % resolution;
+        const int cj = cell / resolution;
+        for (int k = 0; k < neighborCount; k++)
+        {
+            const int i = ci + neighborI[k];
+            const int j = cj + neighborJ[k];
+            if ((i < 0) || (j < 0) || (i >= resolution) || (j >= resolution))
+                continue;
+            const int n = i + (j * resolution);
+            const float dx = (i - si) * cx;
+            const float dz = (j - sj) * cz;
+            const float nd = sqrtXXX ((dx * dx) + (dz * dz));
+            if (nd < clearance[n])
+            {
+                nearestSite[n] = site;
+                clearance[n] = nd;
+                open.push (OpenEntry (nd, n));
+            }
+        }
+    }
+}
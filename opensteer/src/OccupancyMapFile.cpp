@@ -0,0 +1,307 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// OccupancyMapFile: a binary file holding an OccupancyGrid exactly as it
+// sits in memory, memory mapped and used in place.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <string.h>
+#include <algorithm>
+#include "OpenSteer/OccupancyMapFile.h"
+
+// map the file into memory where mmap is available, else read it whole
+#ifndef _WIN32
+#define OPENSTEER_OCCUPANCY_MAP_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+
+
+namespace {
+
+    const char mapFileMagic[8] = {'O', 'S', 'O', 'C', 'C', 'M', 'A', 'P'};
+
+    // sections start on a cache line boundary
+    const uint64_t sectionAlignment = 64;
+
+    uint64_t alignSection (uint64_t offset)
+    {
+        return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+    }
+
+    // write "size" bytes at "offset", padding with zeros up to it
+    bool writeSection (FILE* f, uint64_t offset, const void* bytes, size_t size)
+    {
+        const char zero[sectionAlignment] = {0};
+        long position = ftell (f);
+        while ((position >= 0) && ((uint64_t) position < offset))
+        {
+            const size_t pad = std::min ((size_t) (offset - position),
+                                         sizeof (zero));
+            if (fwrite (zero, pad, 1, f) != 1) return false;
+            position += (long) pad;
+        }
+        return (position >= 0) &&
+               ((size == 0) || (fwrite (bytes, size, 1, f) == 1));
+    }
+
+    // does a section of "size" bytes at "offset" lie within the file?
+    bool sectionFits (uint64_t offset, uint64_t size, uint64_t fileSize)
+    {
+        return ((offset % sizeof (uint64_t)) == 0) &&
+               (offset >= sizeof (OpenSteer::OccupancyMapFileHeader)) &&
+               (offset <= fileSize) &&
+               (size <= fileSize - offset);
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// constructor and destructor
+
+
+OpenSteer::OccupancyMapFile::OccupancyMapFile ()
+    : loadedGrid (NULL),
+      data (NULL),
+      dataSize (0)
+{
+    memset (&header, 0, sizeof (header));
+}
+
+
+OpenSteer::OccupancyMapFile::~OccupancyMapFile ()
+{
+    close ();
+}
+
+
+// ----------------------------------------------------------------------------
+// saving a grid
+
+
+bool
+OpenSteer::OccupancyMapFile::write (const char* path,
+                                    const OccupancyGrid& grid)
+{
+    const int r = grid.resolution;
+    const size_t cellBytes = (OccupancyGrid::cellWordCount (r) *
+                              sizeof (OccupancyGrid::Word));
+    const size_t pyramidBytes = (OccupancyGrid::pyramidWordCount (r) *
+                                 sizeof (OccupancyGrid::Word));
+    const bool distance = grid.isDistanceFieldCurrent ();
+    const size_t siteBytes = distance ? r * r * sizeof (int32_t) : 0;
+    const size_t clearanceBytes = distance ? r * r * sizeof (float) : 0;
+
+    OccupancyMapFileHeader h;
+    memset (&h, 0, sizeof (h));
+    memcpy (h.magic, mapFileMagic, sizeof (h.magic));
+    h.version = occupancyMapFileVersion;
+    h.byteOrder = occupancyMapByteOrder;
+    h.flags = distance ? occupancyMapHasDistanceField : 0;
+    h.resolution = r;
+    h.centerX = grid.center.x;
+    h.centerY = grid.center.y;
+    h.centerZ = grid.center.z;
+    h.xSize = grid.xSize;
+    h.zSize = grid.zSize;
+    h.outsideValue = grid.outsideValue;
+    h.cellsOffset = alignSection (sizeof (h));
+    h.pyramidOffset = alignSection (h.cellsOffset + cellBytes);
+    h.sitesOffset = distance ? alignSection (h.pyramidOffset + pyramidBytes) : 0;
+    h.clearanceOffset = distance ? alignSection (h.sitesOffset + siteBytes) : 0;
+    h.fileSize = (distance ?
+                  h.clearanceOffset + clearanceBytes :
+                  h.pyramidOffset + pyramidBytes);
+
+    FILE* f = fopen (path, "wb");
+    if (f == NULL) return false;
+    bool ok = fwrite (&h, sizeof (h), 1, f) == 1;
+    ok = ok && writeSection (f, h.cellsOffset, grid.rowWords (0), cellBytes);
+    ok = ok && writeSection (f, h.pyramidOffset, grid.pyramidWords (),
+                             pyramidBytes);
+    if (distance)
+    {
+        ok = ok && writeSection (f, h.sitesOffset, grid.nearestSiteCells (),
+                                 siteBytes);
+        ok = ok && writeSection (f, h.clearanceOffset, grid.clearanceCells (),
+                                 clearanceBytes);
+    }
+    ok = (fclose (f) == 0) && ok;
+    return ok;
+}
+
+
+// ----------------------------------------------------------------------------
+// loading a map: check the header, map the file, and point a grid at it
+
+
+bool
+OpenSteer::OccupancyMapFile::open (const char* path)
+{
+    close ();
+
+    FILE* f = fopen (path, "rb");
+    if (f == NULL) return false;
+    const bool readHeader = fread (&header, sizeof (header), 1, f) == 1;
+    fseek (f, 0, SEEK_END);
+    const long actualSize = ftell (f);
+
+    // validate everything the grid will rely on
+    const int r = header.resolution;
+    bool valid = (readHeader &&
+                  (memcmp (header.magic, mapFileMagic, sizeof (header.magic))
+                   == 0) &&
+                  (header.version == occupancyMapFileVersion) &&
+                  (header.byteOrder == occupancyMapByteOrder) &&
+                  (r > 0) &&
+                  (actualSize >= 0) &&
+                  (header.fileSize <= (uint64_t) actualSize));
+    const bool distance = (header.flags & occupancyMapHasDistanceField) != 0;
+    if (valid)
+    {
+        const uint64_t rr = (uint64_t) r * r;
+        const uint64_t word = sizeof (OccupancyGrid::Word);
+        valid = (sectionFits (header.cellsOffset,
+                              OccupancyGrid::cellWordCount (r) * word,
+                              header.fileSize) &&
+                 sectionFits (header.pyramidOffset,
+                              OccupancyGrid::pyramidWordCount (r) * word,
+                              header.fileSize) &&
+                 ((! distance) ||
+                  (sectionFits (header.sitesOffset, rr * sizeof (int32_t),
+                                header.fileSize) &&
+                   sectionFits (header.clearanceOffset, rr * sizeof (float),
+                                header.fileSize))));
+    }
+    if (! valid)
+    {
+        fclose (f);
+        memset (&header, 0, sizeof (header));
+        return false;
+    }
+    dataSize = (size_t) header.fileSize;
+
+#ifdef OPENSTEER_OCCUPANCY_MAP_MMAP
+    // a private writable mapping: edits to the grid are copy on write,
+    // the mapping outlives the descriptor
+    fclose (f);
+    const int fd = ::open (path, O_RDONLY);
+    if (fd < 0) return false;
+    void* m = mmap (NULL, dataSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+    if (m == MAP_FAILED) return false;
+    data = (unsigned char*) m;
+#else
+    buffer.resize ((dataSize + sizeof (uint64_t) - 1) / sizeof (uint64_t));
+    const bool ok = ((fseek (f, 0, SEEK_SET) == 0) &&
+                     (fread (&buffer[0], dataSize, 1, f) == 1));
+    fclose (f);
+    if (! ok)
+    {
+        std::vector<uint64_t> ().swap (buffer);
+        return false;
+    }
+    data = (unsigned char*) &buffer[0];
+#endif
+
+    OccupancyGrid::Storage storage;
+    storage.cells = (OccupancyGrid::Word*) (data + header.cellsOffset);
+    storage.pyramid = (OccupancyGrid::Word*) (data + header.pyramidOffset);
+    storage.nearestSites = distance ? (int*) (data + header.sitesOffset) : NULL;
+    storage.clearances = distance ? (float*) (data + header.clearanceOffset) : NULL;
+
+    const Vec3 center (header.centerX, header.centerY, header.centerZ);
+    loadedGrid = new OccupancyGrid (center, header.xSize, header.zSize, r,
+                                    storage);
+    loadedGrid->outsideValue = header.outsideValue != 0;
+    return true;
+}
+
+
+void
+OpenSteer::OccupancyMapFile::close (void)
+{
+    delete loadedGrid;
+    loadedGrid = NULL;
+
+#ifdef OPENSTEER_OCCUPANCY_MAP_MMAP
+    if (data != NULL) munmap (data, dataSize);
+#endif
+    std::vector<uint64_t> ().swap (buffer);
+    data = NULL;
+    dataSize = 0;
+}
+
+
+// ----------------------------------------------------------------------------
+// converting a grayscale image
+
+
+OpenSteer::OccupancyGrid*
+OpenSteer::OccupancyMapFile::makeGridFromImage (const unsigned char* pixels,
+                                                int width,
+                                                int height,
+                                                const Vec3& center,
+                                                float cellSize,
+                                                int threshold,
+                                                bool darkIsBlocked)
+{
+    const int r = std::max (width, height);
+    const float size = r * cellSize;
+    OccupancyGrid* grid = new OccupancyGrid (center, size, size, r);
+
+    // build the packed rows directly, then load them all at once
+    const int wordsPerRow = grid->getWordsPerRow ();
+    std::vector<OccupancyGrid::Word> rows (OccupancyGrid::cellWordCount (r), 0);
+    for (int j = 0; j < r; j++)
+    {
+        OccupancyGrid::Word* row = &rows[j * wordsPerRow];
+        for (int i = 0; i < r; i++)
+        {
+            bool blocked = true;
+            if ((i < width) && (j < height))
+            {
+                const int value = pixels[i + (j * width)];
+                blocked = darkIsBlocked ? value < threshold : value >= threshold;
+            }
+            if (blocked)
+                row[i / OccupancyGrid::bitsPerWord] |=
+                    ((OccupancyGrid::Word) 1) << (i % OccupancyGrid::bitsPerWord);
+        }
+    }
+    grid->readRows (&rows[0]);
+    return grid;
+}
@@ -38,6 +38,7 @@
 
 
 #include "OpenSteer/Pathway.h"
+#include "OpenSteer/Profiler.h"
 
 
 // ----------------------------------------------------------------------------
@@ -54,6 +55,18 @@ OpenSteer::PolylinePathway::PolylinePathway (const int _pointCount,
 }
 
 
+// ----------------------------------------------------------------------------
+// destructor: release the arrays allocated by initialize
+
+
+OpenSteer::PolylinePathway::~PolylinePathway ()
+{
+    delete [] lengths;
+    delete [] points;
+    delete [] normals;
+}
+
+
 // ----------------------------------------------------------------------------
 // utility for constructors
 
@@ -111,6 +124,7 @@ OpenSteer::PolylinePathway::mapPointToPath (const Vec3& point,
                                             Vec3& tangent,
                                             float& outside)
 {
+    OPENSTEER_PROFILE_ZONE ("path mapping");
     float d;
     float minDistance = FLT_MAX;
     Vec3 onPath;
@@ -144,6 +158,7 @@ OpenSteer::PolylinePathway::mapPointToPath (const Vec3& point,
 float 
 OpenSteer::PolylinePathway::mapPointToPathDistance (const Vec3& point)
 {
+    OPENSTEER_PROFILE_ZONE ("path mapping");
     float d;
     float minDistance = FLT_MAX;
     float segmentLengthTotal = 0;
@@ -174,6 +189,7 @@ OpenSteer::PolylinePathway::mapPointToPathDistance (const Vec3& point)
 OpenSteer::Vec3 
 OpenSteer::PolylinePathway::mapPathDistanceToPoint (float pathDistance)
 {
+    OPENSTEER_PROFILE_ZONE ("path mapping");
     // clip or wrap given path distance according to cyclic flag
     float remaining = pathDistance;
     if (cyclic)
@@ -0,0 +1,498 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// PathwayGraph: network of pathways with cached A* route planning.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <cfloat>
+#include <queue>
+#include "OpenSteer/PathwayGraph.h"
+
+
+namespace {
+
+    // open list entry for A* and Dijkstra: node and its priority
+    typedef std::pair<float, int> OpenEntry;
+
+    // smallest priority first
+    typedef std::priority_queue<OpenEntry,
+                                std::vector<OpenEntry>,
+                                std::greater<OpenEntry> > OpenList;
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// PathwayRoute
+
+
+OpenSteer::PathwayRoute::PathwayRoute (const std::vector<int>& nodes,
+                                       const std::vector<Vec3>& points,
+                                       const float radius)
+    : _nodes (nodes)
+{
+    _pathway = new PolylinePathway ((int) points.size(), &points[0],
+                                    radius, false);
+}
+
+
+OpenSteer::PathwayRoute::~PathwayRoute ()
+{
+    delete _pathway;
+}
+
+
+// ----------------------------------------------------------------------------
+// PathwayGraph
+
+
+OpenSteer::PathwayGraph::PathwayGraph (const int routeCacheCapacity)
+    : searchStamp (0),
+      cacheCapacity (routeCacheCapacity),
+      cacheHits (0),
+      cacheMisses (0),
+      searchCount (0)
+{
+}
+
+
+OpenSteer::PathwayGraph::~PathwayGraph ()
+{
+}
+
+
+// ----------------------------------------------------------------------------
+// graph construction
+
+
+int
+OpenSteer::PathwayGraph::addNode (const Vec3& position)
+{
+    Node node;
+    node.position = position;
+    nodes.push_back (node);
+
+    SearchState s = {0, -1, 0, 0, false};
+    search.push_back (s);
+    return (int) nodes.size() - 1;
+}
+
+
+void
+OpenSteer::PathwayGraph::addEdge (const int from,
+                                  const int to,
+                                  const float radius,
+                                  const bool bidirectional)
+{
+    const float length = Vec3::distance (nodes[from].position,
+                                         nodes[to].position);
+    Edge out = {to, length, radius};
+    Edge in = {from, length, radius};
+    nodes[from].out.push_back (out);
+    nodes[to].in.push_back (in);
+
+    if (bidirectional) addEdge (to, from, radius, false);
+
+    // cached routes may no longer be the shortest
+    clearRouteCache ();
+}
+
+
+void
+OpenSteer::PathwayGraph::removeEdge (const int from,
+                                     const int to,
+                                     const bool bidirectional)
+{
+    std::vector<Edge>& out = nodes[from].out;
+    for (std::vector<Edge>::iterator i = out.begin(); i != out.end(); i++)
+    {
+        if (i->to == to) {out.erase (i); break;}
+    }
+    std::vector<Edge>& in = nodes[to].in;
+    for (std::vector<Edge>::iterator i = in.begin(); i != in.end(); i++)
+    {
+        if (i->to == from) {in.erase (i); break;}
+    }
+
+    if (bidirectional) removeEdge (to, from, false);
+
+    // cached routes may use the removed leg
+    clearRouteCache ();
+}
+
+
+int
+OpenSteer::PathwayGraph::nearestNode (const Vec3& point) const
+{
+    int nearest = -1;
+    float minDistanceSquared = FLT_MAX;
+    for (int i = 0; i < (int) nodes.size(); i++)
+    {
+        const float d = (nodes[i].position - point).lengthSquared ();
+        if (d < minDistanceSquared)
+        {
+            minDistanceSquared = d;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+
+// ----------------------------------------------------------------------------
+// single route queries: served from the cache when possible, else by A*
+
+
+OpenSteer::PathwayRouteHandle
+OpenSteer::PathwayGraph::findRoute (const int start, const int goal)
+{
+    if (start == goal) return PathwayRouteHandle ();
+
+    const RouteKey key (start, goal);
+    PathwayRouteHandle route;
+    if (lookupCachedRoute (key, route)) return route;
+
+    route = searchRoute (start, goal);
+    insertCachedRoute (key, route);
+    return route;
+}
+
+
+OpenSteer::PathwayRouteHandle
+OpenSteer::PathwayGraph::findRoute (const Vec3& from, const Vec3& to)
+{
+    return findRoute (nearestNode (from), nearestNode (to));
+}
+
+
+// ----------------------------------------------------------------------------
+// batch route queries: cache hits are answered directly, the remaining
+// requests are grouped by goal.  A goal requested more than once gets a
+// single backward search which settles all of its starts, a goal requested
+// once is searched with A* as usual.
+
+
+void
+OpenSteer::PathwayGraph::findRoutes (const std::vector<RouteRequest>& requests,
+                                     std::vector<PathwayRouteHandle>& results)
+{
+    results.clear ();
+    results.resize (requests.size ());
+
+    // collect cache misses by goal
+    std::map<int, std::vector<int> > missesByGoal;
+    for (size_t i = 0; i < requests.size (); i++)
+    {
+        const RouteKey& key = requests[i];
+        if (key.first == key.second) continue;
+        if (lookupCachedRoute (key, results[i])) continue;
+
+        std::vector<int>& starts = missesByGoal[key.second];
+        if (std::find (starts.begin(), starts.end(), key.first) == starts.end())
+            starts.push_back (key.first);
+    }
+
+    // plan the missing routes, storing them in the cache
+    std::map<RouteKey, PathwayRouteHandle> planned;
+    for (std::map<int, std::vector<int> >::iterator i = missesByGoal.begin();
+         i != missesByGoal.end(); i++)
+    {
+        const int goal = i->first;
+        const std::vector<int>& starts = i->second;
+        if (starts.size () == 1)
+        {
+            const RouteKey key (starts[0], goal);
+            planned[key] = searchRoute (starts[0], goal);
+            insertCachedRoute (key, planned[key]);
+        }
+        else
+        {
+            std::vector<PathwayRouteHandle> routes;
+            searchRoutesToGoal (goal, starts, routes);
+            for (size_t j = 0; j < starts.size (); j++)
+            {
+                const RouteKey key (starts[j], goal);
+                planned[key] = routes[j];
+                insertCachedRoute (key, routes[j]);
+            }
+        }
+    }
+
+    // fill in the remaining results (duplicate requests share one route)
+    for (size_t i = 0; i < requests.size (); i++)
+    {
+        std::map<RouteKey, PathwayRouteHandle>::iterator p =
+            planned.find (requests[i]);
+        if (p != planned.end()) results[i] = p->second;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// per-node search state, reset lazily by bumping the search stamp
+
+
+void
+OpenSteer::PathwayGraph::beginSearch (void)
+{
+    searchCount++;
+    if (++searchStamp == 0)
+    {
+        // stamp wrapped around: really clear the old state
+        for (size_t i = 0; i < search.size (); i++) search[i].stamp = 0;
+        searchStamp = 1;
+    }
+}
+
+
+OpenSteer::PathwayGraph::SearchState&
+OpenSteer::PathwayGraph::state (const int node)
+{
+    SearchState& s = search[node];
+    if (s.stamp != searchStamp)
+    {
+        s.cost = FLT_MAX;
+        s.link = -1;
+        s.radius = 0;
+        s.stamp = searchStamp;
+        s.closed = false;
+    }
+    return s;
+}
+
+
+// ----------------------------------------------------------------------------
+// A* search with straight line distance as the (admissible) heuristic
+
+
+OpenSteer::PathwayRouteHandle
+OpenSteer::PathwayGraph::searchRoute (const int start, const int goal)
+{
+    beginSearch ();
+
+    const Vec3& goalPosition = nodes[goal].position;
+    OpenList open;
+    state (start).cost = 0;
+    open.push (OpenEntry (Vec3::distance (nodes[start].position,
+                                          goalPosition), start));
+
+    while (! open.empty ())
+    {
+        const int current = open.top().second;
+        open.pop ();
+
+        SearchState& c = state (current);
+        if (c.closed) continue;
+        c.closed = true;
+        if (current == goal) return buildRoute (start, goal, false);
+
+        const std::vector<Edge>& out = nodes[current].out;
+        for (size_t i = 0; i < out.size (); i++)
+        {
+            const Edge& e = out[i];
+            SearchState& n = state (e.to);
+            const float cost = c.cost + e.length;
+            if (n.closed || cost >= n.cost) continue;
+
+            n.cost = cost;
+            n.link = current;
+            n.radius = e.radius;
+            const Vec3& p = nodes[e.to].position;
+            open.push (OpenEntry (cost + Vec3::distance (p, goalPosition),
+                                  e.to));
+        }
+    }
+
+    // goal unreachable
+    return PathwayRouteHandle ();
+}
+
+
+// ----------------------------------------------------------------------------
+// Dijkstra search over reversed legs from a shared goal.  After it, each
+// settled node's "link" is its next hop along a shortest route to the goal.
+
+
+void
+OpenSteer::PathwayGraph::searchRoutesToGoal (const int goal,
+                                             const std::vector<int>& starts,
+                                             std::vector<PathwayRouteHandle>& routes)
+{
+    beginSearch ();
+
+    int unsettled = (int) starts.size ();
+    OpenList open;
+    state (goal).cost = 0;
+    open.push (OpenEntry (0, goal));
+
+    while (unsettled > 0 && ! open.empty ())
+    {
+        const int current = open.top().second;
+        open.pop ();
+
+        SearchState& c = state (current);
+        if (c.closed) continue;
+        c.closed = true;
+        if (std::find (starts.begin(), starts.end(), current) != starts.end())
+            unsettled--;
+
+        const std::vector<Edge>& in = nodes[current].in;
+        for (size_t i = 0; i < in.size (); i++)
+        {
+            const Edge& e = in[i];
+            SearchState& n = state (e.to);
+            const float cost = c.cost + e.length;
+            if (n.closed || cost >= n.cost) continue;
+
+            n.cost = cost;
+            n.link = current;
+            n.radius = e.radius;
+            open.push (OpenEntry (cost, e.to));
+        }
+    }
+
+    routes.clear ();
+    for (size_t i = 0; i < starts.size (); i++)
+    {
+        const bool reached = state (starts[i]).closed;
+        routes.push_back (reached ?
+                          buildRoute (starts[i], goal, true) :
+                          PathwayRouteHandle ());
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// turn the links left by a search into a route.  "forward" links point from
+// each node toward the goal (backward search), otherwise they point back
+// toward the start (A*).  The route's radius is that of its narrowest leg.
+
+
+OpenSteer::PathwayRouteHandle
+OpenSteer::PathwayGraph::buildRoute (const int start,
+                                     const int goal,
+                                     const bool forward)
+{
+    std::vector<int> route;
+    float radius = FLT_MAX;
+
+    int node = forward ? start : goal;
+    const int last = forward ? goal : start;
+    route.push_back (node);
+    while (node != last)
+    {
+        const SearchState& s = state (node);
+        radius = std::min (radius, s.radius);
+        node = s.link;
+        route.push_back (node);
+    }
+    if (! forward) std::reverse (route.begin(), route.end());
+
+    std::vector<Vec3> points;
+    points.reserve (route.size ());
+    for (size_t i = 0; i < route.size (); i++)
+        points.push_back (nodes[route[i]].position);
+
+    return PathwayRouteHandle (new PathwayRoute (route, points, radius));
+}
+
+
+// ----------------------------------------------------------------------------
+// least recently used route cache.  Unreachable routes are cached too (as
+// empty handles) so repeated hopeless requests do not search again.
+
+
+bool
+OpenSteer::PathwayGraph::lookupCachedRoute (const RouteKey& key,
+                                            PathwayRouteHandle& route)
+{
+    std::map<RouteKey, CacheList::iterator>::iterator i = cacheMap.find (key);
+    if (i == cacheMap.end())
+    {
+        cacheMisses++;
+        return false;
+    }
+
+    // move to the front of the list (most recently used)
+    cacheList.splice (cacheList.begin(), cacheList, i->second);
+    route = i->second->second;
+    cacheHits++;
+    return true;
+}
+
+
+void
+OpenSteer::PathwayGraph::insertCachedRoute (const RouteKey& key,
+                                            const PathwayRouteHandle& route)
+{
+    if (cacheCapacity <= 0) return;
+
+    std::map<RouteKey, CacheList::iterator>::iterator i = cacheMap.find (key);
+    if (i != cacheMap.end())
+    {
+        i->second->second = route;
+        cacheList.splice (cacheList.begin(), cacheList, i->second);
+        return;
+    }
+
+    cacheList.push_front (CacheEntry (key, route));
+    cacheMap[key] = cacheList.begin();
+
+    // evict the least recently used routes.  Agents still holding one of
+    // them keep it alive through their own handle.
+    while ((int) cacheMap.size() > cacheCapacity)
+    {
+        cacheMap.erase (cacheList.back().first);
+        cacheList.pop_back ();
+    }
+}
+
+
+void
+OpenSteer::PathwayGraph::setRouteCacheCapacity (const int capacity)
+{
+    cacheCapacity = capacity;
+    while ((int) cacheMap.size() > std::max (cacheCapacity, 0))
+    {
+        cacheMap.erase (cacheList.back().first);
+        cacheList.pop_back ();
+    }
+}
+
+
+void
+OpenSteer::PathwayGraph::clearRouteCache (void)
+{
+    cacheMap.clear ();
+    cacheList.clear ();
+}
@@ -0,0 +1,454 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// Profiler: where simulation time goes, by named zones.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include "OpenSteer/Profiler.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+namespace {
+
+    // a zone as recorded by the thread which left it (times in ns)
+
+    struct ZoneEvent
+    {
+        const char* name;
+        int64_t start;
+        int64_t end;
+        int64_t self;
+    };
+
+    // a zone kept for the trace
+
+    struct TraceEvent
+    {
+        const char* name;
+        int thread;
+        int64_t start;
+        int64_t duration;
+    };
+
+    // each thread records into a ring buffer of its own, which endFrame
+    // empties.  Buffers are kept for the life of the program (threads are
+    // few and long lived: the main thread and the WorkerPool threads).
+
+    const size_t ringSize = 1 << 16;
+    const int maxDepth = 64;
+    const int maxCounts = 32;
+
+    struct Count
+    {
+        const char* name;
+        int64_t total;
+    };
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer (int index)
+            : events (ringSize), written (0), read (0),
+              depth (0), countCount (0), thread (index) {}
+
+        std::vector<ZoneEvent> events;
+        std::atomic<size_t> written;
+        std::atomic<size_t> read;
+
+        // time spent in nested zones, for each zone currently entered
+        int64_t childTime[maxDepth];
+        int depth;
+
+        // counts added to by this thread (emptied by endFrame)
+        Count counts[maxCounts];
+        int countCount;
+
+        int thread;
+    };
+
+    std::mutex buffersMutex;
+    std::vector<ThreadBuffer*> buffers;
+    thread_local ThreadBuffer* threadBuffer = NULL;
+
+    std::atomic<int> droppedZones (0);
+
+    // gathered by endFrame (only touched under buffersMutex)
+    std::vector<OpenSteer::Profiler::ZoneTotals> frameTotals;
+    std::vector<OpenSteer::Profiler::CountTotals> frameCounts;
+    int lastFrameDropped = 0;
+    double frameSeconds = 0;
+    int64_t lastFrameEnd = 0;
+
+    bool tracing = false;
+    size_t maxTraceZones = 0;
+    int64_t traceStart = 0;
+    std::vector<TraceEvent> trace;
+
+
+    int64_t
+    nanosecondsNow (void)
+    {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>
+            (steady_clock::now ().time_since_epoch ()).count ();
+    }
+
+
+    ThreadBuffer&
+    getThreadBuffer (void)
+    {
+        if (threadBuffer == NULL)
+        {
+            std::lock_guard<std::mutex> lock (buffersMutex);
+            threadBuffer = new ThreadBuffer ((int) buffers.size ());
+            buffers.push_back (threadBuffer);
+        }
+        return *threadBuffer;
+    }
+
+
+    bool
+    moreSelfTime (const OpenSteer::Profiler::ZoneTotals& a,
+                  const OpenSteer::Profiler::ZoneTotals& b)
+    {
+        return a.selfSeconds > b.selfSeconds;
+    }
+
+
+    // add a zone into the frame totals of its name
+
+    void
+    addToFrameTotals (const ZoneEvent& e)
+    {
+        OpenSteer::Profiler::ZoneTotals* totals = NULL;
+        for (size_t i = 0; i < frameTotals.size (); i++)
+        {
+            // names from different files may be different copies
+            if ((frameTotals[i].name == e.name) ||
+                (strcmp (frameTotals[i].name, e.name) == 0))
+            {
+                totals = &frameTotals[i];
+                break;
+            }
+        }
+        if (totals == NULL)
+        {
+            const OpenSteer::Profiler::ZoneTotals t = {e.name, 0, 0, 0};
+            frameTotals.push_back (t);
+            totals = &frameTotals.back ();
+        }
+        totals->calls++;
+        totals->seconds += (e.end - e.start) * 1e-9;
+        totals->selfSeconds += e.self * 1e-9;
+    }
+
+
+    // add a thread's count into the frame counts of its name
+
+    void
+    addToFrameCounts (const Count& c)
+    {
+        for (size_t i = 0; i < frameCounts.size (); i++)
+        {
+            if ((frameCounts[i].name == c.name) ||
+                (strcmp (frameCounts[i].name, c.name) == 0))
+            {
+                frameCounts[i].total += c.total;
+                return;
+            }
+        }
+        const OpenSteer::Profiler::CountTotals t = {c.name, c.total};
+        frameCounts.push_back (t);
+    }
+
+
+    // write a zone name as a JSON string
+
+    void
+    writeJSONString (FILE* file, const char* s)
+    {
+        fputc ('"', file);
+        for (; *s; s++)
+        {
+            if ((*s == '"') || (*s == '\\')) fputc ('\\', file);
+            if ((unsigned char) *s >= ' ') fputc (*s, file);
+        }
+        fputc ('"', file);
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+
+
+std::atomic<bool> OpenSteer::Profiler::enabled (false);
+
+
+void
+OpenSteer::Profiler::setEnabled (bool enable)
+{
+    enabled.store (enable, std::memory_order_relaxed);
+}
+
+
+// ----------------------------------------------------------------------------
+// entering and leaving a zone: on the thread doing it, no locking
+
+
+int64_t
+OpenSteer::Profiler::enterZone (void)
+{
+    ThreadBuffer& b = getThreadBuffer ();
+    if (b.depth < maxDepth) b.childTime[b.depth] = 0;
+    b.depth++;
+    return nanosecondsNow ();
+}
+
+
+void
+OpenSteer::Profiler::leaveZone (const char* name, int64_t start)
+{
+    const int64_t end = nanosecondsNow ();
+    ThreadBuffer& b = getThreadBuffer ();
+
+    // self time is the zone's time less that of the zones nested in it
+    const int64_t duration = end - start;
+    int64_t self = duration;
+    if (b.depth > 0)
+    {
+        b.depth--;
+        if (b.depth < maxDepth) self -= b.childTime[b.depth];
+        if ((b.depth > 0) && (b.depth <= maxDepth))
+            b.childTime[b.depth - 1] += duration;
+    }
+
+    // add it to the ring, unless endFrame has fallen a whole ring behind
+    const size_t w = b.written.load (std::memory_order_relaxed);
+    if (w - b.read.load (std::memory_order_acquire) >= ringSize)
+    {
+        droppedZones.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+    ZoneEvent& e = b.events[w & (ringSize - 1)];
+    e.name = name;
+    e.start = start;
+    e.end = end;
+    e.self = self;
+    b.written.store (w + 1, std::memory_order_release);
+}
+
+
+// add to a count: a table per thread, names told apart by address
+
+
+void
+OpenSteer::Profiler::addToCount (const char* name, int64_t amount)
+{
+    ThreadBuffer& b = getThreadBuffer ();
+    for (int i = 0; i < b.countCount; i++)
+    {
+        if (b.counts[i].name == name)
+        {
+            b.counts[i].total += amount;
+            return;
+        }
+    }
+    if (b.countCount < maxCounts)
+    {
+        const Count c = {name, amount};
+        b.counts[b.countCount++] = c;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// gather the zones left and counts added to during the frame
+
+
+void
+OpenSteer::Profiler::endFrame (void)
+{
+    std::lock_guard<std::mutex> lock (buffersMutex);
+
+    const int64_t now = nanosecondsNow ();
+    frameSeconds = lastFrameEnd ? (now - lastFrameEnd) * 1e-9 : 0;
+    lastFrameEnd = now;
+
+    frameTotals.clear ();
+    frameCounts.clear ();
+    for (size_t i = 0; i < buffers.size (); i++)
+    {
+        ThreadBuffer& b = *buffers[i];
+        for (int c = 0; c < b.countCount; c++) addToFrameCounts (b.counts[c]);
+        b.countCount = 0;
+
+        const size_t w = b.written.load (std::memory_order_acquire);
+        for (size_t r = b.read.load (std::memory_order_relaxed); r < w; r++)
+        {
+            const ZoneEvent& e = b.events[r & (ringSize - 1)];
+            addToFrameTotals (e);
+            if (tracing && (trace.size () < maxTraceZones) &&
+                (e.start >= traceStart))
+            {
+                const TraceEvent t = {e.name, b.thread,
+                                      e.start, e.end - e.start};
+                trace.push_back (t);
+            }
+        }
+        b.read.store (w, std::memory_order_release);
+    }
+    std::sort (frameTotals.begin (), frameTotals.end (), moreSelfTime);
+
+    lastFrameDropped = droppedZones.exchange (0, std::memory_order_relaxed);
+}
+
+
+const std::vector<OpenSteer::Profiler::ZoneTotals>&
+OpenSteer::Profiler::getFrameTotals (void)
+{
+    return frameTotals;
+}
+
+
+const OpenSteer::Profiler::ZoneTotals*
+OpenSteer::Profiler::findFrameTotals (const char* name)
+{
+    for (size_t i = 0; i < frameTotals.size (); i++)
+        if (strcmp (frameTotals[i].name, name) == 0) return &frameTotals[i];
+    return NULL;
+}
+
+
+const std::vector<OpenSteer::Profiler::CountTotals>&
+OpenSteer::Profiler::getFrameCounts (void)
+{
+    return frameCounts;
+}
+
+
+int64_t
+OpenSteer::Profiler::getFrameCount (const char* name)
+{
+    for (size_t i = 0; i < frameCounts.size (); i++)
+        if (strcmp (frameCounts[i].name, name) == 0)
+            return frameCounts[i].total;
+    return 0;
+}
+
+
+double
+OpenSteer::Profiler::getFrameSeconds (void)
+{
+    return frameSeconds;
+}
+
+
+int
+OpenSteer::Profiler::getDroppedZones (void)
+{
+    return lastFrameDropped;
+}
+
+
+// ----------------------------------------------------------------------------
+// trace recording
+
+
+void
+OpenSteer::Profiler::startTrace (size_t maxZones)
+{
+    std::lock_guard<std::mutex> lock (buffersMutex);
+    trace.clear ();
+    trace.reserve (std::min (maxZones, (size_t) 100000));
+    maxTraceZones = maxZones;
+    traceStart = nanosecondsNow ();
+    tracing = true;
+}
+
+
+void
+OpenSteer::Profiler::stopTrace (void)
+{
+    std::lock_guard<std::mutex> lock (buffersMutex);
+    tracing = false;
+}
+
+
+bool
+OpenSteer::Profiler::isTracing (void)
+{
+    std::lock_guard<std::mutex> lock (buffersMutex);
+    return tracing;
+}
+
+
+// Chrome tracing "complete" events, times in microseconds from the start
+// of the trace, one "tid" per recording thread
+
+
+bool
+OpenSteer::Profiler::writeChromeTrace (const char* path)
+{
+    std::lock_guard<std::mutex> lock (buffersMutex);
+
+    FILE* file = fopen (path, "w");
+    if (file == NULL) return false;
+
+    fprintf (file, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < trace.size (); i++)
+    {
+        const TraceEvent& t = trace[i];
+        fprintf (file, "{\"name\":");
+        writeJSONString (file, t.name);
+        fprintf (file,
+                 ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                 "\"pid\":1,\"tid\":%d}%s\n",
+                 (t.start - traceStart) * 1e-3,
+                 t.duration * 1e-3,
+                 t.thread,
+                 (i + 1 < trace.size ()) ? "," : "");
+    }
+    fprintf (file, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    const bool ok = (ferror (file) == 0);
+    return (fclose (file) == 0) && ok;
+}
+
+
+// ----------------------------------------------------------------------------
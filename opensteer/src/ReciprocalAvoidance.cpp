@@ -0,0 +1,314 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// ReciprocalAvoidance: ORCA lines and the linear program which picks a new
+// velocity from them, after the RVO2 library's Agent::computeNewVelocity
+// (linearProgram1, 2 and 3), with vectors on the XZ plane and lines kept
+// in fixed size arrays on the stack.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include "OpenSteer/ReciprocalAvoidance.h"
+#include "OpenSteer/Utilities.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+namespace {
+
+    using namespace OpenSteer;
+
+    const float epsilon = 0.00001f;
+
+    // 2D cross product on the XZ plane
+    inline float det (const Vec3& a, const Vec3& b)
+    {
+        return (a.x * b.z) - (a.z * b.x);
+    }
+
+    // w turned a quarter turn: the direction of an ORCA line whose
+    // allowed side faces along w
+    inline Vec3 perpendicular (const Vec3& w)
+    {
+        return Vec3 (w.z, 0, -w.x);
+    }
+
+
+    // the best velocity on line "lineNo" within the speed circle which
+    // satisfies lines 0 through lineNo-1, or false when there is none.
+    // With directionOpt the best is the furthest along "optimal" (a unit
+    // vector), otherwise the nearest to it.
+    bool solveOnLine (const OrcaLine lines[],
+                      const int lineNo,
+                      const float maxSpeed,
+                      const Vec3& optimal,
+                      const bool directionOpt,
+                      Vec3& result)
+    {
+        const OrcaLine& line = lines[lineNo];
+        const float dotProduct = line.point.dot (line.direction);
+        const float discriminant = (square (dotProduct) +
+                                    square (maxSpeed) -
+                                    line.point.lengthSquared ());
+
+        // the speed circle misses the line entirely
+        if (discriminant < 0) return false;
+
+        const float sqrtDiscriminant = sqrtXXX (discriminant);
+        float tLeft = -dotProduct - sqrtDiscriminant;
+        float tRight = -dotProduct + sqrtDiscriminant;
+
+        // clip the segment of the line by each earlier line
+        for (int i = 0; i < lineNo; i++)
+        {
+            const float denominator = det (line.direction, lines[i].direction);
+            const float numerator = det (lines[i].direction,
+                                         line.point - lines[i].point);
+
+            // parallel lines: all or nothing
+            if (absXXX (denominator) <= epsilon)
+            {
+                if (numerator < 0) return false;
+                continue;
+            }
+
+            const float t = numerator / denominator;
+            if (denominator >= 0)
+                tRight = minXXX (tRight, t);
+            else
+                tLeft = maxXXX (tLeft, t);
+
+            if (tLeft > tRight) return false;
+        }
+
+        if (directionOpt)
+        {
+            // furthest point in the optimal direction
+            const float t = (optimal.dot (line.direction) > 0) ? tRight : tLeft;
+            result = line.point + (line.direction * t);
+        }
+        else
+        {
+            // nearest point to the optimal velocity
+            const float t = line.direction.dot (optimal - line.point);
+            result = line.point + (line.direction * clip (t, tLeft, tRight));
+        }
+        return true;
+    }
+
+
+    // incremental 2D linear program: starting from the optimum within the
+    // speed circle, whenever a line is violated move the result onto it.
+    // Returns the number of lines satisfied, lineCount on success.
+    int solveLines (const OrcaLine lines[],
+                    const int lineCount,
+                    const float maxSpeed,
+                    const Vec3& optimal,
+                    const bool directionOpt,
+                    Vec3& result)
+    {
+        if (directionOpt)
+            result = optimal * maxSpeed;
+        else if (optimal.lengthSquared () > square (maxSpeed))
+            result = optimal.normalize () * maxSpeed;
+        else
+            result = optimal;
+
+        for (int i = 0; i < lineCount; i++)
+        {
+            if (det (lines[i].direction, lines[i].point - result) > 0)
+            {
+                const Vec3 previous = result;
+                if (! solveOnLine (lines, i, maxSpeed, optimal,
+                                   directionOpt, result))
+                {
+                    result = previous;
+                    return i;
+                }
+            }
+        }
+        return lineCount;
+    }
+
+
+    // when the lines are infeasible (crowded agents): the velocity which
+    // minimizes the largest violation, found as a 2D linear program over
+    // the lines projected onto each violated line in turn
+    void solveLeastViolation (const OrcaLine lines[],
+                              const int lineCount,
+                              const int beginLine,
+                              const float maxSpeed,
+                              Vec3& result)
+    {
+        OrcaLine projected[orcaMaxNeighbors];
+        float distance = 0;
+
+        for (int i = beginLine; i < lineCount; i++)
+        {
+            // skip lines the current result already violates no more than
+            // the worst so far
+            if (det (lines[i].direction, lines[i].point - result) <= distance)
+                continue;
+
+            int projectedCount = 0;
+            for (int j = 0; j < i; j++)
+            {
+                OrcaLine& p = projected[projectedCount];
+                const float determinant = det (lines[i].direction,
+                                               lines[j].direction);
+
+                if (absXXX (determinant) <= epsilon)
+                {
+                    // parallel lines pointing the same way add nothing
+                    if (lines[i].direction.dot (lines[j].direction) > 0)
+                        continue;
+                    p.point = (lines[i].point + lines[j].point) * 0.5f;
+                }
+                else
+                {
+                    const float t = det (lines[j].direction,
+                                         lines[i].point - lines[j].point);
+                    p.point = lines[i].point +
+                              (lines[i].direction * (t / determinant));
+                }
+                p.direction = (lines[j].direction -
+                               lines[i].direction).normalize ();
+                projectedCount++;
+            }
+
+            const Vec3 previous = result;
+            const Vec3 away (-lines[i].direction.z, 0, lines[i].direction.x);
+            if (solveLines (projected, projectedCount, maxSpeed, away,
+                            true, result) < projectedCount)
+            {
+                // numerical trouble: by construction this should not fail
+                result = previous;
+            }
+            distance = det (lines[i].direction, lines[i].point - result);
+        }
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+
+
+void
+OpenSteer::makeOrcaLine (const Vec3& relativePosition,
+                         const Vec3& relativeVelocity,
+                         const float combinedRadius,
+                         const Vec3& velocity,
+                         const float timeHorizon,
+                         const float timeStep,
+                         OrcaLine& line)
+{
+    const float distSquared = relativePosition.lengthSquared ();
+    const float combinedRadiusSquared = square (combinedRadius);
+    Vec3 u;
+
+    if (distSquared > combinedRadiusSquared)
+    {
+        // no collision yet: the velocity obstacle is a cone truncated by a
+        // circle of radius combinedRadius/timeHorizon
+        const float invTimeHorizon = 1 / timeHorizon;
+        const Vec3 w = relativeVelocity - (relativePosition * invTimeHorizon);
+        const float wLengthSquared = w.lengthSquared ();
+        const float dotProduct = w.dot (relativePosition);
+
+        if ((dotProduct < 0) &&
+            (square (dotProduct) > combinedRadiusSquared * wLengthSquared))
+        {
+            // project onto the cut-off circle
+            const float wLength = sqrtXXX (wLengthSquared);
+            const Vec3 unitW = w / wLength;
+            line.direction = perpendicular (unitW);
+            u = unitW * ((combinedRadius * invTimeHorizon) - wLength);
+        }
+        else
+        {
+            // project onto the left or right leg of the cone
+            const float leg = sqrtXXX (distSquared - combinedRadiusSquared);
+            const Vec3& p = relativePosition;
+            if (det (p, w) > 0)
+                line.direction = Vec3 ((p.x * leg) - (p.z * combinedRadius),
+                                       0,
+                                       (p.x * combinedRadius) + (p.z * leg));
+            else
+                line.direction = -Vec3 ((p.x * leg) + (p.z * combinedRadius),
+                                        0,
+                                        (p.z * leg) - (p.x * combinedRadius));
+            line.direction = line.direction / distSquared;
+            u = (line.direction * relativeVelocity.dot (line.direction)) -
+                relativeVelocity;
+        }
+    }
+    else
+    {
+        // already overlapping: separate within one time step
+        const float invTimeStep = 1 / timeStep;
+        const Vec3 w = relativeVelocity - (relativePosition * invTimeStep);
+        const float wLength = w.length ();
+        const Vec3 unitW = (wLength > epsilon) ? w / wLength : Vec3 (1, 0, 0);
+        line.direction = perpendicular (unitW);
+        u = unitW * ((combinedRadius * invTimeStep) - wLength);
+    }
+
+    // each agent takes half of the responsibility for avoiding the other
+    line.point = velocity + (u * 0.5f);
+    line.point.y = 0;
+}
+
+
+// ----------------------------------------------------------------------------
+
+
+OpenSteer::Vec3
+OpenSteer::solveOrcaLines (const OrcaLine lines[],
+                           const int lineCount,
+                           const float maxSpeed,
+                           const Vec3& preferredVelocity)
+{
+    const int count = ((lineCount < orcaMaxNeighbors) ?
+                       lineCount : (int) orcaMaxNeighbors);
+    const Vec3 preferred (preferredVelocity.x, 0, preferredVelocity.z);
+    Vec3 result;
+
+    const int satisfied = solveLines (lines, count, maxSpeed, preferred,
+                                      false, result);
+    if (satisfied < count)
+        solveLeastViolation (lines, count, satisfied, maxSpeed, result);
+    return result;
+}
+
+
+// ----------------------------------------------------------------------------
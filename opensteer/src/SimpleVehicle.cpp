@@ -84,6 +84,9 @@ OpenSteer::SimpleVehicle::SimpleVehicle (void)
 
     // maintain unique serial numbers
     serialNumber = serialNumberCounter++;
+
+    // random numbers of its own, the same each run
+    randomStream.setSeed (serialNumber);
 }
 
 
@@ -0,0 +1,517 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// TiledOccupancyMap: occupancy map paged in tile by tile from a tile file.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include "OpenSteer/TiledOccupancyMap.h"
+#include "OpenSteer/Utilities.h"
+
+// map the tile file into memory where mmap is available, else fall back
+// on reading and writing tiles through stdio
+#ifndef _WIN32
+#define OPENSTEER_TILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+    const char tileFileMagic[8] = {'O', 'S', 'T', 'I', 'L', 'E', 'S', 0};
+
+    // tiles start on a page boundary
+    const uint32_t tileDataOffset = 4096;
+
+    // bytes in a tile file, as 64 bits so large maps don't overflow
+    uint64_t tileFileSize (uint32_t dataOffset,
+                           int tileResolution,
+                           int tilesX,
+                           int tilesZ)
+    {
+        const uint64_t wordsPerRow = ((tileResolution +
+                                       OpenSteer::OccupancyGrid::bitsPerWord
+                                       - 1) /
+                                      OpenSteer::OccupancyGrid::bitsPerWord);
+        const uint64_t tileBytes = (wordsPerRow * tileResolution *
+                                    sizeof (OpenSteer::OccupancyGrid::Word));
+        return dataOffset + (tileBytes * tilesX * tilesZ);
+    }
+
+    // seek to a byte offset from the start of a file: fseek takes a long,
+    // which is 32 bits on Windows, so use the 64 bit variants
+    bool seekFile (FILE* f, uint64_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64 (f, (__int64) offset, SEEK_SET) == 0;
+#else
+        // (off_t may still be 32 bits without large file support)
+        const off_t o = (off_t) offset;
+        return ((uint64_t) o == offset) && (fseeko (f, o, SEEK_SET) == 0);
+#endif
+    }
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------------
+// constructor and destructor
+
+
+OpenSteer::TiledOccupancyMap::TiledOccupancyMap (int residentTileCapacity)
+    : outsideValue (false),
+      capacity (maxXXX (1, residentTileCapacity)),
+      workingSetStamp (1),
+      tileLoads (0),
+      tileEvictions (0),
+      writable (false),
+      data (NULL),
+      dataSize (0),
+      file (NULL),
+      wordsPerTile (0)
+{
+    memset (&header, 0, sizeof (header));
+}
+
+
+OpenSteer::TiledOccupancyMap::~TiledOccupancyMap ()
+{
+    close ();
+}
+
+
+// ----------------------------------------------------------------------------
+// tile file management
+
+
+bool
+OpenSteer::TiledOccupancyMap::create (const char* path,
+                                      const Vec3& origin,
+                                      int tilesX,
+                                      int tilesZ,
+                                      int tileResolution,
+                                      float cellSize)
+{
+    close ();
+
+    TileFileHeader h;
+    memset (&h, 0, sizeof (h));
+    memcpy (h.magic, tileFileMagic, sizeof (h.magic));
+    h.version = tileFileVersion;
+    h.dataOffset = tileDataOffset;
+    h.tileResolution = tileResolution;
+    h.tilesX = tilesX;
+    h.tilesZ = tilesZ;
+    h.cellSize = cellSize;
+    h.originX = origin.x;
+    h.originZ = origin.z;
+
+    // reject maps too large to address in this process
+    const uint64_t fileSize = tileFileSize (tileDataOffset, tileResolution,
+                                            tilesX, tilesZ);
+    if (fileSize != (size_t) fileSize) return false;
+
+    // write the header, then extend the file to its full size by writing
+    // its last byte (leaving a hole, on file systems which allow it)
+    FILE* f = fopen (path, "wb");
+    if (f == NULL) return false;
+    bool ok = fwrite (&h, sizeof (h), 1, f) == 1;
+    ok = ok && seekFile (f, fileSize - 1);
+    ok = ok && (fputc (0, f) != EOF);
+    ok = (fclose (f) == 0) && ok;
+
+    return ok && open (path, true);
+}
+
+
+bool
+OpenSteer::TiledOccupancyMap::open (const char* path, bool _writable)
+{
+    close ();
+
+    // read and check the header
+    FILE* f = fopen (path, _writable ? "r+b" : "rb");
+    if (f == NULL) return false;
+    if ((fread (&header, sizeof (header), 1, f) != 1) ||
+        (memcmp (header.magic, tileFileMagic, sizeof (header.magic)) != 0) ||
+        (header.version != tileFileVersion) ||
+        (header.tileResolution <= 0) ||
+        (header.tilesX <= 0) ||
+        (header.tilesZ <= 0))
+    {
+        fclose (f);
+        return false;
+    }
+
+    // reject maps too large to address in this process
+    const uint64_t fileSize = tileFileSize (header.dataOffset,
+                                            header.tileResolution,
+                                            header.tilesX,
+                                            header.tilesZ);
+    if (fileSize != (size_t) fileSize)
+    {
+        fclose (f);
+        return false;
+    }
+
+    writable = _writable;
+    const int wordsPerRow = ((header.tileResolution +
+                              OccupancyGrid::bitsPerWord - 1) /
+                             OccupancyGrid::bitsPerWord);
+    wordsPerTile = wordsPerRow * header.tileResolution;
+    dataSize = tileOffset (header.tilesX * header.tilesZ);
+
+#ifdef OPENSTEER_TILE_MMAP
+    // map the whole file, the mapping outlives the descriptor
+    fclose (f);
+    const int fd = ::open (path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) return false;
+    struct stat s;
+    void* m = MAP_FAILED;
+    if ((fstat (fd, &s) == 0) && ((size_t) s.st_size >= dataSize))
+    {
+        const int protection = PROT_READ | (writable ? PROT_WRITE : 0);
+        m = mmap (NULL, dataSize, protection, MAP_SHARED, fd, 0);
+    }
+    ::close (fd);
+    if (m == MAP_FAILED) return false;
+    data = (unsigned char*) m;
+#else
+    file = f;
+#endif
+    return true;
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::close (void)
+{
+    flush ();
+    for (TileList::iterator t = tiles.begin(); t != tiles.end(); t++)
+        delete t->grid;
+    tiles.clear ();
+    index.clear ();
+
+#ifdef OPENSTEER_TILE_MMAP
+    if (data != NULL) munmap (data, dataSize);
+#endif
+    if (file != NULL) fclose (file);
+    data = NULL;
+    file = NULL;
+    dataSize = 0;
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::flush (void)
+{
+    for (TileList::iterator t = tiles.begin(); t != tiles.end(); t++)
+    {
+        if (t->dirty)
+        {
+            saveTile (*t);
+            t->dirty = false;
+        }
+    }
+    if (file != NULL) fflush (file);
+}
+
+
+size_t
+OpenSteer::TiledOccupancyMap::tileOffset (int key) const
+{
+    return (header.dataOffset +
+            ((size_t) key * wordsPerTile * sizeof (OccupancyGrid::Word)));
+}
+
+
+// ----------------------------------------------------------------------------
+// moving tiles between the file and resident OccupancyGrids
+
+
+void
+OpenSteer::TiledOccupancyMap::loadTile (Tile& tile)
+{
+    const int tx = tile.key % header.tilesX;
+    const int tz = tile.key / header.tilesX;
+    const float tileSize = getTileSize ();
+    const Vec3 center (header.originX + ((tx + 0.5f) * tileSize),
+                       0,
+                       header.originZ + ((tz + 0.5f) * tileSize));
+    tile.grid = new OccupancyGrid (center, tileSize, tileSize,
+                                   header.tileResolution);
+
+    const size_t offset = tileOffset (tile.key);
+    if (data != NULL)
+    {
+        tile.grid->readRows ((const OccupancyGrid::Word*) (data + offset));
+    }
+    else if (file != NULL)
+    {
+        std::vector<OccupancyGrid::Word> buffer (wordsPerTile, 0);
+        if (seekFile (file, offset) &&
+            (fread (&buffer[0], sizeof (OccupancyGrid::Word),
+                    wordsPerTile, file) == (size_t) wordsPerTile))
+            tile.grid->readRows (&buffer[0]);
+    }
+    tileLoads++;
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::saveTile (const Tile& tile)
+{
+    if (! writable) return;
+    const size_t offset = tileOffset (tile.key);
+    const OccupancyGrid::Word* source = tile.grid->rowWords (0);
+    const size_t bytes = wordsPerTile * sizeof (OccupancyGrid::Word);
+    if (data != NULL)
+    {
+        memcpy (data + offset, source, bytes);
+    }
+    else if ((file != NULL) && seekFile (file, offset))
+    {
+        fwrite (source, bytes, 1, file);
+    }
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::readAhead (int key)
+{
+#ifdef OPENSTEER_TILE_MMAP
+    if (data == NULL) return;
+    const size_t page = (size_t) sysconf (_SC_PAGESIZE);
+    const size_t start = tileOffset (key);
+    const size_t end = tileOffset (key + 1);
+    const size_t alignedStart = start - (start % page);
+    posix_madvise (data + alignedStart, end - alignedStart,
+                   POSIX_MADV_WILLNEED);
+#else
+    (void) key;
+#endif
+}
+
+
+// ----------------------------------------------------------------------------
+// resident tile cache
+
+
+OpenSteer::TiledOccupancyMap::Tile&
+OpenSteer::TiledOccupancyMap::fetchTile (int key)
+{
+    std::map<int, TileList::iterator>::iterator i = index.find (key);
+    if (i != index.end ())
+    {
+        // move to the front of the list (most recently used)
+        tiles.splice (tiles.begin(), tiles, i->second);
+        return tiles.front ();
+    }
+
+    Tile tile;
+    tile.key = key;
+    tile.grid = NULL;
+    tile.dirty = false;
+    tile.useStamp = 0;
+    tiles.push_front (tile);
+    index[key] = tiles.begin();
+    loadTile (tiles.front ());
+    evictTiles ();
+    return tiles.front ();
+}
+
+
+// drop least recently used tiles beyond the capacity, skipping those in
+// the current working set and the most recently used one (the tile just
+// fetched)
+
+
+void
+OpenSteer::TiledOccupancyMap::evictTiles (void)
+{
+    int pinned = 0;
+    TileList::iterator t = tiles.end ();
+    while (((int) tiles.size () > capacity) && (--t != tiles.begin ()))
+    {
+        if (t->useStamp == workingSetStamp)
+        {
+            pinned++;
+        }
+        else
+        {
+            if (t->dirty) saveTile (*t);
+            delete t->grid;
+            index.erase (t->key);
+            t = tiles.erase (t);
+            tileEvictions++;
+        }
+    }
+    assert (getResidentTileCount () <= capacity + pinned);
+}
+
+
+const OpenSteer::OccupancyGrid*
+OpenSteer::TiledOccupancyMap::residentTile (int tx, int tz) const
+{
+    std::map<int, TileList::iterator>::const_iterator i =
+        index.find ((tz * header.tilesX) + tx);
+    return (i == index.end ()) ? NULL : i->second->grid;
+}
+
+
+// ----------------------------------------------------------------------------
+// cell access
+
+
+bool
+OpenSteer::TiledOccupancyMap::tileAt (const Vec3& point, int& tx, int& tz) const
+{
+    if (! isOpen ()) return false;
+    const float tileSize = getTileSize ();
+    const float u = (point.x - header.originX) / tileSize;
+    const float v = (point.z - header.originZ) / tileSize;
+    if ((u < 0) || (v < 0) || (u >= header.tilesX) || (v >= header.tilesZ))
+        return false;
+    tx = (int) u;
+    tz = (int) v;
+    return true;
+}
+
+
+bool
+OpenSteer::TiledOccupancyMap::getValue (const Vec3& point)
+{
+    int tx, tz;
+    if (! tileAt (point, tx, tz)) return outsideValue;
+    return fetchTile ((tz * header.tilesX) + tx).grid->getValue (point);
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::setValue (const Vec3& point, bool value)
+{
+    int tx, tz, i, j;
+    if (! writable || ! tileAt (point, tx, tz)) return;
+    Tile& tile = fetchTile ((tz * header.tilesX) + tx);
+    if (tile.grid->cellIndexAt (point, i, j) &&
+        (tile.grid->getBit (i, j) != value))
+    {
+        tile.grid->setBit (i, j, value);
+        tile.dirty = true;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// working set around active vehicles
+
+
+void
+OpenSteer::TiledOccupancyMap::updateWorkingSet (const std::vector<Vec3>& positions,
+                                                float radius,
+                                                float readAheadDistance)
+{
+    if (! isOpen ()) return;
+    workingSetStamp++;
+
+    const float tileSize = getTileSize ();
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // first pass: page in the working set, second: read ahead
+        const float r = radius + ((pass == 0) ? 0 : readAheadDistance);
+        for (size_t p = 0; p < positions.size (); p++)
+        {
+            const float u = (positions[p].x - header.originX) / tileSize;
+            const float v = (positions[p].z - header.originZ) / tileSize;
+            const int tx0 = std::max (0, (int) floorXXX (u - (r / tileSize)));
+            const int tz0 = std::max (0, (int) floorXXX (v - (r / tileSize)));
+            const int tx1 = std::min (header.tilesX - 1,
+                                      (int) floorXXX (u + (r / tileSize)));
+            const int tz1 = std::min (header.tilesZ - 1,
+                                      (int) floorXXX (v + (r / tileSize)));
+            for (int tz = tz0; tz <= tz1; tz++)
+            {
+                for (int tx = tx0; tx <= tx1; tx++)
+                {
+                    const int key = (tz * header.tilesX) + tx;
+                    if (pass == 0)
+                        fetchTile (key).useStamp = workingSetStamp;
+                    else if (index.find (key) == index.end ())
+                        readAhead (key);
+                }
+            }
+        }
+    }
+    evictTiles ();
+}
+
+
+void
+OpenSteer::TiledOccupancyMap::fillGrid (OccupancyGrid& grid)
+{
+    const Vec3 corner (grid.center.x - (grid.xSize / 2),
+                       0,
+                       grid.center.z - (grid.zSize / 2));
+    const float cx = grid.cellXSize ();
+    const float cz = grid.cellZSize ();
+
+    // remember the last tile used, neighboring cells mostly share one
+    int lastKey = -1;
+    OccupancyGrid* tile = NULL;
+    for (int j = 0; j < grid.resolution; j++)
+    {
+        for (int i = 0; i < grid.resolution; i++)
+        {
+            const Vec3 p (corner.x + ((i + 0.5f) * cx),
+                          0,
+                          corner.z + ((j + 0.5f) * cz));
+            int tx, tz;
+            bool value = outsideValue;
+            if (tileAt (p, tx, tz))
+            {
+                const int key = (tz * header.tilesX) + tx;
+                if (key != lastKey)
+                {
+                    tile = fetchTile (key).grid;
+                    lastKey = key;
+                }
+                value = tile->getValue (p);
+            }
+            grid.setBit (i, j, value);
+        }
+    }
+}
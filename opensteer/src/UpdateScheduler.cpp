@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// UpdateScheduler: level of detail for simulation updates.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <cfloat>
+#include "OpenSteer/UpdateScheduler.h"
+
+
+// ----------------------------------------------------------------------------
+
+
+OpenSteer::UpdateScheduler::UpdateScheduler (void)
+    : frame (0),
+      nextSlot (0)
+{
+    addTier (FLT_MAX, 1);
+}
+
+
+void
+OpenSteer::UpdateScheduler::clearTiers (void)
+{
+    tiers.clear ();
+}
+
+
+void
+OpenSteer::UpdateScheduler::addTier (const float maxDistance,
+                                     const int interval)
+{
+    // (FLT_MAX squared is infinity, beyond every distance)
+    const Tier t = {maxDistance * maxDistance,
+                    (interval > 1) ? interval : 1,
+                    0,
+                    0};
+    tiers.push_back (t);
+}
+
+
+void
+OpenSteer::UpdateScheduler::beginFrame (void)
+{
+    frame++;
+    for (size_t t = 0; t < tiers.size (); t++)
+    {
+        tiers[t].scheduled = 0;
+        tiers[t].updated = 0;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+
+
+int
+OpenSteer::UpdateScheduler::tierForPosition (const Vec3& position) const
+{
+    if (viewpoints.empty ()) return 0;
+
+    float nearest = FLT_MAX;
+    for (size_t i = 0; i < viewpoints.size (); i++)
+    {
+        const float d2 = (position - viewpoints[i]).lengthSquared ();
+        if (d2 < nearest) nearest = d2;
+    }
+
+    const int last = getLowestTier ();
+    for (int t = 0; t < last; t++)
+        if (nearest <= tiers[t].maxDistanceSquared) return t;
+    return last;
+}
+
+
+bool
+OpenSteer::UpdateScheduler::isDue (Agent& agent,
+                                   const Vec3& position,
+                                   const float elapsedTime,
+                                   float& stepTime)
+{
+    // a tier of the caller's choosing, or by distance
+    const int last = getLowestTier ();
+    agent.tier = ((agent.forcedTier >= 0) ?
+                  ((agent.forcedTier < last) ? agent.forcedTier : last) :
+                  tierForPosition (position));
+    Tier& tier = tiers[agent.tier];
+    tier.scheduled++;
+
+    // agents take consecutive slots as they are first seen, so the agents
+    // of a tier fall evenly over the frames of its interval
+    if (agent.slot < 0) agent.slot = nextSlot++;
+
+    agent.pendingTime += elapsedTime;
+    if (((frame + agent.slot) % tier.interval) != 0) return false;
+
+    tier.updated++;
+    stepTime = agent.pendingTime;
+    agent.pendingTime = 0;
+    return true;
+}
+
+
+// ----------------------------------------------------------------------------
@@ -74,15 +74,15 @@ const OpenSteer::Vec3 OpenSteer::Vec3::side    (-1, 0, 0);
 
 
 OpenSteer::Vec3 
-OpenSteer::RandomVectorInUnitRadiusSphere (void)
+OpenSteer::RandomVectorInUnitRadiusSphere (RandomStream& random)
 {
     Vec3 v;
 
     do
     {
-        v.set ((frandom01()*2) - 1,
-               (frandom01()*2) - 1,
-               (frandom01()*2) - 1);
+        v.set ((random.frandom01()*2) - 1,
+               (random.frandom01()*2) - 1,
+               (random.frandom01()*2) - 1);
     }
     while (v.length() >= 1);
 
@@ -90,6 +90,13 @@ OpenSteer::RandomVectorInUnitRadiusSphere (void)
 }
 
 
+OpenSteer::Vec3 
+OpenSteer::RandomVectorInUnitRadiusSphere (void)
+{
+    return RandomVectorInUnitRadiusSphere (threadRandomStream ());
+}
+
+
 // ----------------------------------------------------------------------------
 // Returns a position randomly distributed on a disk of unit radius
 // on the XZ (Y=0) plane, centered at the origin.  Orientation will be
@@ -97,15 +104,15 @@ OpenSteer::RandomVectorInUnitRadiusSphere (void)
 
 
 OpenSteer::Vec3 
-OpenSteer::randomVectorOnUnitRadiusXZDisk (void)
+OpenSteer::randomVectorOnUnitRadiusXZDisk (RandomStream& random)
 {
     Vec3 v;
 
     do
     {
-        v.set ((frandom01()*2) - 1,
+        v.set ((random.frandom01()*2) - 1,
                0,
-               (frandom01()*2) - 1);
+               (random.frandom01()*2) - 1);
     }
     while (v.length() >= 1);
 
@@ -113,6 +120,13 @@ OpenSteer::randomVectorOnUnitRadiusXZDisk (void)
 }
 
 
+OpenSteer::Vec3 
+OpenSteer::randomVectorOnUnitRadiusXZDisk (void)
+{
+    return randomVectorOnUnitRadiusXZDisk (threadRandomStream ());
+}
+
+
 // ----------------------------------------------------------------------------
 // Does a "ceiling" or "floor" operation on the angle by which a given vector
 // deviates from a given reference basis vector.  Consider a cone with "basis"
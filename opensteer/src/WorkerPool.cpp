@@ -0,0 +1,164 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// WorkerPool: a few threads which run the items of a job in parallel.
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <chrono>
+#include "OpenSteer/WorkerPool.h"
+
+
+// ----------------------------------------------------------------------------
+// constructor and destructor
+
+
+OpenSteer::WorkerPool::WorkerPool (int workerThreadCount)
+    : job (NULL),
+      itemCount (0),
+      chunk (1),
+      nextItem (0),
+      busyWorkers (0),
+      generation (0),
+      quit (false),
+      busyNanoseconds (0)
+{
+    if (workerThreadCount < 0)
+        workerThreadCount = (int) std::thread::hardware_concurrency () - 1;
+    for (int t = 0; t < workerThreadCount; t++)
+        threads.push_back (std::thread (&WorkerPool::workerLoop, this));
+}
+
+
+OpenSteer::WorkerPool::~WorkerPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        quit = true;
+    }
+    wake.notify_all ();
+    for (size_t t = 0; t < threads.size (); t++) threads[t].join ();
+}
+
+
+std::atomic<OpenSteer::WorkerPool*> OpenSteer::WorkerPool::sharedPool (NULL);
+
+
+OpenSteer::WorkerPool&
+OpenSteer::WorkerPool::shared (void)
+{
+    static WorkerPool pool;
+    sharedPool.store (&pool, std::memory_order_release);
+    return pool;
+}
+
+
+OpenSteer::WorkerPool*
+OpenSteer::WorkerPool::sharedIfStarted (void)
+{
+    return sharedPool.load (std::memory_order_acquire);
+}
+
+
+// ----------------------------------------------------------------------------
+// running a job: post it, work on it, wait for the workers to finish
+
+
+void
+OpenSteer::WorkerPool::parallelFor (int count, int chunkSize, Job& j)
+{
+    if (count <= 0) return;
+    chunkSize = std::max (1, chunkSize);
+
+    // not worth waking anyone for a single chunk
+    if (threads.empty () || (count <= chunkSize))
+    {
+        j.run (0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock (jobMutex);
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        job = &j;
+        itemCount = count;
+        chunk = chunkSize;
+        nextItem = 0;
+        busyWorkers = (int) threads.size ();
+        generation++;
+    }
+    wake.notify_all ();
+
+    runChunks ();
+
+    std::unique_lock<std::mutex> lock (mutex);
+    while (busyWorkers > 0) done.wait (lock);
+    job = NULL;
+}
+
+
+void
+OpenSteer::WorkerPool::runChunks (void)
+{
+    for (;;)
+    {
+        const int begin = nextItem.fetch_add (chunk);
+        if (begin >= itemCount) return;
+        job->run (begin, std::min (begin + chunk, itemCount));
+    }
+}
+
+
+void
+OpenSteer::WorkerPool::workerLoop (void)
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            while (! quit && (generation == seen)) wake.wait (lock);
+            if (quit) return;
+            seen = generation;
+        }
+
+        using namespace std::chrono;
+        const steady_clock::time_point start = steady_clock::now ();
+        runChunks ();
+        busyNanoseconds.fetch_add
+            (duration_cast<nanoseconds> (steady_clock::now () - start).count (),
+             std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock (mutex);
+        if (--busyWorkers == 0) done.notify_one ();
+    }
+}
@@ -0,0 +1,189 @@
+// ----------------------------------------------------------------------------
+//
+//
+// OpenSteer -- Steering Behaviors for Autonomous Characters
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+//
+// ----------------------------------------------------------------------------
+//
+//
+// pgm2occmap: offline converter from a grayscale image to an occupancy map
+// file (see OccupancyMapFile.h), one cell per pixel.  Reads binary (P5)
+// or ASCII (P2) PGM images with 8 bit samples.
+//
+//     pgm2occmap [options] image.pgm map.occ
+//
+//     -cell size      cell size in world units (default 1)
+//     -threshold n    gray level dividing clear from blocked (default 128)
+//     -light          light pixels are blocked (default: dark pixels)
+//     -distance       include the distance field in the map file
+//
+// Not part of the module build, compile it on its own along with
+// OccupancyMapFile.cpp, OccupancyGrid.cpp and Vec3.cpp from opensteer/src,
+// with the profiler zones compiled out (OPENSTEER_NO_PROFILER), for
+// example (from the module directory):
+//
+//     g++ -O2 -DOPENSTEER_NO_PROFILER -Iopensteer/include -o pgm2occmap
+//         opensteer/tools/pgm2occmap.cpp
+//         opensteer/src/OccupancyMapFile.cpp opensteer/src/OccupancyGrid.cpp
+//         opensteer/src/Vec3.cpp
+//
+// 10-18-26: created
+//
+//
+// ----------------------------------------------------------------------------
+
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "OpenSteer/OccupancyMapFile.h"
+
+
+namespace {
+
+    // next integer in a PGM header, skipping white space and comments
+    bool readHeaderInt (FILE* f, int& value)
+    {
+        int c = fgetc (f);
+        while ((c != EOF) && (isspace (c) || (c == '#')))
+        {
+            if (c == '#') while ((c != EOF) && (c != '\n')) c = fgetc (f);
+            c = fgetc (f);
+        }
+        if ((c == EOF) || ! isdigit (c)) return false;
+        value = 0;
+        while ((c != EOF) && isdigit (c))
+        {
+            value = (value * 10) + (c - '0');
+            c = fgetc (f);
+        }
+        return true; // consumes the single white space after the number
+    }
+
+    // read an 8 bit PGM image, samples scaled to 0..255
+    bool readPGM (const char* path,
+                  std::vector<unsigned char>& pixels,
+                  int& width,
+                  int& height)
+    {
+        FILE* f = fopen (path, "rb");
+        if (f == NULL) return false;
+
+        char magic[2] = {0, 0};
+        int maxValue = 0;
+        bool ok = ((fread (magic, 2, 1, f) == 1) &&
+                   (magic[0] == 'P') &&
+                   ((magic[1] == '5') || (magic[1] == '2')) &&
+                   readHeaderInt (f, width) &&
+                   readHeaderInt (f, height) &&
+                   readHeaderInt (f, maxValue) &&
+                   (width > 0) && (height > 0) &&
+                   (maxValue > 0) && (maxValue < 256));
+
+        if (ok)
+        {
+            pixels.resize ((size_t) width * height);
+            if (magic[1] == '5')
+            {
+                ok = fread (&pixels[0], pixels.size (), 1, f) == 1;
+            }
+            else
+            {
+                for (size_t p = 0; ok && (p < pixels.size ()); p++)
+                {
+                    int value;
+                    ok = readHeaderInt (f, value) && (value <= maxValue);
+                    pixels[p] = (unsigned char) value;
+                }
+            }
+            if (maxValue != 255)
+                for (size_t p = 0; p < pixels.size (); p++)
+                    pixels[p] = (unsigned char) ((pixels[p] * 255) / maxValue);
+        }
+        fclose (f);
+        return ok;
+    }
+
+    void usage (void)
+    {
+        fprintf (stderr,
+                 "usage: pgm2occmap [-cell size] [-threshold n] [-light] "
+                 "[-distance] image.pgm map.occ\n");
+        exit (1);
+    }
+
+} // anonymous namespace
+
+
+int
+main (int argc, char** argv)
+{
+    float cellSize = 1;
+    int threshold = 128;
+    bool darkIsBlocked = true;
+    bool distance = false;
+
+    int a = 1;
+    for (; (a < argc) && (argv[a][0] == '-'); a++)
+    {
+        if ((strcmp (argv[a], "-cell") == 0) && (a + 1 < argc))
+            cellSize = (float) atof (argv[++a]);
+        else if ((strcmp (argv[a], "-threshold") == 0) && (a + 1 < argc))
+            threshold = atoi (argv[++a]);
+        else if (strcmp (argv[a], "-light") == 0)
+            darkIsBlocked = false;
+        else if (strcmp (argv[a], "-distance") == 0)
+            distance = true;
+        else
+            usage ();
+    }
+    if ((argc - a != 2) || (cellSize <= 0)) usage ();
+
+    std::vector<unsigned char> pixels;
+    int width, height;
+    if (! readPGM (argv[a], pixels, width, height))
+    {
+        fprintf (stderr, "pgm2occmap: can't read 8 bit PGM image %s\n", argv[a]);
+        return 1;
+    }
+
+    OpenSteer::OccupancyGrid* grid =
+        OpenSteer::OccupancyMapFile::makeGridFromImage (&pixels[0],
+                                                        width,
+                                                        height,
+                                                        OpenSteer::Vec3::zero,
+                                                        cellSize,
+                                                        threshold,
+                                                        darkIsBlocked);
+    if (distance)
+    {
+        grid->setDistanceFieldEnabled (true);
+        grid->updateDistanceField ();
+    }
+
+    const bool ok = OpenSteer::OccupancyMapFile::write (argv[a + 1], *grid);
+    if (! ok) fprintf (stderr, "pgm2occmap: can't write %s\n", argv[a + 1]);
+    delete grid;
+    return ok ? 0 : 1;
+}
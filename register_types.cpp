@@ -1,11 +1,26 @@
 #include "register_types.h"
 
 #include "core/class_db.h"
+#include "core/engine.h"
+
+#include "gd_opensteer_monitors.h"
+
+static OpenSteerMonitors *opensteer_monitors = nullptr;
 
 void register_gd_opensteer_types()
 {
+	ClassDB::register_class<OpenSteerMonitors>();
+
+	// steering statistics for scripts and the debugger
+	opensteer_monitors = memnew(OpenSteerMonitors);
+	Engine::get_singleton()->add_singleton(Engine::Singleton("OpenSteerMonitors", opensteer_monitors));
 }
 
 void unregister_gd_opensteer_types()
 {
+	if (opensteer_monitors) {
+		opensteer_monitors->set_profiling(false);
+		memdelete(opensteer_monitors);
+		opensteer_monitors = nullptr;
+	}
 }